@@ -11,24 +11,40 @@ using namespace ReadyTraderGo;
 
 RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_AT, "AUTO")
 
-constexpr int LOT_SIZE = 40;
 constexpr int POSITION_LIMIT = 100;
 constexpr int TICK_SIZE_IN_CENTS = 100;
 constexpr int MIN_BID_NEARST_TICK = (MINIMUM_BID + TICK_SIZE_IN_CENTS) / TICK_SIZE_IN_CENTS * TICK_SIZE_IN_CENTS;
 constexpr int MAX_ASK_NEAREST_TICK = MAXIMUM_ASK / TICK_SIZE_IN_CENTS * TICK_SIZE_IN_CENTS;
+
+// DEFAULT STRATEGY PARAMETERS, WHICH CAN BE CHANGED WITH "LotSize", "Window",
+// "HedgeThreshold" AND "PositionBand" IN THE "Parameters" OF THE CONFIGURATION
+// OR BY A PARAMETER SWEEP
+constexpr int LOT_SIZE = 40;
 constexpr int WINDOW = 5;
 constexpr int HEDGE_THRESHOLD  = 200;
-
-boost::circular_buffer<unsigned long> mETFSpreads(WINDOW);
-double sum {0};
-unsigned long newBidPrice {0};
-unsigned long newAskPrice {0};
-unsigned int askVolume {0};
-unsigned int bidVolume {0};
+constexpr int POSITION_BAND = 80;
+
+// THREAD LOCAL SO THAT A SWEEP CAN RUN AN AUTOTRADER ON EACH THREAD, AND
+// RESET BY THE CONSTRUCTOR FOR EACH NEW AUTOTRADER
+thread_local boost::circular_buffer<unsigned long> mETFSpreads(WINDOW);
+thread_local double sum {0};
+thread_local unsigned long newBidPrice {0};
+thread_local unsigned long newAskPrice {0};
+thread_local unsigned int askVolume {0};
+thread_local unsigned int bidVolume {0};
+
+thread_local bool parametersRead {false};
+thread_local int lotSize {LOT_SIZE};
+thread_local std::size_t window {WINDOW};
+thread_local int hedgeThreshold {HEDGE_THRESHOLD};
+thread_local long positionBand {POSITION_BAND};
 
 AutoTrader::AutoTrader(boost::asio::io_context& context) : BaseAutoTrader(context)
 {
-
+    mETFSpreads.set_capacity(WINDOW);
+    mETFSpreads.clear();
+    sum = 0;
+    parametersRead = false;
 }
 
 void AutoTrader::DisconnectHandler()
@@ -39,7 +55,8 @@ void AutoTrader::DisconnectHandler()
 void AutoTrader::ErrorMessageHandler(unsigned long clientOrderId,
                                      const std::string& errorMessage)
 {
-    if (clientOrderId != 0 && ((mAsks.count(clientOrderId) == 1) || (mBids.count(clientOrderId) == 1)))
+    const ManagedOrder* order = GetOrderManager().Find(clientOrderId);
+    if (order && order->mInstrument == Instrument::ETF)
     {
         OrderStatusMessageHandler(clientOrderId, 0, 0, 0);
     }
@@ -49,15 +66,8 @@ void AutoTrader::HedgeFilledMessageHandler(unsigned long clientOrderId,
                                            unsigned long price,
                                            unsigned long volume)
 {
-    if (mFutureAsks.count(clientOrderId) == 1)
-    {
-        mFuturePosition -= (long)volume;
-    }
-        else if (mFutureBids.count(clientOrderId) == 1)
-    {
-        mFuturePosition += (long)volume;
-    }
-
+    // THE ORDER MANAGER HAS ALREADY UPDATED THE POSITION
+    mFuturePosition = GetOrderManager().GetFuturePosition();
 }
 
 void AutoTrader::OrderBookMessageHandler(Instrument instrument,
@@ -67,6 +77,17 @@ void AutoTrader::OrderBookMessageHandler(Instrument instrument,
                                          const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
                                          const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes)
 {
+    // THE PARAMETERS ARE SET AFTER THE CONSTRUCTOR HAS RUN
+    if (!parametersRead){
+        const StrategyParameters& parameters = GetParameters();
+        lotSize = parameters.Get("LotSize", LOT_SIZE);
+        window = parameters.Get("Window", static_cast<std::size_t>(WINDOW));
+        hedgeThreshold = parameters.Get("HedgeThreshold", HEDGE_THRESHOLD);
+        positionBand = parameters.Get("PositionBand", static_cast<long>(POSITION_BAND));
+        mETFSpreads.set_capacity(window);
+        parametersRead = true;
+    }
+
     if (instrument == Instrument::ETF){
 
         // KEEP BEST BID AND BEST ASK
@@ -76,7 +97,7 @@ void AutoTrader::OrderBookMessageHandler(Instrument instrument,
         if (askPrices[0] != 0 and bidPrices[0] != 0){
             mETFSpreads.push_back(askPrices[0] - bidPrices[0]);
         }
-        if (mETFSpreads.size() > WINDOW){
+        if (mETFSpreads.size() > window){
             mETFSpreads.pop_front();
         }
 
@@ -84,12 +105,12 @@ void AutoTrader::OrderBookMessageHandler(Instrument instrument,
         for (const auto& value : mETFSpreads) {
                 sum += value;
             }
-        mETFSpreadmean = sum / WINDOW;
+        mETFSpreadmean = sum / window;
         sum = 0;
         for (const auto& value: mETFSpreads){
                 sum += (mETFSpreadmean - value) * (mETFSpreadmean - value);
         }
-        mETFSpreadstd = std::sqrt(sum / WINDOW);
+        mETFSpreadstd = std::sqrt(sum / window);
     }
     
     if (instrument == Instrument::FUTURE)
@@ -97,7 +118,7 @@ void AutoTrader::OrderBookMessageHandler(Instrument instrument,
         // HEDGE COUNTER
         mHedgeCounter += 1;
 
-        if (mHedgeCounter == HEDGE_THRESHOLD){
+        if (mHedgeCounter == hedgeThreshold){
             mHedge = true;
         }
 
@@ -106,12 +127,12 @@ void AutoTrader::OrderBookMessageHandler(Instrument instrument,
         newAskPrice = 0;
 
         //
-        askVolume = std::round(LOT_SIZE * (1 + (double)mPosition / POSITION_LIMIT));
-        bidVolume = std::round(LOT_SIZE * (1 - (double)mPosition / POSITION_LIMIT));
+        askVolume = std::round(lotSize * (1 + (double)mPosition / POSITION_LIMIT));
+        bidVolume = std::round(lotSize * (1 - (double)mPosition / POSITION_LIMIT));
 
-        if (mPosition < 80 && mPosition > -80){
+        if (mPosition < positionBand && mPosition > -positionBand){
             /////////////////////////////////
-            if (mETFSpreads.size() == WINDOW){
+            if (mETFSpreads.size() == window){
                 ////////////////////////
                 int tickSpread = std::round(mETFSpreadstd / TICK_SIZE_IN_CENTS);
                 if (tickSpread != 0){
@@ -132,16 +153,19 @@ void AutoTrader::OrderBookMessageHandler(Instrument instrument,
             }
         }
         //////////////////////////////////
-        else if (mPosition >= 80){
+        else if (mPosition >= positionBand){
             // UNDERCUT BEST ASK
             newAskPrice = (mETFBestAsk > askPrices[0] + TICK_SIZE_IN_CENTS) ? mETFBestAsk - TICK_SIZE_IN_CENTS : askPrices[0];
         }
         //////////////////////////////////
-        else if (mPosition <= -80){
+        else if (mPosition <= -positionBand){
             // UNDERCUT
             newBidPrice = (mETFBestBid < bidPrices[0] - TICK_SIZE_IN_CENTS) ? mETFBestBid + TICK_SIZE_IN_CENTS : bidPrices[0];
         }
 
+        // SEND THE CANCELS AND INSERTS TOGETHER
+        auto batch = MakeSendBatch();
+
         // CANCEL ORDERS IF THE PRICE BUDGES BY AT LEAST TWO PRICE TICKS
         if (mBidId != 0 && newBidPrice != mBidPrice){
             SendCancelOrder(mBidId);
@@ -154,17 +178,13 @@ void AutoTrader::OrderBookMessageHandler(Instrument instrument,
 
         // SEND ASK LIMIT ORDER PRICE
         if (mAskId == 0 && newAskPrice != 0 && mPosition - askVolume > - POSITION_LIMIT){
-            mAskId = mNextMessageId++;
+            mAskId = InsertOrder(Side::SELL, newAskPrice, askVolume, Lifespan::GOOD_FOR_DAY);
             mAskPrice = newAskPrice;
-            SendInsertOrder(mAskId, Side::SELL, newAskPrice, askVolume, Lifespan::GOOD_FOR_DAY);
-            mAsks.emplace(mAskId);
         }   
         // SEND BID LIMIT ORDER PRICE
         if (mBidId == 0 && newBidPrice != 0 && mPosition + bidVolume < POSITION_LIMIT){
-            mBidId = mNextMessageId++;
+            mBidId = InsertOrder(Side::BUY, newBidPrice, bidVolume, Lifespan::GOOD_FOR_DAY);
             mBidPrice = newBidPrice;
-            SendInsertOrder(mBidId, Side::BUY, newBidPrice, bidVolume, Lifespan::GOOD_FOR_DAY);
-            mBids.emplace(mBidId);
         }
     }
 }
@@ -173,14 +193,8 @@ void AutoTrader::OrderFilledMessageHandler(unsigned long clientOrderId,
                                            unsigned long price,
                                            unsigned long volume)
 {
-    if (mAsks.count(clientOrderId) == 1)
-    {
-        mPosition -= (long)volume;
-    }
-        else if (mBids.count(clientOrderId) == 1)
-    {
-        mPosition += (long)volume;
-    }
+    // THE ORDER MANAGER HAS ALREADY UPDATED THE POSITION
+    mPosition = GetOrderManager().GetEtfPosition();
 
     // RESET THE HEDGE COUNTER IF WE ARE WITHIN HEDGE LIMIT
     if (mPosition + mFuturePosition > -10 and mPosition + mFuturePosition < 10 ){
@@ -189,16 +203,12 @@ void AutoTrader::OrderFilledMessageHandler(unsigned long clientOrderId,
 
     // HEDGE IF WE GET THE HEDGE SIGNAL
     if (mHedge && mPosition + mFuturePosition < 0){
-        mFutureBidId = mNextMessageId++;
-        SendHedgeOrder(mFutureBidId, Side::BUY, MAX_ASK_NEAREST_TICK, std::abs(mFuturePosition + mPosition));
-        mFutureBids.emplace(mFutureBidId);
+        mFutureBidId = HedgeOrder(Side::BUY, MAX_ASK_NEAREST_TICK, std::abs(mFuturePosition + mPosition));
         mHedgeCounter = 0;
         mHedge = false;
     }
     else if (mHedge && mPosition + mFuturePosition > 0){
-        mFutureAskId = mNextMessageId++;
-        SendHedgeOrder(mFutureAskId, Side::SELL, MIN_BID_NEARST_TICK, std::abs(mFuturePosition + mPosition));
-        mFutureAsks.emplace(mFutureAskId);
+        mFutureAskId = HedgeOrder(Side::SELL, MIN_BID_NEARST_TICK, std::abs(mFuturePosition + mPosition));
         mHedgeCounter = 0;
         mHedge = false;
     }
@@ -221,9 +231,6 @@ void AutoTrader::OrderStatusMessageHandler(unsigned long clientOrderId,
         {
             mBidId = 0;
         }
-
-        mAsks.erase(clientOrderId);
-        mBids.erase(clientOrderId);
     }
 }
 
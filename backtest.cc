@@ -0,0 +1,166 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <backtest/allocationaudit.h>
+#include <backtest/backtest.h>
+#include <backtest/parametergrid.h>
+#include <exchange/exchangeconfig.h>
+#include <market_data/marketevents.h>
+#include <ready_trader_go/logging.h>
+
+#include "autotrader.h"
+
+using namespace ReadyTraderGo;
+
+// Play a whole match between the auto-trader and a market data file in
+// memory, as fast as possible, and report how the auto-trader did.
+
+static int usage(const char* program)
+{
+    std::cerr << "usage: " << program << " [options] [MARKET_DATA_FILE]\n"
+                 "\n"
+                 "  --audit-allocations SECONDS\n"
+                 "                      count heap allocations made by the auto-trader while handling\n"
+                 "                      messages after SECONDS of market time, failing if there are any\n"
+                 "  --audit-trace       write a stack trace for each audited allocation to stderr\n"
+                 "  --config FILE       exchange configuration (default exchange.json)\n"
+                 "  --latency SECONDS   market time taken by each message (default 0.0001)\n"
+                 "  --log               log to the console (logging is off by default)\n"
+                 "  --param NAME=VALUE  set a strategy parameter (may be repeated)\n"
+                 "\n"
+                 "The market data file defaults to the one named in the exchange configuration.\n";
+    return 2;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* configFilename = "exchange.json";
+    const char* marketDataFilename = nullptr;
+    double latency = DEFAULT_BACKTEST_LATENCY;
+    bool log = false;
+    std::vector<std::string> specifications;
+    bool auditAllocations = false;
+    double auditWarmUpTime = 0.0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--audit-allocations") == 0 && i + 1 < argc)
+        {
+            auditAllocations = true;
+            auditWarmUpTime = std::strtod(argv[++i], nullptr);
+        }
+        else if (std::strcmp(argv[i], "--audit-trace") == 0)
+            setAllocationAuditTrace(true);
+        else if (std::strcmp(argv[i], "--config") == 0 && i + 1 < argc)
+            configFilename = argv[++i];
+        else if (std::strcmp(argv[i], "--latency") == 0 && i + 1 < argc)
+            latency = std::strtod(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "--log") == 0)
+            log = true;
+        else if (std::strcmp(argv[i], "--param") == 0 && i + 1 < argc)
+            specifications.emplace_back(argv[++i]);
+        else if (argv[i][0] != '-' && !marketDataFilename)
+            marketDataFilename = argv[i];
+        else
+            return usage(argv[0]);
+    }
+
+    setLoggingEnabled(log);
+
+    try
+    {
+        ParameterGrid grid;
+        for (const auto& specification : specifications)
+        {
+            grid.Add(specification);
+        }
+        if (grid.GetSize() != 1)
+        {
+            return usage(argv[0]);
+        }
+
+        boost::property_tree::ptree tree;
+        boost::property_tree::read_json(configFilename, tree);
+        ExchangeConfig config;
+        config.readFromPropertyTree(tree);
+
+        const auto events = readMarketEvents(marketDataFilename ? marketDataFilename : config.mMarketDataFile);
+        Backtest backtest{config, events, latency};
+        if (auditAllocations)
+        {
+            backtest.AuditAllocations(auditWarmUpTime);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        boost::asio::io_context context;
+        AutoTrader autoTrader{context};
+        autoTrader.SetParameters(grid.GetParameters(0));
+        const BacktestResult result = backtest.Run(autoTrader, context);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "match ended at " << result.mEndTime << " seconds: " << result.mShutdownReason << '\n';
+        if (!result.mBreachMessage.empty())
+        {
+            std::cout << "breach: " << result.mBreachMessage << '\n';
+        }
+        std::cout << "profit: " << result.mProfitOrLoss << " (max drawdown " << result.mMaxDrawdown
+                  << ", fees " << result.mTotalFees << ")\n"
+                  << "positions: etf=" << result.mEtfPosition << " future=" << result.mFuturePosition << '\n'
+                  << "etf volume: bought=" << result.mBuyVolume << " sold=" << result.mSellVolume
+                  << " (max position " << result.mMaxEtfPosition << ")\n"
+                  << "fills: orders=" << result.mOrderFillCount << " hedges=" << result.mHedgeFillCount << '\n'
+                  << "messages: sent=" << result.mMessagesSent << " received=" << result.mMessagesReceived << '\n';
+        const OrderManager& orders = autoTrader.GetOrderManager();
+        if (orders.GetEtfPosition() != result.mEtfPosition || orders.GetFuturePosition() != result.mFuturePosition)
+        {
+            std::cout << "order manager positions differ: etf=" << orders.GetEtfPosition() << " future="
+                      << orders.GetFuturePosition() << '\n';
+        }
+        autoTrader.WritePreTradeStatistics(std::cout);
+        std::cerr << "played " << result.mMarketEventCount << " market events in " << elapsed.count()
+                  << " seconds\n";
+
+        if (auditAllocations)
+        {
+            std::cout << "audited allocations: " << result.mAuditedAllocations << " (" << result.mAuditedBytes
+                      << " bytes)\n";
+            if (result.mAuditedAllocations != 0)
+            {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "backtest: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
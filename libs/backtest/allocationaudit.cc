@@ -0,0 +1,223 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cstdlib>
+#include <new>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+#if defined(__GLIBC__)
+#include <execinfo.h>
+#include <unistd.h>
+#define RTG_ALLOCATION_AUDIT_TRACE 1
+#endif
+
+#include "allocationaudit.h"
+
+namespace ReadyTraderGo {
+
+// Plain thread-local variables (constant initialised, so no allocation or
+// guard is needed to reach them from inside operator new).
+static thread_local bool isArmed = false;
+static thread_local bool isTracing = false;
+static thread_local bool isInTrace = false;
+static thread_local AllocationAuditCounts counts;
+
+static void traceAllocation()
+{
+#ifdef RTG_ALLOCATION_AUDIT_TRACE
+    // backtrace() may itself allocate the first time it is called.
+    isInTrace = true;
+    void* frames[32];
+    const int frameCount = backtrace(frames, 32);
+    static const char header[] = "audited allocation:\n";
+    [[maybe_unused]] auto written = write(STDERR_FILENO, header, sizeof(header) - 1);
+    backtrace_symbols_fd(frames, frameCount, STDERR_FILENO);
+    isInTrace = false;
+#endif
+}
+
+static void* allocate(std::size_t size, bool nothrow)
+{
+    if (isArmed && !isInTrace)
+    {
+        ++counts.mAllocations;
+        counts.mBytes += size;
+        if (isTracing)
+        {
+            traceAllocation();
+        }
+    }
+
+    void* pointer = std::malloc(size ? size : 1);
+    if (!pointer && !nothrow)
+    {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+static void* allocateAligned(std::size_t size, std::size_t alignment, bool nothrow)
+{
+    if (isArmed && !isInTrace)
+    {
+        ++counts.mAllocations;
+        counts.mBytes += size;
+        if (isTracing)
+        {
+            traceAllocation();
+        }
+    }
+
+#ifdef _MSC_VER
+    void* pointer = _aligned_malloc(size ? size : 1, alignment);
+#else
+    // aligned_alloc needs the size to be a multiple of the alignment.
+    const std::size_t rounded = ((size ? size : 1) + alignment - 1) / alignment * alignment;
+    void* pointer = std::aligned_alloc(alignment, rounded);
+#endif
+    if (!pointer && !nothrow)
+    {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+static void deallocate(void* pointer, bool aligned)
+{
+    if (pointer && isArmed && !isInTrace)
+    {
+        ++counts.mDeallocations;
+    }
+#ifdef _MSC_VER
+    if (aligned)
+    {
+        _aligned_free(pointer);
+        return;
+    }
+#endif
+    std::free(pointer);
+}
+
+void armAllocationAudit()
+{
+    isArmed = true;
+}
+
+void disarmAllocationAudit()
+{
+    isArmed = false;
+}
+
+bool isAllocationAuditArmed()
+{
+    return isArmed;
+}
+
+AllocationAuditCounts getAllocationAuditCounts()
+{
+    return counts;
+}
+
+void resetAllocationAudit()
+{
+    counts = AllocationAuditCounts();
+}
+
+void setAllocationAuditTrace(bool trace)
+{
+    isTracing = trace;
+}
+
+AllocationAuditScope::AllocationAuditScope(bool arm) : mWasArmed(isArmed)
+{
+    if (arm)
+    {
+        isArmed = true;
+    }
+}
+
+AllocationAuditScope::~AllocationAuditScope()
+{
+    isArmed = mWasArmed;
+}
+
+AllocationAuditPause::AllocationAuditPause() : mWasArmed(isArmed)
+{
+    isArmed = false;
+}
+
+AllocationAuditPause::~AllocationAuditPause()
+{
+    isArmed = mWasArmed;
+}
+
+}
+
+// The replaceable global allocation functions (the sized and array forms of
+// delete default to these).
+void* operator new(std::size_t size)
+{
+    return ReadyTraderGo::allocate(size, false);
+}
+
+void* operator new[](std::size_t size)
+{
+    return ReadyTraderGo::allocate(size, false);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return ReadyTraderGo::allocate(size, true);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return ReadyTraderGo::allocate(size, true);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return ReadyTraderGo::allocateAligned(size, static_cast<std::size_t>(alignment), false);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return ReadyTraderGo::allocateAligned(size, static_cast<std::size_t>(alignment), false);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    ReadyTraderGo::deallocate(pointer, false);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    ReadyTraderGo::deallocate(pointer, false);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    ReadyTraderGo::deallocate(pointer, true);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+    ReadyTraderGo::deallocate(pointer, true);
+}
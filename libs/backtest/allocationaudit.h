@@ -0,0 +1,80 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_BACKTEST_ALLOCATIONAUDIT_H
+#define CPPREADY_TRADER_GO_LIBS_BACKTEST_ALLOCATIONAUDIT_H
+
+#include <cstddef>
+
+namespace ReadyTraderGo {
+
+// Counts heap allocations made by the calling thread while the audit is
+// armed. Linking backtest_lib replaces the global operator new and delete
+// with versions that check a thread-local flag before calling malloc and
+// free, so programs that do not arm the audit pay only for the check.
+struct AllocationAuditCounts
+{
+    unsigned long mAllocations = 0;
+    unsigned long mDeallocations = 0;
+    std::size_t mBytes = 0;
+};
+
+// Arm or disarm the audit for the calling thread. Arming does not reset
+// the counts.
+void armAllocationAudit();
+void disarmAllocationAudit();
+bool isAllocationAuditArmed();
+
+AllocationAuditCounts getAllocationAuditCounts();
+void resetAllocationAudit();
+
+// Write a stack trace to stderr for each audited allocation (where the
+// platform supports it), to find out what allocated.
+void setAllocationAuditTrace(bool trace);
+
+// Arms the audit for the lifetime of a scope, if the condition holds.
+class AllocationAuditScope
+{
+public:
+    explicit AllocationAuditScope(bool arm = true);
+    ~AllocationAuditScope();
+
+    AllocationAuditScope(const AllocationAuditScope&) = delete;
+    AllocationAuditScope& operator=(const AllocationAuditScope&) = delete;
+
+private:
+    bool mWasArmed;
+};
+
+// Disarms the audit for the lifetime of a scope, for work that is not
+// being audited (such as the simulated exchange) done within audited code.
+class AllocationAuditPause
+{
+public:
+    AllocationAuditPause();
+    ~AllocationAuditPause();
+
+    AllocationAuditPause(const AllocationAuditPause&) = delete;
+    AllocationAuditPause& operator=(const AllocationAuditPause&) = delete;
+
+private:
+    bool mWasArmed;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_BACKTEST_ALLOCATIONAUDIT_H
@@ -0,0 +1,463 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <memory>
+#include <utility>
+
+#include <exchange/competitor.h>
+#include <exchange/frequencylimiter.h>
+#include <matching_engine/marketreplay.h>
+#include <matching_engine/orderbook.h>
+#include <ready_trader_go/logging.h>
+#include <ready_trader_go/protocol.h>
+
+#include "allocationaudit.h"
+#include "backtest.h"
+#include "eventqueue.h"
+#include "simulatedconnectivity.h"
+
+RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_BT, "BACKTEST")
+
+namespace ReadyTraderGo {
+
+namespace {
+
+// Everything belonging to one run of a backtest: the exchange, with its
+// order books, competitor and timers, and the in-memory connections to the
+// auto-trader. The exchange's end of the execution connection is modelled on
+// ExecutionConnection in the exchange stand-in.
+class Match : public ICompetitorConnection
+{
+public:
+    Match(const ExchangeConfig& config,
+          const std::vector<MarketEvent>& events,
+          double latency,
+          boost::asio::io_context& context);
+
+    // Audit the auto-trader's allocations from the given market time on.
+    void AuditAllocations(double warmUpTime);
+
+    BacktestResult Run(BaseAutoTrader& autoTrader);
+
+    // ICompetitorConnection
+    void Close() override;
+    void SendError(unsigned long clientOrderId, const std::string& message) override;
+    void SendHedgeFilled(unsigned long clientOrderId, unsigned long averagePrice, unsigned long volume) override;
+    void SendOrderFilled(unsigned long clientOrderId, unsigned long price, unsigned long volume) override;
+    void SendOrderStatus(unsigned long clientOrderId,
+                         unsigned long fillVolume,
+                         unsigned long remainingVolume,
+                         long fees) override;
+
+private:
+    double GetTime() const { return mQueue.GetTime(); }
+    bool IsAudited() const { return mIsAllocationAudited && GetTime() >= mAllocationAuditWarmUpTime; }
+
+    void AdvanceTime();
+    void ConnectionLost();
+    void ExecutionMessageHandler(unsigned char messageType, unsigned char const* data, std::size_t size);
+    void MarketTimerHandler();
+    void SendTradeTicks(OrderBook& book);
+    void Shutdown(const std::string& reason);
+    void TickTimerHandler();
+    void TradeOccurred(OrderBook& book);
+
+    // Serialise a message now and deliver it to the auto-trader once the
+    // latency has passed.
+    template<typename T>
+    void SendExecutionMessage(unsigned char messageType, const T& message);
+    template<typename T>
+    void SendInformationMessage(unsigned char messageType, const T& message);
+
+    const ExchangeConfig& mConfig;
+    const std::vector<MarketEvent>& mEvents;
+    double mLatency;
+    boost::asio::io_context& mContext;
+    bool mIsAllocationAudited = false;
+    double mAllocationAuditWarmUpTime = 0.0;
+
+    EventQueue mQueue;
+    OrderBook mFutureBook;
+    OrderBook mEtfBook;
+    MarketReplay mReplay;
+    CompetitorManager mCompetitorManager;
+    FrequencyLimiter mFrequencyLimiter;
+
+    SimulatedConnection* mConnection = nullptr;
+    std::shared_ptr<SimulatedSubscription> mSubscription;
+    Competitor* mCompetitor = nullptr;
+    bool mIsClosing = false;
+    bool mIsLost = false;
+
+    std::size_t mNextEvent = 0;
+    bool mIsDone = false;
+    bool mIsShutdown = false;
+    double mMarketEventTime = 0.0;
+    double mTickTime = 0.0;
+    unsigned long mTickNumber = 1;
+    std::array<bool, INSTRUMENT_COUNT> mIsTradeTicksPosted{};
+    std::array<unsigned long, INSTRUMENT_COUNT> mTradeTicksSequenceNumbers{};
+
+    BacktestResult mResult;
+};
+
+Match::Match(const ExchangeConfig& config,
+             const std::vector<MarketEvent>& events,
+             double latency,
+             boost::asio::io_context& context)
+    : mConfig(config),
+      mEvents(events),
+      mLatency(latency),
+      mContext(context),
+      mFutureBook(Instrument::FUTURE, config.mMakerFee, config.mTakerFee),
+      mEtfBook(Instrument::ETF, config.mMakerFee, config.mTakerFee),
+      mReplay(mFutureBook, mEtfBook),
+      mCompetitorManager(config, mEtfBook, mFutureBook),
+      mFrequencyLimiter(config.mMessageFrequencyInterval, config.mMessageFrequencyLimit)
+{
+    mFutureBook.TradeOccurred = [this](OrderBook& book) { TradeOccurred(book); };
+    mEtfBook.TradeOccurred = [this](OrderBook& book) { TradeOccurred(book); };
+}
+
+void Match::AuditAllocations(double warmUpTime)
+{
+    mIsAllocationAudited = true;
+    mAllocationAuditWarmUpTime = warmUpTime;
+}
+
+BacktestResult Match::Run(BaseAutoTrader& autoTrader)
+{
+    const AllocationAuditCounts startCounts = getAllocationAuditCounts();
+
+    auto connection = std::make_unique<SimulatedConnection>();
+    mConnection = connection.get();
+    mConnection->MessageSent = [this](unsigned char messageType, unsigned char const* data, std::size_t size) {
+        AllocationAuditPause pause;
+        std::vector<unsigned char> message(data, data + size);
+        mQueue.Schedule(GetTime() + mLatency, [this, messageType, message = std::move(message)] {
+            ExecutionMessageHandler(messageType, message.data(), message.size());
+        });
+    };
+    mConnection->Closed = [this] {
+        AllocationAuditPause pause;
+        mQueue.Schedule(GetTime() + mLatency, [this] { ConnectionLost(); });
+    };
+    mSubscription = std::make_shared<SimulatedSubscription>();
+
+    mCompetitorManager.CompetitorConnected();
+    autoTrader.SetLoginDetails(BACKTEST_TEAM_NAME, BACKTEST_SECRET);
+    autoTrader.SetClock([this] { return GetTime(); });
+    autoTrader.SetExecutionConnection(std::move(connection));
+    autoTrader.SetInformationSubscription(mSubscription);
+
+    // The market opens straight away.
+    mQueue.Schedule(0.0, [this] { MarketTimerHandler(); });
+    mQueue.Schedule(0.0, [this] { TickTimerHandler(); });
+
+    while (mQueue.RunNext())
+    {
+        // Run anything the auto-trader posted while handling a message.
+        AllocationAuditScope audit{IsAudited()};
+        mContext.restart();
+        mContext.poll();
+    }
+
+    // The connection belongs to the auto-trader, which may outlive the match.
+    mConnection->MessageSent = nullptr;
+    mConnection->Closed = nullptr;
+    autoTrader.SetClock(nullptr);
+
+    const AllocationAuditCounts endCounts = getAllocationAuditCounts();
+    mResult.mAuditedAllocations = endCounts.mAllocations - startCounts.mAllocations;
+    mResult.mAuditedBytes = endCounts.mBytes - startCounts.mBytes;
+
+    mResult.mMarketEventCount = mNextEvent;
+    mResult.mMessagesSent = mConnection->GetStatistics().mMessagesSent;
+    if (mCompetitor)
+    {
+        const CompetitorAccount& account = mCompetitor->GetAccount();
+        mResult.mBreachMessage = mCompetitor->GetBreachMessage();
+        mResult.mProfitOrLoss = account.GetProfitOrLoss();
+        mResult.mMaxDrawdown = account.GetMaxDrawdown();
+        mResult.mAccountBalance = account.GetAccountBalance();
+        mResult.mTotalFees = account.GetTotalFees();
+        mResult.mEtfPosition = account.GetEtfPosition();
+        mResult.mFuturePosition = account.GetFuturePosition();
+        mResult.mBuyVolume = account.GetBuyVolume();
+        mResult.mSellVolume = account.GetSellVolume();
+    }
+    return mResult;
+}
+
+void Match::AdvanceTime()
+{
+    // As with the exchange, every event before now is applied.
+    const double now = GetTime();
+    while (mNextEvent < mEvents.size() && mEvents[mNextEvent].mTime < now)
+    {
+        mReplay.Apply(mEvents[mNextEvent++]);
+    }
+    if (mNextEvent == mEvents.size())
+    {
+        mIsDone = true;
+    }
+}
+
+void Match::MarketTimerHandler()
+{
+    if (mIsShutdown)
+    {
+        return;
+    }
+
+    AdvanceTime();
+
+    mMarketEventTime += mConfig.mMarketEventInterval;
+    mQueue.Schedule(mMarketEventTime, [this] { MarketTimerHandler(); });
+}
+
+void Match::TickTimerHandler()
+{
+    if (mIsShutdown)
+    {
+        return;
+    }
+
+    if (mIsDone)
+    {
+        Shutdown("match complete");
+        return;
+    }
+
+    OrderBookMessage message;
+    message.mSequenceNumber = mTickNumber;
+    for (OrderBook* book : {&mFutureBook, &mEtfBook})
+    {
+        message.mInstrument = book->GetInstrument();
+        book->TopLevels(message.mAskPrices, message.mAskVolumes, message.mBidPrices, message.mBidVolumes);
+        SendInformationMessage(MessageType::ORDER_BOOK_UPDATE, message);
+    }
+
+    mCompetitorManager.TimerTicked(GetTime());
+
+    if (mCompetitorManager.GetActiveCompetitorCount() == 0)
+    {
+        Shutdown("no remaining competitors");
+        return;
+    }
+
+    mTickTime += mConfig.mTickInterval;
+    ++mTickNumber;
+    mQueue.Schedule(mTickTime, [this] { TickTimerHandler(); });
+}
+
+void Match::TradeOccurred(OrderBook& book)
+{
+    // Every trade from the current event goes into one trade ticks message.
+    const auto instrument = static_cast<std::size_t>(book.GetInstrument());
+    if (!mIsTradeTicksPosted[instrument])
+    {
+        mIsTradeTicksPosted[instrument] = true;
+        mQueue.Schedule(GetTime(), [this, &book] { SendTradeTicks(book); });
+    }
+}
+
+void Match::SendTradeTicks(OrderBook& book)
+{
+    const auto instrument = static_cast<std::size_t>(book.GetInstrument());
+    mIsTradeTicksPosted[instrument] = false;
+
+    TradeTicksMessage message;
+    if (book.TradeTicks(message.mAskPrices, message.mAskVolumes, message.mBidPrices, message.mBidVolumes))
+    {
+        message.mInstrument = book.GetInstrument();
+        message.mSequenceNumber = ++mTradeTicksSequenceNumbers[instrument];
+        SendInformationMessage(MessageType::TRADE_TICKS, message);
+    }
+}
+
+void Match::Shutdown(const std::string& reason)
+{
+    RLOG(LG_BT, LogLevel::LL_INFO) << "shutting down the match: time=" << GetTime() << " reason='" << reason << '\'';
+    mIsShutdown = true;
+    mResult.mShutdownReason = reason;
+    mResult.mEndTime = GetTime();
+    mCompetitorManager.DisconnectAll(GetTime());
+}
+
+void Match::ExecutionMessageHandler(unsigned char messageType, unsigned char const* data, std::size_t size)
+{
+    if (mIsClosing)
+    {
+        return;
+    }
+
+    AdvanceTime();
+    const double now = GetTime();
+    ++mResult.mMessagesReceived;
+
+    if (mFrequencyLimiter.CheckEvent(now))
+    {
+        if (mCompetitor)
+        {
+            mCompetitor->HardBreach(now, 0, "message frequency limit breached");
+        }
+        else
+        {
+            Close();
+        }
+        return;
+    }
+
+    if (!mCompetitor)
+    {
+        if (messageType == MessageType::LOGIN && size == LoginMessage().Size())
+        {
+            auto login = makeMessage<LoginMessage>(data, size);
+            mCompetitor = mCompetitorManager.LoginCompetitor(login.mName.ToString(), login.mSecret.ToString(), this);
+        }
+        if (!mCompetitor)
+        {
+            RLOG(LG_BT, LogLevel::LL_INFO) << "first message received was not a valid login";
+            Close();
+        }
+        return;
+    }
+
+    if (!mCompetitor->MessageHandler(now, messageType, data, size))
+    {
+        RLOG(LG_BT, LogLevel::LL_INFO) << "received invalid message: time=" << now << " length=" << size
+                                       << " type=" << static_cast<int>(messageType);
+        Close();
+    }
+}
+
+void Match::Close()
+{
+    if (mIsClosing)
+    {
+        return;
+    }
+
+    // As in the exchange, the rest of the clean up happens as if the other
+    // end had disconnected, which the auto-trader hears about once anything
+    // already sent has arrived.
+    mIsClosing = true;
+    mQueue.Schedule(GetTime(), [this] { ConnectionLost(); });
+    mQueue.Schedule(GetTime() + mLatency, [this] { mConnection->Disconnect(); });
+}
+
+void Match::ConnectionLost()
+{
+    if (mIsLost)
+    {
+        return;
+    }
+
+    mIsLost = true;
+    mIsClosing = true;
+    if (mCompetitor)
+    {
+        mCompetitor->ConnectionLost(GetTime());
+    }
+    mCompetitorManager.CompetitorDisconnected();
+}
+
+void Match::SendError(unsigned long clientOrderId, const std::string& message)
+{
+    SendExecutionMessage(MessageType::ERROR_MESSAGE, ErrorMessage{clientOrderId, message});
+}
+
+void Match::SendHedgeFilled(unsigned long clientOrderId, unsigned long averagePrice, unsigned long volume)
+{
+    ++mResult.mHedgeFillCount;
+    SendExecutionMessage(MessageType::HEDGE_FILLED, HedgeFilledMessage{clientOrderId, averagePrice, volume});
+}
+
+void Match::SendOrderFilled(unsigned long clientOrderId, unsigned long price, unsigned long volume)
+{
+    // The competitor's account already includes the fill.
+    ++mResult.mOrderFillCount;
+    const long position = std::labs(mCompetitor->GetAccount().GetEtfPosition());
+    mResult.mMaxEtfPosition = std::max(mResult.mMaxEtfPosition, position);
+    SendExecutionMessage(MessageType::ORDER_FILLED, OrderFilledMessage{clientOrderId, price, volume});
+}
+
+void Match::SendOrderStatus(unsigned long clientOrderId,
+                            unsigned long fillVolume,
+                            unsigned long remainingVolume,
+                            long fees)
+{
+    SendExecutionMessage(MessageType::ORDER_STATUS,
+                         OrderStatusMessage{clientOrderId, fillVolume, remainingVolume, fees});
+}
+
+template<typename T>
+void Match::SendExecutionMessage(unsigned char messageType, const T& message)
+{
+    if (mIsLost)
+    {
+        return;
+    }
+
+    std::vector<unsigned char> data(message.Size());
+    message.Serialise(data.data());
+    mQueue.Schedule(GetTime() + mLatency, [this, messageType, data = std::move(data)] {
+        AllocationAuditScope audit{IsAudited()};
+        mConnection->Deliver(messageType, data.data(), data.size());
+    });
+}
+
+template<typename T>
+void Match::SendInformationMessage(unsigned char messageType, const T& message)
+{
+    std::vector<unsigned char> data(message.Size());
+    message.Serialise(data.data());
+    mQueue.Schedule(GetTime() + mLatency, [this, messageType, data = std::move(data)] {
+        AllocationAuditScope audit{IsAudited()};
+        mSubscription->Deliver(messageType, data.data(), data.size());
+    });
+}
+
+}
+
+Backtest::Backtest(const ExchangeConfig& config, const std::vector<MarketEvent>& events, double latency)
+    : mConfig(config), mEvents(events), mLatency(latency)
+{
+    mConfig.mTraders = {{BACKTEST_TEAM_NAME, BACKTEST_SECRET}};
+}
+
+BacktestResult Backtest::Run(BaseAutoTrader& autoTrader, boost::asio::io_context& context) const
+{
+    Match match{mConfig, mEvents, mLatency, context};
+    if (mIsAllocationAudited)
+    {
+        match.AuditAllocations(mAllocationAuditWarmUpTime);
+    }
+    return match.Run(autoTrader);
+}
+
+void Backtest::AuditAllocations(double warmUpTime)
+{
+    mIsAllocationAudited = true;
+    mAllocationAuditWarmUpTime = warmUpTime;
+}
+
+}
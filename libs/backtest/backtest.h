@@ -0,0 +1,116 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_BACKTEST_BACKTEST_H
+#define CPPREADY_TRADER_GO_LIBS_BACKTEST_BACKTEST_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+
+#include <exchange/exchangeconfig.h>
+#include <market_data/marketevents.h>
+#include <ready_trader_go/baseautotrader.h>
+
+namespace ReadyTraderGo {
+
+// Market time taken by a message between the auto-trader and the exchange.
+constexpr double DEFAULT_BACKTEST_LATENCY = 0.0001;
+
+// The name and secret an auto-trader is logged in with by a backtest.
+constexpr const char* BACKTEST_TEAM_NAME = "Backtest";
+constexpr const char* BACKTEST_SECRET = "secret";
+
+struct BacktestResult
+{
+    // Why and when (in market time) the match ended.
+    std::string mShutdownReason;
+    double mEndTime = 0.0;
+
+    // The message sent with the auto-trader's hard breach, if any.
+    std::string mBreachMessage;
+
+    // The auto-trader's account at the end of the match, in cents.
+    long mProfitOrLoss = 0;
+    long mMaxDrawdown = 0;
+    long mAccountBalance = 0;
+    long mTotalFees = 0;
+    long mEtfPosition = 0;
+    long mFuturePosition = 0;
+    unsigned long mBuyVolume = 0;
+    unsigned long mSellVolume = 0;
+
+    // The largest ETF position held (either way) and the number of order
+    // filled and hedge filled messages sent to the auto-trader.
+    long mMaxEtfPosition = 0;
+    unsigned long mOrderFillCount = 0;
+    unsigned long mHedgeFillCount = 0;
+
+    // Heap allocations made while the auto-trader handled messages, once
+    // the allocation audit warm-up had passed (see Backtest::AuditAllocations).
+    unsigned long mAuditedAllocations = 0;
+    std::size_t mAuditedBytes = 0;
+
+    unsigned long mMarketEventCount = 0;
+    unsigned long mMessagesSent = 0;
+    unsigned long mMessagesReceived = 0;
+};
+
+// Plays a match between one auto-trader and a list of market events in
+// memory, keeping market time with a simulated clock: there are no sockets,
+// no information channel and no waiting.
+//
+// The exchange end behaves as the exchange stand-in does. Market events are
+// applied every market event interval (and whenever a message arrives),
+// order books are published every tick interval, trade ticks follow the
+// trades that caused them and the auto-trader's requests are handled by a
+// Competitor with the limits, fees and account from the configuration.
+// Every message, in either direction, takes the same fixed latency.
+class Backtest
+{
+public:
+    // The events must outlive the Backtest.
+    Backtest(const ExchangeConfig& config,
+             const std::vector<MarketEvent>& events,
+             double latency = DEFAULT_BACKTEST_LATENCY);
+
+    // Run a match against a newly constructed auto-trader (whose io_context
+    // is given), which is handed an in-memory execution connection and
+    // information subscription and a clock keeping market time, and logs in
+    // as BACKTEST_TEAM_NAME. Anything it posts to its io_context is run as the match goes along. Each run
+    // starts from scratch, so one Backtest can run any number of matches,
+    // from any number of threads.
+    BacktestResult Run(BaseAutoTrader& autoTrader, boost::asio::io_context& context) const;
+
+    // Count the heap allocations the auto-trader makes while handling
+    // messages (and running anything it posted) from the given market time
+    // on, leaving out the simulated exchange's work done within its sends.
+    void AuditAllocations(double warmUpTime);
+
+private:
+    ExchangeConfig mConfig;
+    const std::vector<MarketEvent>& mEvents;
+    double mLatency;
+    bool mIsAllocationAudited = false;
+    double mAllocationAuditWarmUpTime = 0.0;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_BACKTEST_BACKTEST_H
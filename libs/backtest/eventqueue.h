@@ -0,0 +1,92 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_BACKTEST_EVENTQUEUE_H
+#define CPPREADY_TRADER_GO_LIBS_BACKTEST_EVENTQUEUE_H
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace ReadyTraderGo {
+
+// A simulated clock and the actions due to be run by it, in order of time
+// and, for actions due at the same time, in the order they were scheduled.
+class EventQueue
+{
+public:
+    EventQueue() = default;
+
+    // The time of the action being run (or last run).
+    double GetTime() const { return mTime; }
+    bool IsEmpty() const { return mEntries.empty(); }
+
+    // Run an action at the given time, or now if that is in the past.
+    void Schedule(double time, std::function<void()> action);
+
+    // Advance the clock to the next action and run it. Returns false if
+    // there was nothing to run.
+    bool RunNext();
+
+    // Discard every outstanding action.
+    void Clear() { mEntries.clear(); }
+
+private:
+    struct Entry
+    {
+        double mTime;
+        unsigned long mSequenceNumber;
+        std::function<void()> mAction;
+    };
+
+    // Orders the heap so the earliest entry is at the front.
+    static bool IsLater(const Entry& a, const Entry& b)
+    {
+        return a.mTime > b.mTime || (a.mTime == b.mTime && a.mSequenceNumber > b.mSequenceNumber);
+    }
+
+    std::vector<Entry> mEntries;
+    double mTime = 0.0;
+    unsigned long mNextSequenceNumber = 0;
+};
+
+inline void EventQueue::Schedule(double time, std::function<void()> action)
+{
+    mEntries.push_back(Entry{std::max(time, mTime), mNextSequenceNumber++, std::move(action)});
+    std::push_heap(mEntries.begin(), mEntries.end(), IsLater);
+}
+
+inline bool EventQueue::RunNext()
+{
+    if (mEntries.empty())
+    {
+        return false;
+    }
+
+    std::pop_heap(mEntries.begin(), mEntries.end(), IsLater);
+    Entry entry = std::move(mEntries.back());
+    mEntries.pop_back();
+
+    mTime = entry.mTime;
+    entry.mAction();
+    return true;
+}
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_BACKTEST_EVENTQUEUE_H
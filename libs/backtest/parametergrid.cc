@@ -0,0 +1,139 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cmath>
+#include <cstdlib>
+
+#include <ready_trader_go/error.h>
+
+#include "parametergrid.h"
+
+namespace ReadyTraderGo {
+
+namespace {
+
+double parseValue(const std::string& specification, const std::string& text)
+{
+    char* end = nullptr;
+    const double value = std::strtod(text.c_str(), &end);
+    if (text.empty() || *end != '\0' || !std::isfinite(value))
+    {
+        throw ReadyTraderGoError("bad value '" + text + "' in parameter specification '" + specification + "'");
+    }
+    return value;
+}
+
+std::vector<std::string> split(const std::string& text, char separator)
+{
+    std::vector<std::string> fields;
+    std::string::size_type start = 0;
+    std::string::size_type end;
+    while ((end = text.find(separator, start)) != std::string::npos)
+    {
+        fields.push_back(text.substr(start, end - start));
+        start = end + 1;
+    }
+    fields.push_back(text.substr(start));
+    return fields;
+}
+
+}
+
+void ParameterGrid::Add(const std::string& specification)
+{
+    const auto equals = specification.find('=');
+    if (equals == 0 || equals == std::string::npos)
+    {
+        throw ReadyTraderGoError("parameter specification '" + specification + "' is not NAME=VALUES");
+    }
+
+    const std::string name = specification.substr(0, equals);
+    const std::string values = specification.substr(equals + 1);
+    std::vector<double> list;
+
+    if (values.find(':') != std::string::npos)
+    {
+        const auto range = split(values, ':');
+        if (range.size() != 3)
+        {
+            throw ReadyTraderGoError("parameter range in '" + specification + "' is not FIRST:LAST:STEP");
+        }
+        const double first = parseValue(specification, range[0]);
+        const double last = parseValue(specification, range[1]);
+        const double step = parseValue(specification, range[2]);
+        if (step <= 0.0 || last < first)
+        {
+            throw ReadyTraderGoError("parameter range in '" + specification + "' is empty");
+        }
+
+        // Counting steps rather than adding them up keeps rounding errors
+        // from dropping the last value.
+        const auto count = static_cast<std::size_t>(std::floor((last - first) / step + 1e-9)) + 1;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            list.push_back(first + static_cast<double>(i) * step);
+        }
+    }
+    else
+    {
+        for (const auto& value : split(values, ','))
+        {
+            list.push_back(parseValue(specification, value));
+        }
+    }
+
+    Add(name, std::move(list));
+}
+
+void ParameterGrid::Add(std::string name, std::vector<double> values)
+{
+    if (values.empty())
+    {
+        throw ReadyTraderGoError("parameter '" + name + "' has no values");
+    }
+    for (const auto& axis : mAxes)
+    {
+        if (axis.first == name)
+        {
+            throw ReadyTraderGoError("parameter '" + name + "' is given more than once");
+        }
+    }
+    mAxes.emplace_back(std::move(name), std::move(values));
+}
+
+std::size_t ParameterGrid::GetSize() const
+{
+    std::size_t size = 1;
+    for (const auto& axis : mAxes)
+    {
+        size *= axis.second.size();
+    }
+    return size;
+}
+
+StrategyParameters ParameterGrid::GetParameters(std::size_t index) const
+{
+    StrategyParameters parameters;
+    for (auto axis = mAxes.rbegin(); axis != mAxes.rend(); ++axis)
+    {
+        parameters.Set(axis->first, axis->second[index % axis->second.size()]);
+        index /= axis->second.size();
+    }
+    return parameters;
+}
+
+}
@@ -0,0 +1,55 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_BACKTEST_PARAMETERGRID_H
+#define CPPREADY_TRADER_GO_LIBS_BACKTEST_PARAMETERGRID_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ready_trader_go/strategyparameters.h>
+
+namespace ReadyTraderGo {
+
+// Every combination of a list of values for each of a set of strategy
+// parameters. Combinations are numbered from zero with the values of the
+// last parameter added changing fastest.
+class ParameterGrid
+{
+public:
+    // Add a parameter from a specification of the form NAME=V1,V2,... or
+    // NAME=FIRST:LAST:STEP (which includes LAST if the steps land on it),
+    // throwing ReadyTraderGoError if the specification is not valid.
+    void Add(const std::string& specification);
+    void Add(std::string name, std::vector<double> values);
+
+    // The number of combinations, which is one for an empty grid.
+    std::size_t GetSize() const;
+
+    const std::vector<std::pair<std::string, std::vector<double>>>& GetAxes() const { return mAxes; }
+
+    StrategyParameters GetParameters(std::size_t index) const;
+
+private:
+    std::vector<std::pair<std::string, std::vector<double>>> mAxes;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_BACKTEST_PARAMETERGRID_H
@@ -0,0 +1,111 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <chrono>
+
+#include "simulatedconnectivity.h"
+
+namespace ReadyTraderGo {
+
+void SimulatedConnection::Close()
+{
+    if (mIsClosed)
+    {
+        return;
+    }
+
+    mIsClosed = true;
+    if (Closed)
+    {
+        Closed();
+    }
+}
+
+bool SimulatedConnection::SendMessage(unsigned char messageType, const ISerialisable& serialisable, SendMode)
+{
+    if (mIsClosed)
+    {
+        return false;
+    }
+
+    mBuffer.resize(serialisable.Size());
+    serialisable.Serialise(mBuffer.data());
+
+    ++mStatistics.mMessagesSent;
+    if (mBatchDepth != 0)
+    {
+        ++mBatchSize;
+    }
+    else
+    {
+        ++mStatistics.mWrites;
+    }
+
+    if (MessageSent)
+    {
+        MessageSent(messageType, mBuffer.data(), mBuffer.size());
+    }
+    if (mBatchDepth == 0)
+    {
+        OnMessagesWritten();
+    }
+    return true;
+}
+
+void SimulatedConnection::Flush()
+{
+    if (mBatchDepth == 0 || --mBatchDepth != 0)
+    {
+        return;
+    }
+
+    if (mBatchSize != 0)
+    {
+        ++mStatistics.mWrites;
+        ++mStatistics.mBatches;
+        mStatistics.mBatchedMessages += mBatchSize;
+        mStatistics.mMaximumBatchSize = std::max(mStatistics.mMaximumBatchSize, mBatchSize);
+        mBatchSize = 0;
+        OnMessagesWritten();
+    }
+}
+
+void SimulatedConnection::Deliver(unsigned char messageType, unsigned char const* data, std::size_t size)
+{
+    if (!mIsClosed)
+    {
+        OnMessageReceipt(messageType, data, size, std::chrono::steady_clock::now());
+    }
+}
+
+void SimulatedConnection::Disconnect()
+{
+    if (!mIsClosed)
+    {
+        mIsClosed = true;
+        OnDisconnect();
+    }
+}
+
+void SimulatedSubscription::Deliver(unsigned char messageType, unsigned char const* data, std::size_t size)
+{
+    ++mStatistics.mFramesReceived;
+    OnMessageReceipt(messageType, data, size, std::chrono::steady_clock::now());
+}
+
+}
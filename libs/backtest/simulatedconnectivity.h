@@ -0,0 +1,81 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_BACKTEST_SIMULATEDCONNECTIVITY_H
+#define CPPREADY_TRADER_GO_LIBS_BACKTEST_SIMULATEDCONNECTIVITY_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include <ready_trader_go/connectivitytypes.h>
+
+namespace ReadyTraderGo {
+
+// The auto-trader's end of an in-memory execution connection. Each message
+// sent is serialised (without the message header) and handed to
+// MessageSent, and messages from the exchange are passed in with Deliver().
+// Messages are received with the current steady clock time, so tick-to-trade
+// statistics measure the auto-trader's own processing time.
+class SimulatedConnection : public IConnection
+{
+public:
+    SimulatedConnection() = default;
+
+    void AsyncRead() override {}
+    void Close() override;
+    std::size_t Poll() override { return 0; }
+    bool SendMessage(unsigned char messageType, const ISerialisable& serialisable, SendMode mode) override;
+    void BeginBatch() override { ++mBatchDepth; }
+    void Flush() override;
+
+    // Deliver a message from the exchange, unless the connection is closed.
+    void Deliver(unsigned char messageType, unsigned char const* data, std::size_t size);
+
+    // Close the connection from the exchange's end.
+    void Disconnect();
+
+    bool IsClosed() const { return mIsClosed; }
+
+    // Called for each message sent and when the auto-trader closes the
+    // connection.
+    std::function<void(unsigned char, unsigned char const*, std::size_t)> MessageSent;
+    std::function<void()> Closed;
+
+private:
+    std::vector<unsigned char> mBuffer;
+    unsigned long mBatchDepth = 0;
+    unsigned long mBatchSize = 0;
+    bool mIsClosed = false;
+};
+
+// The auto-trader's end of an in-memory information channel.
+class SimulatedSubscription : public ISubscription
+{
+public:
+    SimulatedSubscription() = default;
+
+    void AsyncReceive() override {}
+    std::size_t Poll() override { return 0; }
+
+    // Deliver a message from the exchange.
+    void Deliver(unsigned char messageType, unsigned char const* data, std::size_t size);
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_BACKTEST_SIMULATEDCONNECTIVITY_H
@@ -0,0 +1,177 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <utility>
+
+#include "workstealingpool.h"
+
+namespace ReadyTraderGo {
+
+namespace {
+
+// The pool and queue of the thread running this code, if it is one of a
+// pool's threads.
+thread_local const WorkStealingPool* currentPool = nullptr;
+thread_local std::size_t currentQueue = 0;
+
+}
+
+WorkStealingPool::WorkStealingPool(std::size_t threadCount)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    for (std::size_t i = 0; i < threadCount; ++i)
+    {
+        mQueues.push_back(std::make_unique<Queue>());
+    }
+    for (std::size_t i = 0; i < threadCount; ++i)
+    {
+        mThreads.emplace_back([this, i] { WorkerThread(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mAllFinished.wait(lock, [this] { return mUnfinishedCount == 0; });
+        mIsStopping = true;
+    }
+    mTaskQueued.notify_all();
+    for (auto& thread : mThreads)
+    {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::Submit(std::function<void()> task)
+{
+    const std::size_t index = (currentPool == this)
+                              ? currentQueue
+                              : mNextQueue.fetch_add(1, std::memory_order_relaxed) % mQueues.size();
+    // Counted before the task is queued, so a task can never be taken (and
+    // finished) before it is counted. A thread that sees the count before
+    // the task is queued finds nothing and looks again.
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ++mQueuedCount;
+        ++mUnfinishedCount;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mQueues[index]->mMutex);
+        mQueues[index]->mTasks.push_back(std::move(task));
+    }
+    mTaskQueued.notify_one();
+}
+
+void WorkStealingPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mAllFinished.wait(lock, [this] { return mUnfinishedCount == 0; });
+    if (mException)
+    {
+        std::rethrow_exception(std::exchange(mException, nullptr));
+    }
+}
+
+bool WorkStealingPool::Pop(std::size_t index, std::function<void()>& task)
+{
+    Queue& queue = *mQueues[index];
+    std::lock_guard<std::mutex> lock(queue.mMutex);
+    if (queue.mTasks.empty())
+    {
+        return false;
+    }
+    task = std::move(queue.mTasks.back());
+    queue.mTasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::Steal(std::size_t index, std::function<void()>& task)
+{
+    for (std::size_t i = 1; i < mQueues.size(); ++i)
+    {
+        Queue& queue = *mQueues[(index + i) % mQueues.size()];
+        std::lock_guard<std::mutex> lock(queue.mMutex);
+        if (!queue.mTasks.empty())
+        {
+            task = std::move(queue.mTasks.front());
+            queue.mTasks.pop_front();
+            mStealCount.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::WorkerThread(std::size_t index)
+{
+    currentPool = this;
+    currentQueue = index;
+
+    std::function<void()> task;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mTaskQueued.wait(lock, [this] { return mQueuedCount != 0 || mIsStopping; });
+            if (mQueuedCount == 0)
+            {
+                return;
+            }
+        }
+
+        if (!Pop(index, task) && !Steal(index, task))
+        {
+            // Another thread got there first, or the task counted is still
+            // being queued.
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            --mQueuedCount;
+        }
+
+        std::exception_ptr exception;
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+        task = nullptr;
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (exception && !mException)
+        {
+            mException = exception;
+        }
+        if (--mUnfinishedCount == 0)
+        {
+            mAllFinished.notify_all();
+        }
+    }
+}
+
+}
@@ -0,0 +1,95 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_BACKTEST_WORKSTEALINGPOOL_H
+#define CPPREADY_TRADER_GO_LIBS_BACKTEST_WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ReadyTraderGo {
+
+// A fixed set of threads running independent tasks, such as backtests.
+//
+// Every thread has its own queue. Tasks submitted from outside the pool are
+// dealt out to the queues in turn and tasks submitted by a task go to the
+// queue of the thread running it. A thread takes the newest task from its
+// own queue and, when that is empty, steals the oldest task from another
+// thread's queue, so threads that draw short tasks keep busy with the work
+// queued behind long ones.
+class WorkStealingPool
+{
+public:
+    // Start the given number of threads, or one per core if it is zero.
+    explicit WorkStealingPool(std::size_t threadCount = 0);
+
+    // Run every task already submitted and then stop the threads.
+    ~WorkStealingPool();
+
+    // WorkStealingPool instances can't be copied
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    std::size_t GetThreadCount() const { return mThreads.size(); }
+
+    // The number of tasks run by a thread other than the one they were
+    // queued for.
+    unsigned long GetStealCount() const { return mStealCount.load(std::memory_order_relaxed); }
+
+    void Submit(std::function<void()> task);
+
+    // Wait until every submitted task has finished. If any task threw, the
+    // first exception is rethrown (once).
+    void Wait();
+
+private:
+    struct Queue
+    {
+        std::mutex mMutex;
+        std::deque<std::function<void()>> mTasks;
+    };
+
+    bool Pop(std::size_t index, std::function<void()>& task);
+    bool Steal(std::size_t index, std::function<void()>& task);
+    void WorkerThread(std::size_t index);
+
+    std::vector<std::unique_ptr<Queue>> mQueues;
+    std::vector<std::thread> mThreads;
+    std::atomic<std::size_t> mNextQueue{0};
+    std::atomic<unsigned long> mStealCount{0};
+
+    // Guards the counts, the stop flag and the exception.
+    std::mutex mMutex;
+    std::condition_variable mTaskQueued;
+    std::condition_variable mAllFinished;
+    std::size_t mQueuedCount = 0;
+    std::size_t mUnfinishedCount = 0;
+    bool mIsStopping = false;
+    std::exception_ptr mException;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_BACKTEST_WORKSTEALINGPOOL_H
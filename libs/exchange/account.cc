@@ -0,0 +1,67 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cmath>
+
+#include "account.h"
+
+namespace ReadyTraderGo {
+
+void CompetitorAccount::Transact(Instrument instrument,
+                                 Side side,
+                                 unsigned long price,
+                                 unsigned long volume,
+                                 long fee)
+{
+    const auto value = static_cast<long>(price * volume);
+    mAccountBalance += (side == Side::SELL) ? value : -value;
+    mAccountBalance -= fee;
+    mTotalFees += fee;
+
+    const long delta = (side == Side::SELL) ? -static_cast<long>(volume) : static_cast<long>(volume);
+    if (instrument == Instrument::FUTURE)
+    {
+        mFuturePosition += delta;
+    }
+    else
+    {
+        ((side == Side::SELL) ? mSellVolume : mBuyVolume) += volume;
+        mEtfPosition += delta;
+    }
+}
+
+void CompetitorAccount::Update(unsigned long futurePrice, unsigned long etfPrice)
+{
+    long delta = std::lround(mEtfClamp * static_cast<double>(futurePrice));
+    delta -= delta % static_cast<long>(mTickSize);
+    const long minimumPrice = static_cast<long>(futurePrice) - delta;
+    const long maximumPrice = static_cast<long>(futurePrice) + delta;
+    const long clamped = std::min(std::max(static_cast<long>(etfPrice), minimumPrice), maximumPrice);
+
+    mProfitOrLoss = mAccountBalance + mFuturePosition * static_cast<long>(futurePrice) + mEtfPosition * clamped;
+    if (mProfitOrLoss > mMaxProfit)
+    {
+        mMaxProfit = mProfitOrLoss;
+    }
+    if (mMaxProfit - mProfitOrLoss > mMaxDrawdown)
+    {
+        mMaxDrawdown = mMaxProfit - mProfitOrLoss;
+    }
+}
+
+}
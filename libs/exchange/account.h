@@ -0,0 +1,67 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_EXCHANGE_ACCOUNT_H
+#define CPPREADY_TRADER_GO_LIBS_EXCHANGE_ACCOUNT_H
+
+#include <ready_trader_go/types.h>
+
+namespace ReadyTraderGo {
+
+// A competitor's account, valued the same way as by the Python exchange:
+// the future position at the future price and the ETF position at the ETF
+// price clamped to within a fraction (the ETF clamp) of the future price.
+// Prices and amounts are in cents.
+class CompetitorAccount
+{
+public:
+    CompetitorAccount(unsigned long tickSize, double etfClamp) : mTickSize(tickSize), mEtfClamp(etfClamp) {}
+
+    // Record a trade, of the ETF or of the future (a hedge).
+    void Transact(Instrument instrument, Side side, unsigned long price, unsigned long volume, long fee);
+
+    // Revalue the account at the given prices.
+    void Update(unsigned long futurePrice, unsigned long etfPrice);
+
+    long GetAccountBalance() const { return mAccountBalance; }
+    unsigned long GetBuyVolume() const { return mBuyVolume; }
+    unsigned long GetSellVolume() const { return mSellVolume; }
+    long GetEtfPosition() const { return mEtfPosition; }
+    long GetFuturePosition() const { return mFuturePosition; }
+    long GetMaxDrawdown() const { return mMaxDrawdown; }
+    long GetMaxProfit() const { return mMaxProfit; }
+    long GetProfitOrLoss() const { return mProfitOrLoss; }
+    long GetTotalFees() const { return mTotalFees; }
+
+private:
+    unsigned long mTickSize;
+    double mEtfClamp;
+
+    long mAccountBalance = 0;
+    unsigned long mBuyVolume = 0;
+    unsigned long mSellVolume = 0;
+    long mEtfPosition = 0;
+    long mFuturePosition = 0;
+    long mMaxDrawdown = 0;
+    long mMaxProfit = 0;
+    long mProfitOrLoss = 0;
+    long mTotalFees = 0;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_EXCHANGE_ACCOUNT_H
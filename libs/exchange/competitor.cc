@@ -0,0 +1,459 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include <ready_trader_go/logging.h>
+#include <ready_trader_go/protocol.h>
+
+#include "competitor.h"
+
+RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_CMP, "COMPETITOR")
+
+namespace ReadyTraderGo {
+
+// The last traded price, or failing that the midpoint (or zero).
+static unsigned long getPrice(const OrderBook& book)
+{
+    const unsigned long lastTradedPrice = book.GetLastTradedPrice();
+    return (lastTradedPrice != 0) ? lastTradedPrice : static_cast<unsigned long>(std::lround(book.GetMidpointPrice()));
+}
+
+Competitor::Competitor(std::string name,
+                       ICompetitorConnection* connection,
+                       OrderBook& etfBook,
+                       OrderBook& futureBook,
+                       const CompetitorLimits& limits,
+                       const CompetitorAccount& account)
+    : mName(std::move(name)),
+      mConnection(connection),
+      mEtfBook(etfBook),
+      mFutureBook(futureBook),
+      mLimits(limits),
+      mAccount(account)
+{
+}
+
+void Competitor::Disconnect(double now)
+{
+    if (mConnection)
+    {
+        RLOG(LG_CMP, LogLevel::LL_INFO) << '\'' << mName << "' closing execution channel at time=" << now;
+        mConnection->Close();
+    }
+}
+
+void Competitor::ConnectionLost(double now)
+{
+    mConnection = nullptr;
+    RLOG(LG_CMP, LogLevel::LL_INFO) << '\'' << mName << "' disconnected: time=" << now
+                                    << " etf_position=" << mAccount.GetEtfPosition()
+                                    << " future_position=" << mAccount.GetFuturePosition()
+                                    << " fees=" << mAccount.GetTotalFees()
+                                    << " balance=" << mAccount.GetAccountBalance()
+                                    << " profit=" << mAccount.GetProfitOrLoss();
+
+    // Cancelling removes orders from the map, so work from a copy.
+    std::vector<Order*> orders;
+    orders.reserve(mOrders.size());
+    for (auto& order : mOrders)
+    {
+        orders.push_back(order.second);
+    }
+    for (Order* order : orders)
+    {
+        mEtfBook.Cancel(now, *order);
+    }
+}
+
+void Competitor::HardBreach(double now, unsigned long clientOrderId, const std::string& message)
+{
+    RLOG(LG_CMP, LogLevel::LL_INFO) << '\'' << mName << "' breached a limit at time=" << now << ": " << message;
+    if (mBreachMessage.empty())
+    {
+        mBreachMessage = message;
+    }
+    if (mConnection)
+    {
+        SendError(now, clientOrderId, message);
+        Disconnect(now);
+    }
+}
+
+void Competitor::TimerTicked(double now, unsigned long futurePrice, unsigned long etfPrice)
+{
+    CheckUnhedgedLots(now);
+    mAccount.Update(futurePrice, etfPrice);
+}
+
+void Competitor::CheckUnhedgedLots(double now)
+{
+    if (mUnhedgedLots.CheckExpiry(now))
+    {
+        RLOG(LG_CMP, LogLevel::LL_INFO) << '\'' << mName << "' unhedged lots timer expired: etf="
+                                        << mAccount.GetEtfPosition() << " fut=" << mAccount.GetFuturePosition()
+                                        << " rel=" << mUnhedgedLots.GetRelativePosition();
+        HardBreach(now, 0, "held unhedged lots for longer than the time limit");
+    }
+}
+
+bool Competitor::MessageHandler(double now, unsigned char messageType, unsigned char const* data, std::size_t size)
+{
+    // The unhedged lots time limit is checked on each timer tick, and here
+    // so that nothing is done after it has expired.
+    CheckUnhedgedLots(now);
+
+    if (messageType == MessageType::AMEND_ORDER && size == AmendMessage().Size())
+    {
+        auto amend = makeMessage<AmendMessage>(data, size);
+        AmendMessageHandler(now, amend.mClientOrderId, amend.mNewVolume);
+    }
+    else if (messageType == MessageType::CANCEL_ORDER && size == CancelMessage().Size())
+    {
+        auto cancel = makeMessage<CancelMessage>(data, size);
+        CancelMessageHandler(now, cancel.mClientOrderId);
+    }
+    else if (messageType == MessageType::HEDGE_ORDER && size == HedgeMessage().Size())
+    {
+        auto hedge = makeMessage<HedgeMessage>(data, size);
+        HedgeMessageHandler(now, hedge.mClientOrderId, hedge.mSide, hedge.mPrice, hedge.mVolume);
+    }
+    else if (messageType == MessageType::INSERT_ORDER && size == InsertMessage().Size())
+    {
+        auto insert = makeMessage<InsertMessage>(data, size);
+        InsertMessageHandler(now, insert.mClientOrderId, insert.mSide, insert.mPrice, insert.mVolume,
+                             insert.mLifespan);
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+void Competitor::RemoveOrder(const Order& order)
+{
+    auto& prices = (order.mSide == Side::BUY) ? mBuyPrices : mSellPrices;
+    prices.erase(prices.find(order.mPrice));
+    mOrders.erase(order.mClientOrderId);
+}
+
+void Competitor::SendError(double now, unsigned long clientOrderId, const std::string& message)
+{
+    if (mConnection)
+    {
+        mConnection->SendError(clientOrderId, message);
+    }
+    RLOG(LG_CMP, LogLevel::LL_INFO) << '\'' << mName << "' sent error message: time=" << now
+                                    << " client_order_id=" << clientOrderId << " message='" << message << '\'';
+}
+
+void Competitor::OrderAmended(double now, Order& order, unsigned long volumeRemoved)
+{
+    if (mConnection)
+    {
+        mConnection->SendOrderStatus(order.mClientOrderId, order.mVolume - order.mRemainingVolume,
+                                     order.mRemainingVolume, order.mTotalFees);
+    }
+    mActiveVolume -= volumeRemoved;
+    if (order.mRemainingVolume == 0)
+    {
+        RemoveOrder(order);
+    }
+}
+
+void Competitor::OrderCancelled(double now, Order& order, unsigned long volumeRemoved)
+{
+    if (mConnection)
+    {
+        mConnection->SendOrderStatus(order.mClientOrderId, order.mVolume - volumeRemoved,
+                                     order.mRemainingVolume, order.mTotalFees);
+    }
+    mActiveVolume -= volumeRemoved;
+    RemoveOrder(order);
+}
+
+void Competitor::OrderFilled(double now, Order& order, unsigned long price, unsigned long volume, long fee)
+{
+    const unsigned long clientOrderId = order.mClientOrderId;
+
+    mActiveVolume -= volume;
+    mUnhedgedLots.ApplyPositionDelta(now, (order.mSide == Side::BUY) ? static_cast<long>(volume)
+                                                                      : -static_cast<long>(volume));
+    mAccount.Transact(Instrument::ETF, order.mSide, price, volume, fee);
+    mAccount.Update(getPrice(mFutureBook), price);
+    if (mConnection)
+    {
+        mConnection->SendOrderFilled(clientOrderId, price, volume);
+        mConnection->SendOrderStatus(clientOrderId, order.mVolume - order.mRemainingVolume,
+                                     order.mRemainingVolume, order.mTotalFees);
+    }
+    if (order.mRemainingVolume == 0)
+    {
+        RemoveOrder(order);
+    }
+
+    const long etfPosition = mAccount.GetEtfPosition();
+    if (etfPosition < -mLimits.mPositionLimit || etfPosition > mLimits.mPositionLimit)
+    {
+        HardBreach(now, clientOrderId, "ETF position limit breached");
+    }
+}
+
+void Competitor::OrderPlaced(double now, Order& order)
+{
+    // Only send an order status if the order has not partially filled
+    if (order.mVolume == order.mRemainingVolume && mConnection)
+    {
+        mConnection->SendOrderStatus(order.mClientOrderId, 0, order.mRemainingVolume, order.mTotalFees);
+    }
+}
+
+void Competitor::AmendMessageHandler(double now, unsigned long clientOrderId, unsigned long volume)
+{
+    if (static_cast<long>(clientOrderId) > mLastClientOrderId)
+    {
+        SendError(now, clientOrderId, "out-of-order client_order_id in amend message");
+        return;
+    }
+
+    auto it = mOrders.find(clientOrderId);
+    if (it != mOrders.end())
+    {
+        if (volume > it->second->mVolume)
+        {
+            SendError(now, clientOrderId, "amend operation would increase order volume");
+        }
+        else
+        {
+            mEtfBook.Amend(now, *it->second, volume);
+        }
+    }
+}
+
+void Competitor::CancelMessageHandler(double now, unsigned long clientOrderId)
+{
+    if (static_cast<long>(clientOrderId) > mLastClientOrderId)
+    {
+        SendError(now, clientOrderId, "out-of-order client_order_id in cancel message");
+        return;
+    }
+
+    auto it = mOrders.find(clientOrderId);
+    if (it != mOrders.end())
+    {
+        mEtfBook.Cancel(now, *it->second);
+    }
+}
+
+void Competitor::HedgeMessageHandler(double now,
+                                     unsigned long clientOrderId,
+                                     Side side,
+                                     unsigned long price,
+                                     unsigned long volume)
+{
+    if (static_cast<long>(clientOrderId) <= mLastClientOrderId)
+    {
+        SendError(now, clientOrderId, "duplicate or out-of-order client_order_id");
+        return;
+    }
+    mLastClientOrderId = static_cast<long>(clientOrderId);
+
+    if (side != Side::BUY && side != Side::SELL)
+    {
+        SendError(now, clientOrderId, std::to_string(static_cast<int>(side)) + " is not a valid side");
+        return;
+    }
+    if (price < MINIMUM_BID || price > MAXIMUM_ASK)
+    {
+        SendError(now, clientOrderId, std::to_string(price) + " is not a valid price");
+        return;
+    }
+    if (price % mLimits.mTickSize != 0)
+    {
+        SendError(now, clientOrderId, "price is not a multiple of tick size");
+        return;
+    }
+    if (volume < 1)
+    {
+        SendError(now, clientOrderId, std::to_string(volume) + " is not a valid volume");
+        return;
+    }
+    if (now == 0.0)
+    {
+        SendError(now, clientOrderId, "order rejected: market not yet open");
+        return;
+    }
+
+    auto [volumeTraded, averagePrice] = mFutureBook.TryTrade(side, price, volume);
+    if (volumeTraded == 0)
+    {
+        averagePrice = mFutureBook.GetLastTradedPrice();
+        if (averagePrice == 0)
+        {
+            SendError(now, clientOrderId, "order rejected: cannot determine future price");
+            return;
+        }
+    }
+
+    mUnhedgedLots.ApplyPositionDelta(now, (side == Side::BUY) ? static_cast<long>(volume)
+                                                                : -static_cast<long>(volume));
+    mAccount.Transact(Instrument::FUTURE, side, averagePrice, volume, 0);
+    mAccount.Update(getPrice(mFutureBook), getPrice(mEtfBook));
+    if (mConnection)
+    {
+        mConnection->SendHedgeFilled(clientOrderId, averagePrice, volume);
+    }
+
+    const long futurePosition = mAccount.GetFuturePosition();
+    if (futurePosition < -mLimits.mPositionLimit || futurePosition > mLimits.mPositionLimit)
+    {
+        HardBreach(now, clientOrderId, "future position limit breached");
+    }
+}
+
+void Competitor::InsertMessageHandler(double now,
+                                      unsigned long clientOrderId,
+                                      Side side,
+                                      unsigned long price,
+                                      unsigned long volume,
+                                      Lifespan lifespan)
+{
+    if (static_cast<long>(clientOrderId) <= mLastClientOrderId)
+    {
+        SendError(now, clientOrderId, "duplicate or out-of-order client_order_id");
+        return;
+    }
+    mLastClientOrderId = static_cast<long>(clientOrderId);
+
+    if (side != Side::BUY && side != Side::SELL)
+    {
+        SendError(now, clientOrderId, std::to_string(static_cast<int>(side)) + " is not a valid side");
+        return;
+    }
+    if (lifespan != Lifespan::FILL_AND_KILL && lifespan != Lifespan::GOOD_FOR_DAY)
+    {
+        SendError(now, clientOrderId, std::to_string(static_cast<int>(lifespan)) + " is not a valid lifespan");
+        return;
+    }
+    if (price < MINIMUM_BID || price > MAXIMUM_ASK)
+    {
+        SendError(now, clientOrderId, std::to_string(price) + " is not a valid price");
+        return;
+    }
+    if (price % mLimits.mTickSize != 0)
+    {
+        SendError(now, clientOrderId, "price is not a multiple of tick size");
+        return;
+    }
+    if (mOrders.size() == mLimits.mActiveOrderCountLimit)
+    {
+        SendError(now, clientOrderId, "order rejected: active order count limit breached");
+        return;
+    }
+    if (volume < 1)
+    {
+        SendError(now, clientOrderId, std::to_string(volume) + " is not a valid volume");
+        return;
+    }
+    if (mActiveVolume + volume > mLimits.mActiveVolumeLimit)
+    {
+        SendError(now, clientOrderId, "order rejected: active order volume limit breached");
+        return;
+    }
+    if (now == 0.0)
+    {
+        SendError(now, clientOrderId, "order rejected: market not yet open");
+        return;
+    }
+    if ((side == Side::BUY && !mSellPrices.empty() && price >= *mSellPrices.begin())
+        || (side == Side::SELL && !mBuyPrices.empty() && price <= *mBuyPrices.rbegin()))
+    {
+        SendError(now, clientOrderId, "order rejected: in cross with an existing order");
+        return;
+    }
+
+    if (side == Side::BUY)
+    {
+        mBuyPrices.insert(price);
+    }
+    else
+    {
+        mSellPrices.insert(price);
+    }
+    mActiveVolume += volume;
+
+    // Only an order left resting in the book is kept, the callbacks having
+    // already accounted for one that was filled or cancelled straight away.
+    if (Order* order = mEtfBook.Insert(now, clientOrderId, lifespan, side, price, volume, this))
+    {
+        mOrders.emplace(clientOrderId, order);
+    }
+}
+
+CompetitorManager::CompetitorManager(const ExchangeConfig& config, OrderBook& etfBook, OrderBook& futureBook)
+    : mEtfBook(etfBook),
+      mFutureBook(futureBook),
+      mAccount(static_cast<unsigned long>(std::lround(config.mTickSize * 100.0)), config.mEtfClamp),
+      mTraders(config.mTraders)
+{
+    mLimits.mPositionLimit = config.mPositionLimit;
+    mLimits.mActiveOrderCountLimit = config.mActiveOrderCountLimit;
+    mLimits.mActiveVolumeLimit = config.mActiveVolumeLimit;
+    mLimits.mTickSize = static_cast<unsigned long>(std::lround(config.mTickSize * 100.0));
+}
+
+Competitor* CompetitorManager::LoginCompetitor(const std::string& name,
+                                               const std::string& secret,
+                                               ICompetitorConnection* connection)
+{
+    auto trader = mTraders.find(name);
+    if (mCompetitors.count(name) != 0 || trader == mTraders.end() || trader->second != secret)
+    {
+        return nullptr;
+    }
+
+    auto& competitor = mCompetitors[name];
+    competitor = std::make_unique<Competitor>(name, connection, mEtfBook, mFutureBook, mLimits, mAccount);
+    if (mIsMarketOpen)
+    {
+        RLOG(LG_CMP, LogLevel::LL_WARNING) << "competitor logged in after market open: name='" << name << '\'';
+    }
+    return competitor.get();
+}
+
+void CompetitorManager::DisconnectAll(double now)
+{
+    for (auto& competitor : mCompetitors)
+    {
+        competitor.second->Disconnect(now);
+    }
+}
+
+void CompetitorManager::TimerTicked(double now)
+{
+    const unsigned long futurePrice = mFutureBook.GetLastTradedPrice();
+    const unsigned long etfPrice = mEtfBook.GetLastTradedPrice();
+    for (auto& competitor : mCompetitors)
+    {
+        competitor.second->TimerTicked(now, futurePrice, etfPrice);
+    }
+}
+
+}
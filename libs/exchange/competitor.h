@@ -0,0 +1,169 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_EXCHANGE_COMPETITOR_H
+#define CPPREADY_TRADER_GO_LIBS_EXCHANGE_COMPETITOR_H
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+#include <matching_engine/orderbook.h>
+#include <ready_trader_go/types.h>
+
+#include "account.h"
+#include "exchangeconfig.h"
+#include "unhedgedlots.h"
+
+namespace ReadyTraderGo {
+
+// The exchange's end of a competitor's execution connection.
+struct ICompetitorConnection
+{
+    virtual ~ICompetitorConnection() = default;
+
+    // Close the connection once anything already sent has been written.
+    virtual void Close() = 0;
+
+    virtual void SendError(unsigned long clientOrderId, const std::string& message) = 0;
+    virtual void SendHedgeFilled(unsigned long clientOrderId, unsigned long averagePrice, unsigned long volume) = 0;
+    virtual void SendOrderFilled(unsigned long clientOrderId, unsigned long price, unsigned long volume) = 0;
+    virtual void SendOrderStatus(unsigned long clientOrderId,
+                                 unsigned long fillVolume,
+                                 unsigned long remainingVolume,
+                                 long fees) = 0;
+};
+
+struct CompetitorLimits
+{
+    long mPositionLimit = 0;
+    std::size_t mActiveOrderCountLimit = 0;
+    unsigned long mActiveVolumeLimit = 0;
+    unsigned long mTickSize = 0;
+};
+
+// A competitor (one logged in auto-trader), which validates its requests,
+// trades them in the order books and enforces its limits the same way as
+// the Python exchange.
+class Competitor : public IOrderListener
+{
+public:
+    Competitor(std::string name,
+               ICompetitorConnection* connection,
+               OrderBook& etfBook,
+               OrderBook& futureBook,
+               const CompetitorLimits& limits,
+               const CompetitorAccount& account);
+
+    const std::string& GetName() const { return mName; }
+    const CompetitorAccount& GetAccount() const { return mAccount; }
+    long GetEtfPosition() const { return mAccount.GetEtfPosition(); }
+    long GetFuturePosition() const { return mAccount.GetFuturePosition(); }
+
+    // The message sent with the competitor's hard breach, or an empty string
+    // if it hasn't breached a limit.
+    const std::string& GetBreachMessage() const { return mBreachMessage; }
+
+    // Close the competitor's execution connection.
+    void Disconnect(double now);
+
+    // Called when the competitor's execution connection has gone, after
+    // which all of its orders are cancelled.
+    void ConnectionLost(double now);
+
+    // Send an error message and close the execution connection.
+    void HardBreach(double now, unsigned long clientOrderId, const std::string& message);
+
+    // Called on each timer tick with the last traded prices (or zero).
+    void TimerTicked(double now, unsigned long futurePrice, unsigned long etfPrice);
+
+    // Decode a request (any message other than a login) and pass it to the
+    // matching handler. Returns false if it isn't a valid request.
+    bool MessageHandler(double now, unsigned char messageType, unsigned char const* data, std::size_t size);
+
+    void AmendMessageHandler(double now, unsigned long clientOrderId, unsigned long volume);
+    void CancelMessageHandler(double now, unsigned long clientOrderId);
+    void HedgeMessageHandler(double now, unsigned long clientOrderId, Side side, unsigned long price,
+                             unsigned long volume);
+    void InsertMessageHandler(double now, unsigned long clientOrderId, Side side, unsigned long price,
+                              unsigned long volume, Lifespan lifespan);
+
+    // IOrderListener callbacks
+    void OrderAmended(double now, Order& order, unsigned long volumeRemoved) override;
+    void OrderCancelled(double now, Order& order, unsigned long volumeRemoved) override;
+    void OrderFilled(double now, Order& order, unsigned long price, unsigned long volume, long fee) override;
+    void OrderPlaced(double now, Order& order) override;
+
+private:
+    void CheckUnhedgedLots(double now);
+    void RemoveOrder(const Order& order);
+    void SendError(double now, unsigned long clientOrderId, const std::string& message);
+
+    std::string mName;
+    ICompetitorConnection* mConnection;
+    OrderBook& mEtfBook;
+    OrderBook& mFutureBook;
+    CompetitorLimits mLimits;
+    CompetitorAccount mAccount;
+    UnhedgedLots mUnhedgedLots;
+    std::string mBreachMessage;
+
+    std::unordered_map<unsigned long, Order*> mOrders;
+    std::multiset<unsigned long> mBuyPrices;
+    std::multiset<unsigned long> mSellPrices;
+    unsigned long mActiveVolume = 0;
+    long mLastClientOrderId = -1;
+};
+
+// Logs competitors in and keeps track of how many are connected.
+class CompetitorManager
+{
+public:
+    CompetitorManager(const ExchangeConfig& config, OrderBook& etfBook, OrderBook& futureBook);
+
+    // Return the competitor for the given login details, or nullptr if they
+    // are wrong or the competitor is already logged in.
+    Competitor* LoginCompetitor(const std::string& name, const std::string& secret,
+                                ICompetitorConnection* connection);
+
+    void CompetitorConnected() { ++mActiveCompetitorCount; }
+    void CompetitorDisconnected() { --mActiveCompetitorCount; }
+    unsigned long GetActiveCompetitorCount() const { return mActiveCompetitorCount; }
+
+    void DisconnectAll(double now);
+    void SetMarketOpen() { mIsMarketOpen = true; }
+
+    // Revalue every competitor's account and check its unhedged lots.
+    void TimerTicked(double now);
+
+private:
+    OrderBook& mEtfBook;
+    OrderBook& mFutureBook;
+    CompetitorLimits mLimits;
+    CompetitorAccount mAccount;
+    std::map<std::string, std::string> mTraders;
+    std::map<std::string, std::unique_ptr<Competitor>> mCompetitors;
+    unsigned long mActiveCompetitorCount = 0;
+    bool mIsMarketOpen = false;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_EXCHANGE_COMPETITOR_H
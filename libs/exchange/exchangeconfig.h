@@ -0,0 +1,98 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_EXCHANGE_EXCHANGECONFIG_H
+#define CPPREADY_TRADER_GO_LIBS_EXCHANGE_EXCHANGECONFIG_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+#include <boost/property_tree/ptree.hpp>
+
+namespace ReadyTraderGo {
+
+// The subset of the Python exchange's exchange.json used by the exchange
+// stand-in and the backtester.
+struct ExchangeConfig
+{
+    void readFromPropertyTree(const boost::property_tree::ptree& tree)
+    {
+        mMarketDataFile = tree.get<std::string>("Engine.MarketDataFile");
+        mMarketEventInterval = tree.get<double>("Engine.MarketEventInterval");
+        mMarketOpenDelay = tree.get<double>("Engine.MarketOpenDelay");
+        mSpeed = tree.get<double>("Engine.Speed");
+        mTickInterval = tree.get<double>("Engine.TickInterval");
+
+        mExecHost = tree.get<std::string>("Execution.Host");
+        mExecPort = tree.get<unsigned short>("Execution.Port");
+        mExecReceiveBufferSize = tree.get<std::size_t>("Execution.ReceiveBufferSize", 65536);
+        mExecSendBufferSize = tree.get<std::size_t>("Execution.SendBufferSize", 65536);
+
+        mMakerFee = tree.get<double>("Fees.Maker");
+        mTakerFee = tree.get<double>("Fees.Taker");
+
+        mInfoType = tree.get<std::string>("Information.Type");
+        mInfoName = tree.get<std::string>("Information.Name");
+
+        mEtfClamp = tree.get<double>("Instrument.EtfClamp");
+        mTickSize = tree.get<double>("Instrument.TickSize");
+
+        mActiveOrderCountLimit = tree.get<std::size_t>("Limits.ActiveOrderCountLimit");
+        mActiveVolumeLimit = tree.get<unsigned long>("Limits.ActiveVolumeLimit");
+        mMessageFrequencyInterval = tree.get<double>("Limits.MessageFrequencyInterval");
+        mMessageFrequencyLimit = tree.get<unsigned long>("Limits.MessageFrequencyLimit");
+        mPositionLimit = tree.get<long>("Limits.PositionLimit");
+
+        for (const auto& trader : tree.get_child("Traders"))
+        {
+            mTraders[trader.first] = trader.second.get_value<std::string>();
+        }
+    }
+
+    std::string mMarketDataFile;
+    double mMarketEventInterval = 0.0;
+    double mMarketOpenDelay = 0.0;
+    double mSpeed = 1.0;
+    double mTickInterval = 0.0;
+
+    std::string mExecHost;
+    unsigned short mExecPort = 0;
+    std::size_t mExecReceiveBufferSize = 0;
+    std::size_t mExecSendBufferSize = 0;
+
+    double mMakerFee = 0.0;
+    double mTakerFee = 0.0;
+
+    std::string mInfoType;
+    std::string mInfoName;
+
+    double mEtfClamp = 0.0;
+    double mTickSize = 0.0;
+
+    std::size_t mActiveOrderCountLimit = 0;
+    unsigned long mActiveVolumeLimit = 0;
+    double mMessageFrequencyInterval = 0.0;
+    unsigned long mMessageFrequencyLimit = 0;
+    long mPositionLimit = 0;
+
+    std::map<std::string, std::string> mTraders;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_EXCHANGE_EXCHANGECONFIG_H
@@ -0,0 +1,64 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_EXCHANGE_FREQUENCYLIMITER_H
+#define CPPREADY_TRADER_GO_LIBS_EXCHANGE_FREQUENCYLIMITER_H
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+
+namespace ReadyTraderGo {
+
+// Limit the frequency of events in a sliding time interval.
+class FrequencyLimiter
+{
+public:
+    FrequencyLimiter(double interval, unsigned long limit) : mInterval(interval), mLimit(limit) {}
+
+    // Return true if the new event breaches the limit. Must be called with
+    // a monotonically increasing sequence of times.
+    bool CheckEvent(double now);
+
+    unsigned long GetLimit() const { return mLimit; }
+    unsigned long GetValue() const { return mEvents.size(); }
+
+private:
+    double mInterval;
+    unsigned long mLimit;
+    std::deque<double> mEvents;
+};
+
+inline bool FrequencyLimiter::CheckEvent(double now)
+{
+    mEvents.push_back(now);
+
+    // Events that are (within rounding) exactly one interval old have left
+    // the window.
+    const double epsilon = std::numeric_limits<double>::epsilon();
+    const double windowStart = now - mInterval;
+    while (!mEvents.empty() && (mEvents.front() - windowStart) <= std::max(mEvents.front(), windowStart) * epsilon)
+    {
+        mEvents.pop_front();
+    }
+
+    return mEvents.size() > mLimit;
+}
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_EXCHANGE_FREQUENCYLIMITER_H
@@ -0,0 +1,83 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_EXCHANGE_UNHEDGEDLOTS_H
+#define CPPREADY_TRADER_GO_LIBS_EXCHANGE_UNHEDGEDLOTS_H
+
+#include <limits>
+
+namespace ReadyTraderGo {
+
+constexpr long MAXIMUM_UNHEDGED_LOTS = 10;
+constexpr double UNHEDGED_LOTS_TIME_LIMIT = 60.0;
+
+// Keep track of a competitor's relative position (its ETF position plus its
+// future position) and of when it has held more than the permitted number of
+// unhedged lots for longer than the time limit.
+class UnhedgedLots
+{
+public:
+    UnhedgedLots() = default;
+
+    void ApplyPositionDelta(double now, long delta);
+
+    // Return true, once, if unhedged lots have been held since at least the
+    // time limit before now.
+    bool CheckExpiry(double now);
+
+    long GetRelativePosition() const { return mRelativePosition; }
+
+private:
+    long mRelativePosition = 0;
+    double mDeadline = std::numeric_limits<double>::infinity();
+};
+
+inline void UnhedgedLots::ApplyPositionDelta(double now, long delta)
+{
+    const long newRelativePosition = mRelativePosition + delta;
+
+    if (delta > 0)
+    {
+        if (mRelativePosition < -MAXIMUM_UNHEDGED_LOTS && -MAXIMUM_UNHEDGED_LOTS <= newRelativePosition)
+            mDeadline = std::numeric_limits<double>::infinity();
+        if (newRelativePosition > MAXIMUM_UNHEDGED_LOTS && MAXIMUM_UNHEDGED_LOTS >= mRelativePosition)
+            mDeadline = now + UNHEDGED_LOTS_TIME_LIMIT;
+    }
+    else if (delta < 0)
+    {
+        if (mRelativePosition > MAXIMUM_UNHEDGED_LOTS && MAXIMUM_UNHEDGED_LOTS >= newRelativePosition)
+            mDeadline = std::numeric_limits<double>::infinity();
+        if (newRelativePosition < -MAXIMUM_UNHEDGED_LOTS && -MAXIMUM_UNHEDGED_LOTS <= mRelativePosition)
+            mDeadline = now + UNHEDGED_LOTS_TIME_LIMIT;
+    }
+
+    mRelativePosition = newRelativePosition;
+}
+
+inline bool UnhedgedLots::CheckExpiry(double now)
+{
+    if (now < mDeadline)
+    {
+        return false;
+    }
+    mDeadline = std::numeric_limits<double>::infinity();
+    return true;
+}
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_EXCHANGE_UNHEDGEDLOTS_H
@@ -0,0 +1,242 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#include <boost/interprocess/file_mapping.hpp>
+
+#include <ready_trader_go/error.h>
+
+#include "marketdatafile.h"
+
+namespace ReadyTraderGo {
+
+namespace {
+
+enum Column : std::size_t
+{
+    TIME, INSTRUMENT, OPERATION, ORDER_ID, SIDE, VOLUME, PRICE, LIFESPAN, INDEX, COLUMN_COUNT
+};
+
+constexpr char MARKET_DATA_FILE_MAGIC[8] = {'R', 'T', 'G', 'M', 'K', 'T', 'D', '\0'};
+constexpr std::uint32_t MARKET_DATA_FILE_VERSION = 1;
+constexpr std::uint32_t MARKET_DATA_FILE_BYTE_ORDER = 0x01020304;
+constexpr std::size_t MARKET_DATA_FILE_ALIGNMENT = 64;
+
+// Element sizes, in column order.
+constexpr std::size_t COLUMN_WIDTHS[COLUMN_COUNT] = {sizeof(double), 1, 1, sizeof(std::uint64_t), 1,
+                                                     sizeof(std::int32_t), sizeof(std::uint32_t), 1,
+                                                     sizeof(std::uint64_t)};
+
+struct MarketDataFileHeader
+{
+    char mMagic[8];
+    std::uint32_t mVersion;
+    std::uint32_t mByteOrder;
+    std::uint64_t mEventCount;
+    std::uint64_t mIndexCount;
+    double mIndexInterval;
+    std::uint64_t mColumnOffsets[COLUMN_COUNT];
+};
+
+std::size_t alignOffset(std::size_t offset)
+{
+    return (offset + MARKET_DATA_FILE_ALIGNMENT - 1) & ~(MARKET_DATA_FILE_ALIGNMENT - 1);
+}
+
+// Lay out the columns after the header, returning the total file size.
+std::size_t layOut(MarketDataFileHeader& header)
+{
+    std::size_t offset = sizeof(MarketDataFileHeader);
+    for (std::size_t c = 0; c != COLUMN_COUNT; ++c)
+    {
+        offset = alignOffset(offset);
+        header.mColumnOffsets[c] = offset;
+        offset += COLUMN_WIDTHS[c] * ((c == INDEX) ? header.mIndexCount : header.mEventCount);
+    }
+    return offset;
+}
+
+template<typename T>
+void putColumn(std::vector<char>& data, const MarketDataFileHeader& header, Column column, std::size_t i, T value)
+{
+    std::memcpy(data.data() + header.mColumnOffsets[column] + i * sizeof(T), &value, sizeof(T));
+}
+
+}
+
+MarketDataFile::MarketDataFile(const std::string& filename)
+{
+    try
+    {
+        boost::interprocess::file_mapping mapping{filename.c_str(), boost::interprocess::read_only};
+        mRegion = boost::interprocess::mapped_region{mapping, boost::interprocess::read_only};
+    }
+    catch (const boost::interprocess::interprocess_exception& e)
+    {
+        throw ReadyTraderGoError("failed to map market data file '" + filename + "': " + e.what());
+    }
+
+    const auto* base = static_cast<const char*>(mRegion.get_address());
+    const std::size_t size = mRegion.get_size();
+
+    MarketDataFileHeader header;
+    if (size < sizeof(header))
+    {
+        throw ReadyTraderGoError("market data file '" + filename + "' is too short");
+    }
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.mMagic, MARKET_DATA_FILE_MAGIC, sizeof(header.mMagic)) != 0)
+    {
+        throw ReadyTraderGoError("'" + filename + "' is not a binary market data file");
+    }
+    if (header.mVersion != MARKET_DATA_FILE_VERSION || header.mByteOrder != MARKET_DATA_FILE_BYTE_ORDER)
+    {
+        throw ReadyTraderGoError("market data file '" + filename + "' has an unsupported version or byte order");
+    }
+
+    MarketDataFileHeader laidOut = header;
+    if (header.mIndexCount == 0 || !(header.mIndexInterval > 0.0) || layOut(laidOut) > size
+        || std::memcmp(laidOut.mColumnOffsets, header.mColumnOffsets, sizeof(header.mColumnOffsets)) != 0)
+    {
+        throw ReadyTraderGoError("market data file '" + filename + "' is corrupt");
+    }
+
+    mEventCount = header.mEventCount;
+    mIndexCount = header.mIndexCount;
+    mIndexInterval = header.mIndexInterval;
+
+    const auto* offsets = header.mColumnOffsets;
+    mTimes = reinterpret_cast<const double*>(base + offsets[TIME]);
+    mInstruments = reinterpret_cast<const Instrument*>(base + offsets[INSTRUMENT]);
+    mOperations = reinterpret_cast<const MarketEventOperation*>(base + offsets[OPERATION]);
+    mOrderIds = reinterpret_cast<const std::uint64_t*>(base + offsets[ORDER_ID]);
+    mSides = reinterpret_cast<const Side*>(base + offsets[SIDE]);
+    mVolumes = reinterpret_cast<const std::int32_t*>(base + offsets[VOLUME]);
+    mPrices = reinterpret_cast<const std::uint32_t*>(base + offsets[PRICE]);
+    mLifespans = reinterpret_cast<const Lifespan*>(base + offsets[LIFESPAN]);
+    mIndex = reinterpret_cast<const std::uint64_t*>(base + offsets[INDEX]);
+}
+
+bool MarketDataFile::IsMarketDataFile(const std::string& filename)
+{
+    char magic[sizeof(MARKET_DATA_FILE_MAGIC)] = {};
+    std::ifstream file{filename, std::ios::binary};
+    file.read(magic, sizeof(magic));
+    return file && std::memcmp(magic, MARKET_DATA_FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+void MarketDataFile::Write(const std::string& filename, const std::vector<MarketEvent>& events, double indexInterval)
+{
+    if (!(indexInterval > 0.0))
+    {
+        throw ReadyTraderGoError("market data index interval must be positive");
+    }
+
+    double previousTime = 0.0;
+    for (std::size_t i = 0; i != events.size(); ++i)
+    {
+        const MarketEvent& event = events[i];
+        if (!std::isfinite(event.mTime) || event.mTime < previousTime)
+        {
+            throw ReadyTraderGoError("market event " + std::to_string(i) + " is out of time order");
+        }
+        if (event.mVolume < std::numeric_limits<std::int32_t>::min()
+            || event.mVolume > std::numeric_limits<std::int32_t>::max()
+            || event.mPrice > std::numeric_limits<std::uint32_t>::max())
+        {
+            throw ReadyTraderGoError("market event " + std::to_string(i) + " has an out of range volume or price");
+        }
+        previousTime = event.mTime;
+    }
+
+    MarketDataFileHeader header{};
+    std::memcpy(header.mMagic, MARKET_DATA_FILE_MAGIC, sizeof(header.mMagic));
+    header.mVersion = MARKET_DATA_FILE_VERSION;
+    header.mByteOrder = MARKET_DATA_FILE_BYTE_ORDER;
+    header.mEventCount = events.size();
+    header.mIndexCount = (events.empty() ? 0 : static_cast<std::size_t>(previousTime / indexInterval) + 1) + 1;
+    header.mIndexInterval = indexInterval;
+
+    std::vector<char> data(layOut(header), 0);
+    std::memcpy(data.data(), &header, sizeof(header));
+
+    std::size_t bucket = 0;
+    for (std::size_t i = 0; i != events.size(); ++i)
+    {
+        const MarketEvent& event = events[i];
+        putColumn(data, header, TIME, i, event.mTime);
+        putColumn(data, header, INSTRUMENT, i, event.mInstrument);
+        putColumn(data, header, OPERATION, i, event.mOperation);
+        putColumn(data, header, ORDER_ID, i, static_cast<std::uint64_t>(event.mOrderId));
+        putColumn(data, header, SIDE, i, event.mSide);
+        putColumn(data, header, VOLUME, i, static_cast<std::int32_t>(event.mVolume));
+        putColumn(data, header, PRICE, i, static_cast<std::uint32_t>(event.mPrice));
+        putColumn(data, header, LIFESPAN, i, event.mLifespan);
+
+        const auto eventBucket = static_cast<std::size_t>(event.mTime / indexInterval);
+        for (; bucket <= eventBucket; ++bucket)
+        {
+            putColumn(data, header, INDEX, bucket, static_cast<std::uint64_t>(i));
+        }
+    }
+    for (; bucket != header.mIndexCount; ++bucket)
+    {
+        putColumn(data, header, INDEX, bucket, static_cast<std::uint64_t>(events.size()));
+    }
+
+    std::ofstream file{filename, std::ios::binary | std::ios::trunc};
+    file.write(data.data(), data.size());
+    file.close();
+    if (!file)
+    {
+        throw ReadyTraderGoError("failed to write market data file '" + filename + "'");
+    }
+}
+
+std::size_t MarketDataFile::FindTime(double time) const
+{
+    if (!(time > 0.0))
+    {
+        return 0;
+    }
+
+    // Events in bucket i have times in [i * interval, (i + 1) * interval),
+    // so only that bucket needs to be searched.
+    const double bucket = time / mIndexInterval;
+    const std::size_t last = mIndexCount - 1;
+    const std::size_t i = (bucket < static_cast<double>(last)) ? static_cast<std::size_t>(bucket) : last;
+    const std::size_t end = (i == last) ? mEventCount : mIndex[i + 1];
+    return std::lower_bound(mTimes + mIndex[i], mTimes + end, time) - mTimes;
+}
+
+std::vector<MarketEvent> MarketDataFile::GetEvents() const
+{
+    std::vector<MarketEvent> events;
+    events.reserve(mEventCount);
+    for (std::size_t i = 0; i != mEventCount; ++i)
+    {
+        events.push_back(GetEvent(i));
+    }
+    return events;
+}
+
+}
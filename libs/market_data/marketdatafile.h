@@ -0,0 +1,121 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_MARKET_DATA_MARKETDATAFILE_H
+#define CPPREADY_TRADER_GO_LIBS_MARKET_DATA_MARKETDATAFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <ready_trader_go/types.h>
+
+#include "marketevents.h"
+
+namespace ReadyTraderGo {
+
+// A binary market data file holds the same events as a CSV market data file,
+// stored column by column in native byte order so they can be used straight
+// from the page cache without any parsing. Files can only be read on a
+// machine with the same byte order as the one that wrote them.
+//
+// After the header each column is an array with one element per event,
+// starting on a 64 byte boundary: time (double), instrument, operation,
+// order id (uint64), side, volume (int32, the change in volume for amends),
+// price in cents (uint32) and lifespan. The enumerations are one byte each.
+// The last array is the time index: element i holds the position of the
+// first event at or after i times the index interval, followed by a final
+// element holding the number of events.
+//
+// Times must be non-negative and in order.
+class MarketDataFile
+{
+public:
+    // Map a binary market data file, throwing ReadyTraderGoError if it
+    // cannot be opened or is not a valid binary market data file.
+    explicit MarketDataFile(const std::string& filename);
+
+    // MarketDataFile instances can't be copied
+    MarketDataFile(const MarketDataFile&) = delete;
+    MarketDataFile& operator=(const MarketDataFile&) = delete;
+
+    // Return true if the named file starts like a binary market data file.
+    static bool IsMarketDataFile(const std::string& filename);
+
+    // Write events to a binary market data file, throwing ReadyTraderGoError
+    // if they cannot be represented or the file cannot be written.
+    static void Write(const std::string& filename,
+                      const std::vector<MarketEvent>& events,
+                      double indexInterval = 1.0);
+
+    std::size_t GetEventCount() const { return mEventCount; }
+    double GetIndexInterval() const { return mIndexInterval; }
+
+    // Columns, each GetEventCount() elements long.
+    const double* GetTimes() const { return mTimes; }
+    const Instrument* GetInstruments() const { return mInstruments; }
+    const MarketEventOperation* GetOperations() const { return mOperations; }
+    const std::uint64_t* GetOrderIds() const { return mOrderIds; }
+    const Side* GetSides() const { return mSides; }
+    const std::int32_t* GetVolumes() const { return mVolumes; }
+    const std::uint32_t* GetPrices() const { return mPrices; }
+    const Lifespan* GetLifespans() const { return mLifespans; }
+
+    // Return the position of the first event at or after the given time (or
+    // the number of events if there is none).
+    std::size_t FindTime(double time) const;
+
+    MarketEvent GetEvent(std::size_t i) const;
+    std::vector<MarketEvent> GetEvents() const;
+
+private:
+    boost::interprocess::mapped_region mRegion;
+    std::size_t mEventCount = 0;
+    std::size_t mIndexCount = 0;
+    double mIndexInterval = 1.0;
+
+    const double* mTimes = nullptr;
+    const Instrument* mInstruments = nullptr;
+    const MarketEventOperation* mOperations = nullptr;
+    const std::uint64_t* mOrderIds = nullptr;
+    const Side* mSides = nullptr;
+    const std::int32_t* mVolumes = nullptr;
+    const std::uint32_t* mPrices = nullptr;
+    const Lifespan* mLifespans = nullptr;
+    const std::uint64_t* mIndex = nullptr;
+};
+
+inline MarketEvent MarketDataFile::GetEvent(std::size_t i) const
+{
+    MarketEvent event;
+    event.mTime = mTimes[i];
+    event.mInstrument = mInstruments[i];
+    event.mOperation = mOperations[i];
+    event.mOrderId = mOrderIds[i];
+    event.mSide = mSides[i];
+    event.mVolume = mVolumes[i];
+    event.mPrice = mPrices[i];
+    event.mLifespan = mLifespans[i];
+    return event;
+}
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_MARKET_DATA_MARKETDATAFILE_H
@@ -0,0 +1,136 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include <ready_trader_go/error.h>
+
+#include "marketdatafile.h"
+#include "marketevents.h"
+
+namespace ReadyTraderGo {
+
+// Prices in the market data file are in dollars.
+constexpr double INPUT_SCALING = 100.0;
+
+static MarketEventOperation parseOperation(const std::string& name)
+{
+    if (name == "Amend" || name == "AMEND")
+        return MarketEventOperation::AMEND;
+    if (name == "Cancel" || name == "CANCEL")
+        return MarketEventOperation::CANCEL;
+    if (name == "Insert" || name == "INSERT")
+        return MarketEventOperation::INSERT;
+    throw std::invalid_argument("unknown operation '" + name + "'");
+}
+
+static Side parseSide(const std::string& name)
+{
+    if (name == "BUY" || name == "BID" || name == "B")
+        return Side::BUY;
+    if (name == "SELL" || name == "ASK" || name == "A")
+        return Side::SELL;
+    throw std::invalid_argument("unknown side '" + name + "'");
+}
+
+static Lifespan parseLifespan(const std::string& name)
+{
+    if (name == "FILL_AND_KILL" || name == "IMMEDIATE_OR_CANCEL" || name == "FAK" || name == "F")
+        return Lifespan::FILL_AND_KILL;
+    if (name == "GOOD_FOR_DAY" || name == "LIMIT_ORDER" || name == "GFD" || name == "G")
+        return Lifespan::GOOD_FOR_DAY;
+    throw std::invalid_argument("unknown lifespan '" + name + "'");
+}
+
+// Columns are: time, instrument, operation, order_id, side, volume, price
+// and lifespan. Side, volume, price and lifespan are empty for cancels.
+MarketEvent parseMarketEvent(const std::string& line)
+{
+    std::vector<std::string> fields;
+    std::istringstream stream{line};
+    std::string field;
+    while (std::getline(stream, field, ','))
+    {
+        if (!field.empty() && field.back() == '\r')
+        {
+            field.pop_back();
+        }
+        fields.push_back(std::move(field));
+    }
+    fields.resize(8);
+
+    MarketEvent event;
+    event.mTime = std::stod(fields[0]);
+    const int instrument = std::stoi(fields[1]);
+    if (instrument != 0 && instrument != 1)
+        throw std::invalid_argument("unknown instrument '" + fields[1] + "'");
+    event.mInstrument = static_cast<Instrument>(instrument);
+    event.mOperation = parseOperation(fields[2]);
+    event.mOrderId = std::stoul(fields[3]);
+    if (!fields[4].empty())
+        event.mSide = parseSide(fields[4]);
+    if (!fields[5].empty())
+        event.mVolume = static_cast<long>(std::stod(fields[5]));
+    if (!fields[6].empty())
+        event.mPrice = static_cast<unsigned long>(std::stod(fields[6]) * INPUT_SCALING);
+    if (!fields[7].empty())
+        event.mLifespan = parseLifespan(fields[7]);
+    return event;
+}
+
+std::vector<MarketEvent> readMarketEvents(const std::string& filename)
+{
+    if (MarketDataFile::IsMarketDataFile(filename))
+    {
+        return MarketDataFile{filename}.GetEvents();
+    }
+
+    std::ifstream file{filename};
+    if (!file)
+    {
+        throw ReadyTraderGoError("failed to open market data file '" + filename + "'");
+    }
+
+    std::vector<MarketEvent> events;
+    std::string line;
+    std::getline(file, line); // Skip header row
+    unsigned long lineNumber = 1;
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+        if (line.empty() || line == "\r")
+        {
+            continue;
+        }
+        try
+        {
+            events.push_back(parseMarketEvent(line));
+        }
+        catch (const std::exception& e)
+        {
+            throw ReadyTraderGoError("bad market event on line " + std::to_string(lineNumber) + " of '"
+                                     + filename + "': " + e.what());
+        }
+    }
+
+    return events;
+}
+
+}
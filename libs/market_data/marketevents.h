@@ -0,0 +1,54 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_MARKET_DATA_MARKETEVENTS_H
+#define CPPREADY_TRADER_GO_LIBS_MARKET_DATA_MARKETEVENTS_H
+
+#include <string>
+#include <vector>
+
+#include <ready_trader_go/types.h>
+
+namespace ReadyTraderGo {
+
+enum class MarketEventOperation : unsigned char { AMEND, CANCEL, INSERT };
+
+// One row of a market data file. Prices are in cents.
+struct MarketEvent
+{
+    double mTime = 0.0;
+    Instrument mInstrument = Instrument::FUTURE;
+    MarketEventOperation mOperation = MarketEventOperation::CANCEL;
+    unsigned long mOrderId = 0;
+    Side mSide = Side::BUY;
+    long mVolume = 0;
+    unsigned long mPrice = 0;
+    Lifespan mLifespan = Lifespan::FILL_AND_KILL;
+};
+
+// Parse one line of a market data file (the same CSV format as read by the
+// Python exchange). Throws std::invalid_argument if the line is malformed.
+MarketEvent parseMarketEvent(const std::string& line);
+
+// Read every event in a market data file, either CSV or binary (see
+// MarketDataFile), throwing ReadyTraderGoError if the file cannot be read or
+// has a malformed line.
+std::vector<MarketEvent> readMarketEvents(const std::string& filename);
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_MARKET_DATA_MARKETEVENTS_H
@@ -0,0 +1,151 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_MATCHING_ENGINE_LEVELBITMAP_H
+#define CPPREADY_TRADER_GO_LIBS_MATCHING_ENGINE_LEVELBITMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ReadyTraderGo {
+
+// One bit per price level, set when the level holds orders. A summary word
+// per 64 words lets the nearest occupied level be found without walking the
+// empty levels in between.
+class LevelBitmap
+{
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    // Clear the bitmap and make room for the given number of levels (which
+    // must be a multiple of 64).
+    void Reset(std::size_t size);
+
+    std::size_t GetSize() const { return mWords.size() * 64; }
+
+    void Clear(std::size_t index);
+    void Set(std::size_t index);
+    bool Test(std::size_t index) const { return (mWords[index >> 6] >> (index & 63)) & 1; }
+
+    // The lowest set bit at or above index, or npos if there isn't one.
+    std::size_t FindNext(std::size_t index) const;
+    // The highest set bit at or below index, or npos if there isn't one.
+    std::size_t FindPrevious(std::size_t index) const;
+
+private:
+    static unsigned lowestBit(std::uint64_t word) { return __builtin_ctzll(word); }
+    static unsigned highestBit(std::uint64_t word) { return 63 - __builtin_clzll(word); }
+
+    std::vector<std::uint64_t> mWords;
+    std::vector<std::uint64_t> mSummary;
+};
+
+inline void LevelBitmap::Reset(std::size_t size)
+{
+    mWords.assign(size / 64, 0);
+    mSummary.assign((mWords.size() + 63) / 64, 0);
+}
+
+inline void LevelBitmap::Clear(std::size_t index)
+{
+    const std::size_t word = index >> 6;
+    mWords[word] &= ~(std::uint64_t(1) << (index & 63));
+    if (mWords[word] == 0)
+    {
+        mSummary[word >> 6] &= ~(std::uint64_t(1) << (word & 63));
+    }
+}
+
+inline void LevelBitmap::Set(std::size_t index)
+{
+    const std::size_t word = index >> 6;
+    mWords[word] |= std::uint64_t(1) << (index & 63);
+    mSummary[word >> 6] |= std::uint64_t(1) << (word & 63);
+}
+
+inline std::size_t LevelBitmap::FindNext(std::size_t index) const
+{
+    if (index >= GetSize())
+    {
+        return npos;
+    }
+
+    std::size_t word = index >> 6;
+    std::uint64_t bits = mWords[word] & (~std::uint64_t(0) << (index & 63));
+    if (bits)
+    {
+        return (word << 6) + lowestBit(bits);
+    }
+
+    if (++word == mWords.size())
+    {
+        return npos;
+    }
+    std::size_t summary = word >> 6;
+    bits = mSummary[summary] & (~std::uint64_t(0) << (word & 63));
+    while (!bits)
+    {
+        if (++summary == mSummary.size())
+        {
+            return npos;
+        }
+        bits = mSummary[summary];
+    }
+    word = (summary << 6) + lowestBit(bits);
+    return (word << 6) + lowestBit(mWords[word]);
+}
+
+inline std::size_t LevelBitmap::FindPrevious(std::size_t index) const
+{
+    if (index == npos || mWords.empty())
+    {
+        return npos;
+    }
+    if (index >= GetSize())
+    {
+        index = GetSize() - 1;
+    }
+
+    std::size_t word = index >> 6;
+    std::uint64_t bits = mWords[word] & (~std::uint64_t(0) >> (63 - (index & 63)));
+    if (bits)
+    {
+        return (word << 6) + highestBit(bits);
+    }
+
+    if (word-- == 0)
+    {
+        return npos;
+    }
+    std::size_t summary = word >> 6;
+    bits = mSummary[summary] & (~std::uint64_t(0) >> (63 - (word & 63)));
+    while (!bits)
+    {
+        if (summary-- == 0)
+        {
+            return npos;
+        }
+        bits = mSummary[summary];
+    }
+    word = (summary << 6) + highestBit(bits);
+    return (word << 6) + highestBit(mWords[word]);
+}
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_MATCHING_ENGINE_LEVELBITMAP_H
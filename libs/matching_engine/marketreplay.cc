@@ -0,0 +1,85 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cstddef>
+
+#include "marketreplay.h"
+
+namespace ReadyTraderGo {
+
+MarketReplay::MarketReplay(OrderBook& futureBook, OrderBook& etfBook) : mBooks{&futureBook, &etfBook}
+{
+}
+
+OrderBook& MarketReplay::Apply(const MarketEvent& event)
+{
+    const auto instrument = static_cast<std::size_t>(event.mInstrument);
+    OrderBook& book = *mBooks[instrument];
+
+    if (event.mOperation == MarketEventOperation::INSERT)
+    {
+        // Orders are added to the map when they are placed in the book.
+        book.Insert(event.mTime, event.mOrderId, event.mLifespan, event.mSide, event.mPrice,
+                    static_cast<unsigned long>(event.mVolume), this);
+        return book;
+    }
+
+    auto& orders = mOrders[instrument];
+    auto it = orders.find(event.mOrderId);
+    if (it == orders.end())
+    {
+        return book;
+    }
+    if (event.mOperation == MarketEventOperation::CANCEL)
+    {
+        book.Cancel(event.mTime, *it->second);
+    }
+    else if (event.mVolume < 0)
+    {
+        const long newVolume = static_cast<long>(it->second->mVolume) + event.mVolume;
+        book.Amend(event.mTime, *it->second, (newVolume > 0) ? static_cast<unsigned long>(newVolume) : 0);
+    }
+    return book;
+}
+
+void MarketReplay::OrderAmended(double now, Order& order, unsigned long volumeRemoved)
+{
+    if (order.mRemainingVolume == 0)
+    {
+        mOrders[static_cast<std::size_t>(order.mInstrument)].erase(order.mClientOrderId);
+    }
+}
+
+void MarketReplay::OrderCancelled(double now, Order& order, unsigned long volumeRemoved)
+{
+    mOrders[static_cast<std::size_t>(order.mInstrument)].erase(order.mClientOrderId);
+}
+
+void MarketReplay::OrderFilled(double now, Order& order, unsigned long price, unsigned long volume, long fee)
+{
+    if (order.mRemainingVolume == 0)
+    {
+        mOrders[static_cast<std::size_t>(order.mInstrument)].erase(order.mClientOrderId);
+    }
+}
+
+void MarketReplay::OrderPlaced(double now, Order& order)
+{
+    mOrders[static_cast<std::size_t>(order.mInstrument)][order.mClientOrderId] = &order;
+}
+
+}
@@ -0,0 +1,56 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_MATCHING_ENGINE_MARKETREPLAY_H
+#define CPPREADY_TRADER_GO_LIBS_MATCHING_ENGINE_MARKETREPLAY_H
+
+#include <array>
+#include <unordered_map>
+
+#include <market_data/marketevents.h>
+
+#include "orderbook.h"
+
+namespace ReadyTraderGo {
+
+// Applies market events to the order books the way the Python exchange's
+// MarketEventsReader does, keeping track of which of the market's orders
+// are resting in the books. Inserts with the id of a resting order, and
+// amends and cancels of orders that are not resting, behave as they do in
+// Python.
+class MarketReplay : public IOrderListener
+{
+public:
+    MarketReplay(OrderBook& futureBook, OrderBook& etfBook);
+
+    // Apply a market event and return the order book it applied to.
+    OrderBook& Apply(const MarketEvent& event);
+
+    // IOrderListener callbacks
+    void OrderAmended(double now, Order& order, unsigned long volumeRemoved) override;
+    void OrderCancelled(double now, Order& order, unsigned long volumeRemoved) override;
+    void OrderFilled(double now, Order& order, unsigned long price, unsigned long volume, long fee) override;
+    void OrderPlaced(double now, Order& order) override;
+
+private:
+    std::array<OrderBook*, 2> mBooks;
+    std::array<std::unordered_map<unsigned long, Order*>, 2> mOrders;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_MATCHING_ENGINE_MARKETREPLAY_H
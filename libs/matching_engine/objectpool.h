@@ -0,0 +1,104 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_MATCHING_ENGINE_OBJECTPOOL_H
+#define CPPREADY_TRADER_GO_LIBS_MATCHING_ENGINE_OBJECTPOOL_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace ReadyTraderGo {
+
+// Hands out objects from blocks allocated a chunk at a time and keeps
+// released objects on a free list, so that steady state creation and
+// destruction of objects never touches the heap.
+template<typename T>
+class ObjectPool
+{
+public:
+    explicit ObjectPool(std::size_t chunkSize = 1024) : mChunkSize(chunkSize) {}
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    // Construct an object from the pool.
+    template<typename... Args>
+    T* Allocate(Args&&... args);
+
+    // Destroy an object and return it to the pool.
+    void Release(T* object);
+
+    // The number of objects currently allocated from the pool.
+    std::size_t GetCount() const { return mCount; }
+
+private:
+    union Node
+    {
+        Node* mNextFree;
+        alignas(T) unsigned char mStorage[sizeof(T)];
+    };
+
+    void Grow();
+
+    std::size_t mChunkSize;
+    std::size_t mCount = 0;
+    Node* mFree = nullptr;
+    std::vector<std::unique_ptr<Node[]>> mChunks;
+};
+
+template<typename T>
+template<typename... Args>
+T* ObjectPool<T>::Allocate(Args&&... args)
+{
+    if (!mFree)
+    {
+        Grow();
+    }
+    Node* node = mFree;
+    mFree = node->mNextFree;
+    ++mCount;
+    return new(node->mStorage) T(std::forward<Args>(args)...);
+}
+
+template<typename T>
+void ObjectPool<T>::Release(T* object)
+{
+    object->~T();
+    Node* node = reinterpret_cast<Node*>(object);
+    node->mNextFree = mFree;
+    mFree = node;
+    --mCount;
+}
+
+template<typename T>
+void ObjectPool<T>::Grow()
+{
+    mChunks.emplace_back(new Node[mChunkSize]);
+    Node* chunk = mChunks.back().get();
+    for (std::size_t i = mChunkSize; i-- > 0;)
+    {
+        chunk[i].mNextFree = mFree;
+        mFree = &chunk[i];
+    }
+}
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_MATCHING_ENGINE_OBJECTPOOL_H
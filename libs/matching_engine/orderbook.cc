@@ -0,0 +1,552 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <functional>
+
+#include "orderbook.h"
+
+namespace ReadyTraderGo {
+
+// Fees are rounded half to even, as Python's round() does.
+static inline long calculateFee(unsigned long price, unsigned long volume, double rate)
+{
+    return static_cast<long>(std::nearbyint(static_cast<double>(price * volume) * rate));
+}
+
+static inline void addTick(std::vector<std::pair<unsigned long, unsigned long>>& ticks,
+                           unsigned long price,
+                           unsigned long volume)
+{
+    for (auto& tick : ticks)
+    {
+        if (tick.first == price)
+        {
+            tick.second += volume;
+            return;
+        }
+    }
+    ticks.emplace_back(price, volume);
+}
+
+template<typename Compare>
+static void copyTicks(std::vector<std::pair<unsigned long, unsigned long>>& ticks,
+                      std::array<unsigned long, TOP_LEVEL_COUNT>& prices,
+                      std::array<unsigned long, TOP_LEVEL_COUNT>& volumes,
+                      Compare compare)
+{
+    std::sort(ticks.begin(), ticks.end(), [compare](const auto& a, const auto& b) {
+        return compare(a.first, b.first);
+    });
+    std::size_t i = 0;
+    for (; i < TOP_LEVEL_COUNT && i < ticks.size(); ++i)
+    {
+        prices[i] = ticks[i].first;
+        volumes[i] = ticks[i].second;
+    }
+    for (; i < TOP_LEVEL_COUNT; ++i)
+    {
+        prices[i] = volumes[i] = 0;
+    }
+    ticks.clear();
+}
+
+OrderBook::OrderBook(Instrument instrument, double makerFee, double takerFee, unsigned long tickSize)
+    : mInstrument(instrument), mMakerFee(makerFee), mTakerFee(takerFee), mTickSize(tickSize)
+{
+}
+
+void OrderBook::Amend(double now, Order& order, unsigned long newVolume)
+{
+    if (order.mRemainingVolume == 0)
+    {
+        return;
+    }
+
+    const unsigned long fillVolume = order.mVolume - order.mRemainingVolume;
+    const unsigned long volume = std::max(fillVolume, std::min(newVolume, order.mVolume));
+    const unsigned long diff = order.mVolume - volume;
+    RemoveFromLevel(order, diff, diff == order.mRemainingVolume);
+    order.mVolume -= diff;
+    order.mRemainingVolume -= diff;
+    if (order.mListener)
+    {
+        order.mListener->OrderAmended(now, order, diff);
+    }
+    if (order.mRemainingVolume == 0)
+    {
+        mOrders.Release(&order);
+    }
+}
+
+void OrderBook::Cancel(double now, Order& order)
+{
+    if (order.mRemainingVolume == 0)
+    {
+        return;
+    }
+
+    const unsigned long remaining = order.mRemainingVolume;
+    RemoveFromLevel(order, remaining, true);
+    order.mRemainingVolume = 0;
+    if (order.mListener)
+    {
+        order.mListener->OrderCancelled(now, order, remaining);
+    }
+    mOrders.Release(&order);
+}
+
+Order* OrderBook::Insert(double now,
+                         unsigned long clientOrderId,
+                         Lifespan lifespan,
+                         Side side,
+                         unsigned long price,
+                         unsigned long volume,
+                         IOrderListener* listener)
+{
+    Order* order = mOrders.Allocate(clientOrderId, mInstrument, lifespan, side, price, volume, listener);
+
+    Trade(now, *order);
+
+    if (order->mRemainingVolume > 0)
+    {
+        if (lifespan == Lifespan::GOOD_FOR_DAY)
+        {
+            Place(now, *order);
+            return order;
+        }
+
+        const unsigned long remaining = order->mRemainingVolume;
+        order->mRemainingVolume = 0;
+        if (listener)
+        {
+            listener->OrderCancelled(now, *order, remaining);
+        }
+    }
+
+    mOrders.Release(order);
+    return nullptr;
+}
+
+double OrderBook::GetMidpointPrice() const
+{
+    unsigned long askPrice;
+    unsigned long bidPrice;
+    if (!FindAsk(0, askPrice) || !FindBid(ULONG_MAX, bidPrice))
+    {
+        return 0.0;
+    }
+    return static_cast<double>(bidPrice + askPrice) / 2.0;
+}
+
+const OrderBook::Level* OrderBook::FindAsk(unsigned long lowest, unsigned long& price) const
+{
+    std::size_t index = mBestAsk;
+    if (index != npos && GetLevelPrice(index) < lowest)
+    {
+        const unsigned long tick = lowest / mTickSize + (lowest % mTickSize != 0);
+        index = (tick - mFirstTick < mLevels.size()) ? mAskLevels.FindNext(tick - mFirstTick) : npos;
+    }
+
+    if (!mOtherAsks.empty())
+    {
+        auto it = mOtherAsks.lower_bound(lowest);
+        if (it != mOtherAsks.end() && (index == npos || it->first < GetLevelPrice(index)))
+        {
+            price = it->first;
+            return &it->second;
+        }
+    }
+
+    if (index == npos)
+    {
+        return nullptr;
+    }
+    price = GetLevelPrice(index);
+    return &mLevels[index];
+}
+
+const OrderBook::Level* OrderBook::FindBid(unsigned long highest, unsigned long& price) const
+{
+    std::size_t index = mBestBid;
+    if (index != npos && GetLevelPrice(index) > highest)
+    {
+        const unsigned long tick = highest / mTickSize;
+        index = (tick >= mFirstTick) ? mBidLevels.FindPrevious(tick - mFirstTick) : npos;
+    }
+
+    if (!mOtherBids.empty())
+    {
+        auto it = mOtherBids.lower_bound(highest);
+        if (it != mOtherBids.end() && (index == npos || it->first > GetLevelPrice(index)))
+        {
+            price = it->first;
+            return &it->second;
+        }
+    }
+
+    if (index == npos)
+    {
+        return nullptr;
+    }
+    price = GetLevelPrice(index);
+    return &mLevels[index];
+}
+
+OrderBook::Level* OrderBook::GetLevel(Side side, unsigned long price)
+{
+    const std::size_t index = GetLevelIndex(price);
+    if (index != npos)
+    {
+        return &mLevels[index];
+    }
+    return (side == Side::SELL) ? &mOtherAsks.find(price)->second : &mOtherBids.find(price)->second;
+}
+
+bool OrderBook::MakeLevel(unsigned long price, std::size_t& index)
+{
+    if (price % mTickSize != 0)
+    {
+        return false;
+    }
+
+    index = GetLevelIndex(price);
+    if (index != npos)
+    {
+        return true;
+    }
+
+    // Work out the range of ticks that must be kept, which is every level
+    // in the window plus the new one, and move the levels to a window with
+    // room either side of it.
+    const unsigned long tick = price / mTickSize;
+    unsigned long lowest = tick;
+    unsigned long highest = tick;
+    if (mBestBid != npos)
+    {
+        lowest = std::min(lowest, mFirstTick + mBidLevels.FindNext(0));
+        highest = std::max(highest, mFirstTick + mBestBid);
+    }
+    if (mBestAsk != npos)
+    {
+        lowest = std::min(lowest, mFirstTick + mBestAsk);
+        highest = std::max(highest, mFirstTick + mAskLevels.FindPrevious(mLevels.size() - 1));
+    }
+
+    const unsigned long span = highest - lowest + 1;
+    if (span > MAXIMUM_LEVEL_COUNT)
+    {
+        return false;
+    }
+
+    std::size_t levelCount = std::max(mLevels.size(), INITIAL_LEVEL_COUNT);
+    while (levelCount < 2 * span && levelCount < MAXIMUM_LEVEL_COUNT)
+    {
+        levelCount *= 2;
+    }
+    MoveLevels(lowest - std::min(lowest, (levelCount - span) / 2), levelCount);
+
+    index = tick - mFirstTick;
+    return true;
+}
+
+void OrderBook::MoveLevels(unsigned long firstTick, std::size_t levelCount)
+{
+    std::vector<Level> levels(levelCount);
+    LevelBitmap askLevels;
+    LevelBitmap bidLevels;
+    askLevels.Reset(levelCount);
+    bidLevels.Reset(levelCount);
+
+    auto move = [&](const LevelBitmap& from, LevelBitmap& to, std::size_t& best) {
+        for (std::size_t i = from.FindNext(0); i != npos; i = from.FindNext(i + 1))
+        {
+            const std::size_t index = mFirstTick + i - firstTick;
+            levels[index] = mLevels[i];
+            to.Set(index);
+        }
+        if (best != npos)
+        {
+            best = mFirstTick + best - firstTick;
+        }
+    };
+
+    move(mAskLevels, askLevels, mBestAsk);
+    move(mBidLevels, bidLevels, mBestBid);
+
+    mLevels.swap(levels);
+    mAskLevels = std::move(askLevels);
+    mBidLevels = std::move(bidLevels);
+    mFirstTick = firstTick;
+
+    // Levels that were outside the old window may be inside the new one.
+    auto adopt = [&](auto& others, LevelBitmap& to, std::size_t& best, auto isBetter) {
+        for (auto it = others.begin(); it != others.end();)
+        {
+            const std::size_t index = GetLevelIndex(it->first);
+            if (index == npos)
+            {
+                ++it;
+                continue;
+            }
+            mLevels[index] = it->second;
+            to.Set(index);
+            if (best == npos || isBetter(index, best))
+            {
+                best = index;
+            }
+            it = others.erase(it);
+        }
+    };
+
+    adopt(mOtherAsks, mAskLevels, mBestAsk, std::less<>());
+    adopt(mOtherBids, mBidLevels, mBestBid, std::greater<>());
+}
+
+void OrderBook::Place(double now, Order& order)
+{
+    std::size_t index;
+    Level* level;
+    if (MakeLevel(order.mPrice, index))
+    {
+        level = &mLevels[index];
+        if (order.mSide == Side::SELL)
+        {
+            mAskLevels.Set(index);
+            if (mBestAsk == npos || index < mBestAsk)
+            {
+                mBestAsk = index;
+            }
+        }
+        else
+        {
+            mBidLevels.Set(index);
+            if (mBestBid == npos || index > mBestBid)
+            {
+                mBestBid = index;
+            }
+        }
+    }
+    else
+    {
+        level = (order.mSide == Side::SELL) ? &mOtherAsks[order.mPrice] : &mOtherBids[order.mPrice];
+    }
+
+    order.mPrevious = level->mLast;
+    (level->mLast ? level->mLast->mNext : level->mFirst) = &order;
+    level->mLast = &order;
+    level->mTotalVolume += order.mRemainingVolume;
+
+    if (order.mListener)
+    {
+        order.mListener->OrderPlaced(now, order);
+    }
+}
+
+void OrderBook::RemoveFromLevel(Order& order, unsigned long volume, bool removeOrder)
+{
+    Level& level = *GetLevel(order.mSide, order.mPrice);
+    level.mTotalVolume -= volume;
+    if (removeOrder)
+    {
+        Unlink(level, order);
+    }
+    if (level.mTotalVolume == 0)
+    {
+        RemoveLevel(order.mSide, order.mPrice);
+    }
+}
+
+void OrderBook::RemoveLevel(Side side, unsigned long price)
+{
+    const std::size_t index = GetLevelIndex(price);
+    if (index == npos)
+    {
+        if (side == Side::SELL)
+        {
+            mOtherAsks.erase(price);
+        }
+        else
+        {
+            mOtherBids.erase(price);
+        }
+        return;
+    }
+
+    mLevels[index] = Level();
+    if (side == Side::SELL)
+    {
+        mAskLevels.Clear(index);
+        if (index == mBestAsk)
+        {
+            mBestAsk = mAskLevels.FindNext(index + 1);
+        }
+    }
+    else
+    {
+        mBidLevels.Clear(index);
+        if (index == mBestBid)
+        {
+            mBestBid = mBidLevels.FindPrevious(index - 1);
+        }
+    }
+}
+
+void OrderBook::Trade(double now, Order& order)
+{
+    const bool isBuy = order.mSide == Side::BUY;
+    Ticks& ticks = isBuy ? mAskTicks : mBidTicks;
+
+    const Side passiveSide = isBuy ? Side::SELL : Side::BUY;
+
+    unsigned long price;
+    while (order.mRemainingVolume > 0
+           && (isBuy ? FindAsk(0, price) : FindBid(ULONG_MAX, price))
+           && (isBuy ? price <= order.mPrice : price >= order.mPrice))
+    {
+        Level& level = *GetLevel(passiveSide, price);
+        TradeLevel(now, order, price, level, ticks);
+        if (level.mTotalVolume == 0)
+        {
+            RemoveLevel(passiveSide, price);
+        }
+    }
+}
+
+void OrderBook::TradeLevel(double now, Order& order, unsigned long price, Level& level, Ticks& ticks)
+{
+    unsigned long remaining = order.mRemainingVolume;
+
+    while (remaining > 0 && level.mTotalVolume > 0)
+    {
+        Order* passive = level.mFirst;
+        const unsigned long volume = std::min(remaining, passive->mRemainingVolume);
+        const long fee = calculateFee(price, volume, mMakerFee);
+        level.mTotalVolume -= volume;
+        remaining -= volume;
+        passive->mRemainingVolume -= volume;
+        passive->mTotalFees += fee;
+        if (passive->mRemainingVolume == 0)
+        {
+            Unlink(level, *passive);
+        }
+        if (passive->mListener)
+        {
+            passive->mListener->OrderFilled(now, *passive, price, volume, fee);
+        }
+        if (passive->mRemainingVolume == 0)
+        {
+            mOrders.Release(passive);
+        }
+    }
+
+    const unsigned long traded = order.mRemainingVolume - remaining;
+    addTick(ticks, price, traded);
+    const long fee = calculateFee(price, traded, mTakerFee);
+    order.mRemainingVolume = remaining;
+    order.mTotalFees += fee;
+    mLastTradedPrice = price;
+    if (order.mListener)
+    {
+        order.mListener->OrderFilled(now, order, price, traded, fee);
+    }
+
+    OnTradeOccurred();
+}
+
+void OrderBook::TopLevels(std::array<unsigned long, TOP_LEVEL_COUNT>& askPrices,
+                          std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
+                          std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
+                          std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes) const
+{
+    unsigned long price;
+    const Level* level = FindAsk(0, price);
+    std::size_t i = 0;
+    for (; i < TOP_LEVEL_COUNT && level; ++i, level = FindAsk(price + 1, price))
+    {
+        askPrices[i] = price;
+        askVolumes[i] = level->mTotalVolume;
+    }
+    for (; i < TOP_LEVEL_COUNT; ++i)
+    {
+        askPrices[i] = askVolumes[i] = 0;
+    }
+
+    level = FindBid(ULONG_MAX, price);
+    for (i = 0; i < TOP_LEVEL_COUNT && level; ++i, level = (price > 0) ? FindBid(price - 1, price) : nullptr)
+    {
+        bidPrices[i] = price;
+        bidVolumes[i] = level->mTotalVolume;
+    }
+    for (; i < TOP_LEVEL_COUNT; ++i)
+    {
+        bidPrices[i] = bidVolumes[i] = 0;
+    }
+}
+
+bool OrderBook::TradeTicks(std::array<unsigned long, TOP_LEVEL_COUNT>& askPrices,
+                           std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
+                           std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
+                           std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes)
+{
+    if (mAskTicks.empty() && mBidTicks.empty())
+    {
+        return false;
+    }
+
+    copyTicks(mAskTicks, askPrices, askVolumes, std::less<>());
+    copyTicks(mBidTicks, bidPrices, bidVolumes, std::greater<>());
+    return true;
+}
+
+std::pair<unsigned long, unsigned long> OrderBook::TryTrade(Side side,
+                                                            unsigned long limitPrice,
+                                                            unsigned long volume) const
+{
+    unsigned long totalVolume = 0;
+    unsigned long totalValue = 0;
+
+    unsigned long price;
+    if (side == Side::SELL)
+    {
+        for (const Level* level = FindBid(ULONG_MAX, price);
+             totalVolume < volume && level && price >= limitPrice;
+             level = (price > 0) ? FindBid(price - 1, price) : nullptr)
+        {
+            const unsigned long weight = std::min(volume - totalVolume, level->mTotalVolume);
+            totalVolume += weight;
+            totalValue += weight * price;
+        }
+    }
+    else
+    {
+        for (const Level* level = FindAsk(0, price);
+             totalVolume < volume && level && price <= limitPrice;
+             level = FindAsk(price + 1, price))
+        {
+            const unsigned long weight = std::min(volume - totalVolume, level->mTotalVolume);
+            totalVolume += weight;
+            totalValue += weight * price;
+        }
+    }
+
+    return {totalVolume, (totalVolume > 0) ? totalValue / totalVolume : 0};
+}
+
+}
@@ -0,0 +1,238 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_MATCHING_ENGINE_ORDERBOOK_H
+#define CPPREADY_TRADER_GO_LIBS_MATCHING_ENGINE_ORDERBOOK_H
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <ready_trader_go/types.h>
+
+#include "levelbitmap.h"
+#include "objectpool.h"
+
+namespace ReadyTraderGo {
+
+struct Order;
+
+// Receives the events for an order. Once an order's remaining volume has
+// reached zero the order book returns it to its pool straight after telling
+// the listener, so nothing may hold on to the order after that. Listeners
+// must not change the order book from inside a callback.
+class IOrderListener
+{
+public:
+    virtual ~IOrderListener() = default;
+
+    virtual void OrderAmended(double now, Order& order, unsigned long volumeRemoved) {};
+    virtual void OrderCancelled(double now, Order& order, unsigned long volumeRemoved) {};
+    virtual void OrderFilled(double now, Order& order, unsigned long price, unsigned long volume, long fee) {};
+    // Called when a good-for-day order is placed in the order book.
+    virtual void OrderPlaced(double now, Order& order) {};
+};
+
+// A request to buy or sell at a given price. Orders are created by the
+// order book they are inserted into and are linked into the queue of their
+// price level while they rest in it.
+struct Order
+{
+    Order(unsigned long clientOrderId,
+          Instrument instrument,
+          Lifespan lifespan,
+          Side side,
+          unsigned long price,
+          unsigned long volume,
+          IOrderListener* listener = nullptr)
+        : mClientOrderId(clientOrderId),
+          mInstrument(instrument),
+          mLifespan(lifespan),
+          mSide(side),
+          mPrice(price),
+          mVolume(volume),
+          mRemainingVolume(volume),
+          mListener(listener) {}
+
+    unsigned long mClientOrderId;
+    Instrument mInstrument;
+    Lifespan mLifespan;
+    Side mSide;
+    unsigned long mPrice;
+    unsigned long mVolume;
+    unsigned long mRemainingVolume;
+    long mTotalFees = 0;
+    IOrderListener* mListener;
+
+    Order* mPrevious = nullptr;
+    Order* mNext = nullptr;
+};
+
+// A collection of orders arranged by the price-time priority principle,
+// behaving exactly as the Python exchange's order book does (including how
+// fees are rounded and how trade ticks are accumulated).
+//
+// Price levels live in an array indexed by tick, covering a window of
+// prices that is moved and grown as orders arrive. Bids and asks share the
+// array (a price can only hold orders on one side of an uncrossed book) and
+// a bitmap for each side finds the next level along. The few levels that
+// cannot go in the window (because their price is not a multiple of the
+// tick size, or is too far from the rest of the book to fit in
+// MAXIMUM_LEVEL_COUNT ticks) are kept in a sorted map instead.
+class OrderBook
+{
+public:
+    static constexpr std::size_t INITIAL_LEVEL_COUNT = 4096;
+    static constexpr std::size_t MAXIMUM_LEVEL_COUNT = 1ul << 16;
+
+    OrderBook(Instrument instrument, double makerFee, double takerFee, unsigned long tickSize = 1);
+
+    OrderBook(const OrderBook&) = delete;
+    OrderBook& operator=(const OrderBook&) = delete;
+
+    // Amend an order in this order book by decreasing its volume.
+    void Amend(double now, Order& order, unsigned long newVolume);
+    // Cancel an order in this order book.
+    void Cancel(double now, Order& order);
+    // Insert a new order into this order book, trading it against any
+    // orders it crosses. Returns the order if it was placed in the book, or
+    // nullptr if it was completely filled or cancelled.
+    Order* Insert(double now,
+                  unsigned long clientOrderId,
+                  Lifespan lifespan,
+                  Side side,
+                  unsigned long price,
+                  unsigned long volume,
+                  IOrderListener* listener = nullptr);
+
+    Instrument GetInstrument() const { return mInstrument; }
+
+    // The last traded price, or zero if there have been no trades.
+    unsigned long GetLastTradedPrice() const { return mLastTradedPrice; }
+
+    // The midpoint of the best bid and ask, or zero if either side is empty.
+    double GetMidpointPrice() const;
+
+    // The number of orders resting in this order book.
+    std::size_t GetOrderCount() const { return mOrders.GetCount(); }
+
+    // Populate the arrays with the best price levels (zero filled).
+    void TopLevels(std::array<unsigned long, TOP_LEVEL_COUNT>& askPrices,
+                   std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
+                   std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
+                   std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes) const;
+
+    // If there have been trades since the last call, populate the arrays
+    // with the volume traded at each price and return true.
+    bool TradeTicks(std::array<unsigned long, TOP_LEVEL_COUNT>& askPrices,
+                    std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
+                    std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
+                    std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes);
+
+    // Return the volume that would trade and the average price per lot for
+    // the given trade without changing the order book.
+    std::pair<unsigned long, unsigned long> TryTrade(Side side, unsigned long limitPrice, unsigned long volume) const;
+
+    // Called after each price level is traded.
+    std::function<void(OrderBook&)> TradeOccurred;
+
+private:
+    static constexpr std::size_t npos = LevelBitmap::npos;
+
+    struct Level
+    {
+        Order* mFirst = nullptr;
+        Order* mLast = nullptr;
+        unsigned long mTotalVolume = 0;
+    };
+
+    using Ticks = std::vector<std::pair<unsigned long, unsigned long>>;
+
+    void OnTradeOccurred();
+
+    unsigned long GetLevelPrice(std::size_t index) const { return (mFirstTick + index) * mTickSize; }
+    // Return the index in mLevels of the given price, or npos if the price
+    // is outside the window.
+    std::size_t GetLevelIndex(unsigned long price) const;
+
+    // The ask level with the lowest price at or above the given price and
+    // the bid level with the highest price at or below it, or nullptr.
+    const Level* FindAsk(unsigned long lowest, unsigned long& price) const;
+    const Level* FindBid(unsigned long highest, unsigned long& price) const;
+    Level* GetLevel(Side side, unsigned long price);
+
+    bool MakeLevel(unsigned long price, std::size_t& index);
+    void MoveLevels(unsigned long firstTick, std::size_t levelCount);
+    void Place(double now, Order& order);
+    void RemoveFromLevel(Order& order, unsigned long volume, bool removeOrder);
+    void RemoveLevel(Side side, unsigned long price);
+    void Trade(double now, Order& order);
+    void TradeLevel(double now, Order& order, unsigned long price, Level& level, Ticks& ticks);
+    static void Unlink(Level& level, Order& order);
+
+    Instrument mInstrument;
+    double mMakerFee;
+    double mTakerFee;
+    unsigned long mTickSize;
+    unsigned long mLastTradedPrice = 0;
+
+    // Levels hold the prices from mFirstTick * mTickSize upwards.
+    std::vector<Level> mLevels;
+    unsigned long mFirstTick = 0;
+    LevelBitmap mAskLevels;
+    LevelBitmap mBidLevels;
+    std::size_t mBestAsk = npos;
+    std::size_t mBestBid = npos;
+    std::map<unsigned long, Level> mOtherAsks;
+    std::map<unsigned long, Level, std::greater<>> mOtherBids;
+
+    ObjectPool<Order> mOrders;
+    Ticks mAskTicks;
+    Ticks mBidTicks;
+};
+
+inline void OrderBook::OnTradeOccurred()
+{
+    if (TradeOccurred)
+    {
+        TradeOccurred(*this);
+    }
+}
+
+inline std::size_t OrderBook::GetLevelIndex(unsigned long price) const
+{
+    const unsigned long tick = price / mTickSize;
+    if (price % mTickSize != 0 || tick < mFirstTick || tick - mFirstTick >= mLevels.size())
+    {
+        return npos;
+    }
+    return tick - mFirstTick;
+}
+
+inline void OrderBook::Unlink(Level& level, Order& order)
+{
+    (order.mPrevious ? order.mPrevious->mNext : level.mFirst) = order.mNext;
+    (order.mNext ? order.mNext->mPrevious : level.mLast) = order.mPrevious;
+    order.mPrevious = order.mNext = nullptr;
+}
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_MATCHING_ENGINE_ORDERBOOK_H
@@ -16,37 +16,26 @@
 //     License along with Ready Trader Go.  If not, see
 //     <https://www.gnu.org/licenses/>.
 #include <csignal>
-#include <cstring>
-#include <fstream>
 #include <iomanip>
 #include <string>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #define BOOST_BIND_GLOBAL_PLACEHOLDERS
-#include <boost/log/attributes/clock.hpp>
-#include <boost/log/core.hpp>
-#include <boost/log/expressions.hpp>
-#include <boost/log/sinks/text_ostream_backend.hpp>
-#include <boost/log/support/date_time.hpp>
-#include <boost/log/utility/setup/formatter_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
-#include <boost/shared_ptr.hpp>
 
 #include "application.h"
 #include "error.h"
 #include "logging.h"
 
-namespace logging = boost::log;
-namespace sinks = boost::log::sinks;
-namespace expr = boost::log::expressions;
-namespace attrs = boost::log::attributes;
-
 RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_APP, "APP")
 
 namespace ReadyTraderGo {
 
-BOOST_LOG_ATTRIBUTE_KEYWORD(rtg_severity, "Severity", LogLevel)
-
 // Return the stem of a given path, e.g. stem("/foo/bar.exe") returns "bar".
 static inline std::string stem(const std::string& path)
 {
@@ -60,6 +49,19 @@ static inline std::string stem(const std::string& path)
     return filename;
 }
 
+// Pin the calling thread to the given CPU, returning false on failure.
+static bool setThreadAffinity(int cpu)
+{
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+    return false;
+#endif
+}
+
 Application::~Application()
 {
     if (!mContext.stopped())
@@ -69,24 +71,22 @@ Application::~Application()
     TearDownLogging();
 }
 
-void Application::LoadConfig(const std::string& filename)
+// The configuration is read before logging starts, since it says how to log,
+// so failures are only reported by the exception.
+boost::property_tree::ptree Application::LoadConfig(const std::string& filename)
 {
     boost::property_tree::ptree tree;
 
-    RLOG(LG_APP, LogLevel::LL_INFO) << "loading configuration from " << std::quoted(filename, '\'');
-
     try
     {
         boost::property_tree::read_json(filename, tree);
     }
     catch (boost::property_tree::json_parser_error& err)
     {
-        RLOG(LG_APP, LogLevel::LL_ERROR) << "failed while reading configuration file " << std::quoted(filename, '\'')
-                                         << ": " << err.message();
         throw ReadyTraderGoError("failed while reading configuration file: '" + filename + "': " + err.message());
     }
 
-    OnConfigLoaded(tree);
+    return tree;
 }
 
 void Application::Run(int argc, char* argv[])
@@ -100,55 +100,117 @@ void Application::Run(int argc, char* argv[])
         throw ReadyTraderGoError("application has no name");
     }
 
-    SetUpLogging();
+    std::string configFilename = mName + ".json";
+    boost::property_tree::ptree config = LoadConfig(configFilename);
+
+    SetUpLogging(config);
     RLOG(LG_APP, LogLevel::LL_INFO) << "application started";
+    RLOG(LG_APP, LogLevel::LL_INFO) << "loaded configuration from " << std::quoted(configFilename, '\'');
 
-    LoadConfig(mName + ".json");
+    OnConfigLoaded(config);
 
     // Add signal handling (to handle Ctrl-C, for example)
     mSignals.add(SIGINT);
     mSignals.add(SIGTERM);
 #ifdef SIGQUIT
     mSignals.add(SIGQUIT);
+#endif
+#ifdef SIGUSR1
+    mSignals.add(SIGUSR1);
 #endif
     mSignals.async_wait([this](const boost::system::error_code& ec, int s) { SignalHandler(ec, s); });
 
     OnReadyToRun();
-    mContext.run();
+
+    if (Poll)
+    {
+        BusyPoll();
+    }
+    else
+    {
+        mContext.run();
+    }
+
+    OnStatisticsRequested();
 }
 
-void Application::SetUpLogging()
+void Application::BusyPoll()
 {
-    std::string logFilename = mName + ".log";
-    std::ofstream logStream{logFilename, std::ios_base::app};
-    if (!logStream)
+    if (mBusyPollCpu >= 0 && !setThreadAffinity(mBusyPollCpu))
     {
-        std::string message = "failed to open log file '" + logFilename + "': " + std::strerror(errno);
-        throw ReadyTraderGoError(message);
+        RLOG(LG_APP, LogLevel::LL_WARNING) << "failed to pin busy poll loop to cpu " << mBusyPollCpu;
     }
+    RLOG(LG_APP, LogLevel::LL_INFO) << "busy poll loop started";
 
-    boost::shared_ptr<boost::log::core> core = logging::core::get();
-    core->add_global_attribute("TimeStamp", attrs::local_clock());
+    std::size_t delivered = 0;
+    while (!mContext.stopped())
+    {
+        // Other handlers (execution messages, timers and signals) get a look
+        // in whenever there is nothing to deliver or after a run of messages.
+        const std::size_t count = Poll();
+        if (count != 0)
+        {
+            mWaitStrategy.Busy();
+            delivered += count;
+            if (delivered < BUSY_POLL_BATCH_SIZE)
+            {
+                continue;
+            }
+        }
+        delivered = 0;
+
+        if (mContext.poll_one() != 0)
+        {
+            mWaitStrategy.Busy();
+        }
+        else if (count == 0)
+        {
+            // Sleep by waiting on the io_context so that execution messages,
+            // timers and signals still wake the loop immediately.
+            const auto delay = mWaitStrategy.Idle();
+            if (delay.count() != 0 && mContext.run_one_for(delay) != 0)
+            {
+                mWaitStrategy.Busy();
+            }
+        }
+    }
 
-    auto backend = boost::make_shared<sinks::text_ostream_backend>();
-    backend->add_stream(boost::make_shared<std::ofstream>(std::move(logStream)));
-    mSink = boost::make_shared<sink_t>(backend);
-    core->add_sink(mSink);
+    RLOG(LG_APP, LogLevel::LL_INFO) << "busy poll loop finished: " << mWaitStrategy.GetStatistics();
+}
 
-    mSink->set_formatter(
-        expr::stream
-            << expr::format_date_time<boost::posix_time::ptime>("TimeStamp", "%Y-%m-%d %H:%M:%S.%f")
-            << " [" << std::left << std::setw(7) << std::setfill(' ') << rtg_severity << "] ["
-            << expr::attr<std::string>("Channel") << "] " << expr::smessage
-    );
+void Application::SetUpLogging(const boost::property_tree::ptree& config)
+{
+    std::string format = config.get<std::string>("Logging.Format", "text");
+    if (format == "text")
+    {
+        startLogging(mName + ".log", LogFormat::TEXT);
+    }
+    else if (format == "binary")
+    {
+        startLogging(mName + ".binlog", LogFormat::BINARY);
+    }
+    else
+    {
+        throw ReadyTraderGoError("unknown log format '" + format + "'");
+    }
 
 #ifdef NDEBUG
-    mSink->set_filter(rtg_severity > LogLevel::LL_DEBUG);
+    setLogLevel(LogLevel::LL_INFO);
 #endif
 }
 
 void Application::SignalHandler(const boost::system::error_code& error, int signal)
 {
+#ifdef SIGUSR1
+    if (!error && signal == SIGUSR1)
+    {
+        RLOG(LG_APP, LogLevel::LL_INFO) << "application received signal " << signal << ", writing statistics";
+        OnStatisticsRequested();
+        mSignals.async_wait([this](const boost::system::error_code& ec, int s) { SignalHandler(ec, s); });
+        return;
+    }
+#endif
+
     if (!error)
     {
         RLOG(LG_APP, LogLevel::LL_INFO) << "application received signal " << signal << ", shutting down";
@@ -168,12 +230,7 @@ void Application::SignalHandler(const boost::system::error_code& error, int sign
 
 void Application::TearDownLogging()
 {
-    if (mSink)
-    {
-        logging::core::get()->remove_sink(mSink);
-        mSink->stop();
-        mSink->flush();
-    }
+    stopLogging();
 }
 
 }
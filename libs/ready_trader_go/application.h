@@ -18,6 +18,7 @@
 #ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_APPLICATION_H
 #define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_APPLICATION_H
 
+#include <cstddef>
 #include <functional>
 #include <stdexcept>
 #include <string>
@@ -25,17 +26,16 @@
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/signal_set.hpp>
-#include <boost/log/sinks/async_frontend.hpp>
-#include <boost/log/sinks/bounded_fifo_queue.hpp>
-#include <boost/log/sinks/drop_on_overflow.hpp>
-#include <boost/log/sinks/text_ostream_backend.hpp>
 #include <boost/property_tree/ptree.hpp>
-#include <boost/shared_ptr.hpp>
 #include <boost/system/error_code.hpp>
 
+#include "waitstrategy.h"
+
 namespace ReadyTraderGo {
 
-constexpr std::size_t LOG_QUEUE_SIZE = 1024;
+// Maximum number of consecutive messages the busy poll loop will deliver
+// before servicing the io_context.
+constexpr std::size_t BUSY_POLL_BATCH_SIZE = 64;
 
 class Application
 {
@@ -50,29 +50,45 @@ public:
     void operator=(Application&& other) = delete;
 
     boost::asio::io_context& GetContext() { return mContext; }
+    const std::string& GetName() const { return mName; }
 
     void Run(int argc, char* argv[]);
 
+    // Pin the busy poll loop to the given CPU (a negative value leaves the
+    // thread unpinned).
+    void SetBusyPollCpu(int cpu) { mBusyPollCpu = cpu; }
+
+    // How the busy poll loop waits when there is nothing to do.
+    void SetBusyPollWaitStrategy(const WaitStrategy& waitStrategy) { mWaitStrategy = waitStrategy; }
+
     std::function<void(const boost::property_tree::ptree&)> ConfigLoaded;
     std::function<void()> ReadyToRun;
 
+    // Called when SIGUSR1 is received and when the run loop has finished,
+    // for dumping statistics.
+    std::function<void()> StatisticsRequested;
+
+    // If set, Run() spins calling Poll() in between servicing the io_context
+    // rather than blocking in io_context::run(). Poll() should return the
+    // number of messages it delivered.
+    std::function<std::size_t()> Poll;
+
 private:
     void OnConfigLoaded(const boost::property_tree::ptree& tree) const;
     void OnReadyToRun() const;
+    void OnStatisticsRequested() const;
 
-    void LoadConfig(const std::string& filename);
-    void SetUpLogging();
+    void BusyPoll();
+    boost::property_tree::ptree LoadConfig(const std::string& filename);
+    void SetUpLogging(const boost::property_tree::ptree& config);
     void SignalHandler(const boost::system::error_code& error, int signal);
     void TearDownLogging();
 
     boost::asio::io_context mContext;
     std::string mName;
     boost::asio::signal_set mSignals;
-
-    using sink_t = boost::log::sinks::asynchronous_sink<
-        boost::log::sinks::text_ostream_backend,
-        boost::log::sinks::bounded_fifo_queue<LOG_QUEUE_SIZE, boost::log::sinks::drop_on_overflow>>;
-    boost::shared_ptr<sink_t> mSink;
+    int mBusyPollCpu = -1;
+    WaitStrategy mWaitStrategy;
 };
 
 inline void Application::OnConfigLoaded(const boost::property_tree::ptree& tree) const
@@ -91,6 +107,14 @@ inline void Application::OnReadyToRun() const
     }
 }
 
+inline void Application::OnStatisticsRequested() const
+{
+    if (StatisticsRequested)
+    {
+        StatisticsRequested();
+    }
+}
+
 }
 
 #endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_APPLICATION_H
@@ -15,6 +15,11 @@
 //     You should have received a copy of the GNU Affero General Public
 //     License along with Ready Trader Go.  If not, see
 //     <https://www.gnu.org/licenses/>.
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
 #include <memory>
 
 #include <boost/property_tree/ptree.hpp>
@@ -23,6 +28,10 @@
 #include "connectivity.h"
 #include "config.h"
 #include "error.h"
+#include "logging.h"
+#include "waitstrategy.h"
+
+RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_ATAH, "ATAH")
 
 namespace ReadyTraderGo {
 
@@ -37,22 +46,97 @@ void AutoTraderAppHandler::ConfigLoadedHandler(const boost::property_tree::ptree
     if (config.mSecret.size() > MessageFieldSize::STRING)
         throw ReadyTraderGoError("configured secret is too long");
 
-    mExecConnectionFactory = std::make_unique<ConnectionFactory>(mContext,
-                                                                 config.mExecHost,
-                                                                 config.mExecPort);
+    if (config.mExecType == "null")
+    {
+        mExecConnectionFactory = std::make_unique<NullConnectionFactory>();
+    }
+    else if (config.mExecType == "tcp")
+    {
+        ConnectionOptions execOptions;
+        execOptions.mReceiveBufferSize = config.mExecReceiveBufferSize;
+        execOptions.mSendBufferSize = config.mExecSendBufferSize;
+        execOptions.mBusyPoll = config.mExecBusyPoll;
+        execOptions.mSocketBusyPoll = config.mExecSocketBusyPoll;
+        execOptions.mReceiveTimestamps = config.mExecReceiveTimestamps;
+        mExecConnectionFactory = std::make_unique<ConnectionFactory>(mContext,
+                                                                     config.mExecHost,
+                                                                     config.mExecPort,
+                                                                     execOptions);
+    }
+    else
+    {
+        throw ReadyTraderGoError("unknown execution connection type '" + config.mExecType + "'");
+    }
+
+    SubscriptionOptions infoOptions;
+    infoOptions.mBusyPoll = config.mInfoBusyPoll;
+    infoOptions.mConflate = config.mInfoConflate;
+    infoOptions.mWaitStrategy = WaitStrategy(parseWaitPolicy(config.mInfoWaitPolicy),
+                                             config.mInfoSpinCount,
+                                             std::chrono::microseconds(config.mInfoMinimumSleep),
+                                             std::chrono::microseconds(config.mInfoMaximumSleep));
+    infoOptions.mHugePages = config.mInfoHugePages;
+    infoOptions.mPrefault = config.mInfoPrefault;
+    infoOptions.mLock = config.mInfoLock;
+    infoOptions.mCaptureFile = config.mInfoCaptureFile;
+    infoOptions.mReplaySpeed = config.mInfoReplaySpeed;
     mInfoSubscriptionFactory = std::make_unique<SubscriptionFactory>(mContext,
                                                                      config.mInfoType,
-                                                                     config.mInfoName);
+                                                                     config.mInfoName,
+                                                                     infoOptions);
+    mExecBusyPoll = config.mExecBusyPoll;
+    mInfoBusyPoll = config.mInfoBusyPoll;
+    mApplication.SetBusyPollCpu(config.mBusyPollCpu);
+    mApplication.SetBusyPollWaitStrategy(infoOptions.mWaitStrategy);
+
+    mLatencyFile = config.mLatencyFile.empty() ? mApplication.GetName() + ".latency" : config.mLatencyFile;
 
     mAutoTrader.SetLoginDetails(config.mTeamName, config.mSecret);
+    mAutoTrader.SetParameters(config.mParameters);
+    mAutoTrader.SetPreTradeLimits(config.mPreTradeLimits);
 }
 
 void AutoTraderAppHandler::ReadyToRunHandler()
 {
     auto connection = mExecConnectionFactory->Create();
-    mAutoTrader.SetExecutionConnection(std::move(connection));
     auto subscription = mInfoSubscriptionFactory->Create();
+
+    // The connection and subscription are owned by the auto-trader, which
+    // outlives the application's run loop.
+    IConnection* exec = mExecBusyPoll ? connection.get() : nullptr;
+    ISubscription* info = mInfoBusyPoll ? subscription.get() : nullptr;
+    if (exec && info)
+    {
+        mApplication.Poll = [exec, info] { return exec->Poll() + info->Poll(); };
+    }
+    else if (exec)
+    {
+        mApplication.Poll = [exec] { return exec->Poll(); };
+    }
+    else if (info)
+    {
+        mApplication.Poll = [info] { return info->Poll(); };
+    }
+
+    mAutoTrader.SetExecutionConnection(std::move(connection));
     mAutoTrader.SetInformationSubscription(std::move(subscription));
 }
 
+void AutoTraderAppHandler::StatisticsRequestedHandler()
+{
+    std::ofstream stream{mLatencyFile, std::ios_base::app};
+    if (!stream)
+    {
+        RLOG(LG_ATAH, LogLevel::LL_WARNING) << "failed to open latency file '" << mLatencyFile << "': "
+                                            << std::strerror(errno);
+        return;
+    }
+
+    const auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    stream << "# tick-to-trade latency at " << std::put_time(std::localtime(&now), "%Y-%m-%d %H:%M:%S") << '\n';
+    mAutoTrader.WriteTickToTradeStatistics(stream);
+    mAutoTrader.WritePreTradeStatistics(stream);
+    RLOG(LG_ATAH, LogLevel::LL_INFO) << "tick-to-trade latency written to '" << mLatencyFile << "'";
+}
+
 }
@@ -19,6 +19,7 @@
 #define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_AUTOTRADERAPPHANDLER_H
 
 #include <memory>
+#include <string>
 
 #include <boost/asio/io_context.hpp>
 
@@ -36,18 +37,23 @@ public:
     {
         mApplication.ConfigLoaded = [this](auto& tree) { ConfigLoadedHandler(tree); };
         mApplication.ReadyToRun = [this] { ReadyToRunHandler(); };
+        mApplication.StatisticsRequested = [this] { StatisticsRequestedHandler(); };
     }
 
 private:
     void ConfigLoadedHandler(const boost::property_tree::ptree&);
     void ReadyToRunHandler();
+    void StatisticsRequestedHandler();
 
     Application& mApplication;
     BaseAutoTrader& mAutoTrader;
     boost::asio::io_context& mContext;
 
-    std::unique_ptr<ConnectionFactory> mExecConnectionFactory;
+    std::unique_ptr<IConnectionFactory> mExecConnectionFactory;
     std::unique_ptr<SubscriptionFactory> mInfoSubscriptionFactory;
+    std::string mLatencyFile;
+    bool mExecBusyPoll = false;
+    bool mInfoBusyPoll = false;
 };
 
 }
@@ -32,12 +32,15 @@ void BaseAutoTrader::SetExecutionConnection(std::unique_ptr<IConnection>&& conne
     mExecutionConnection->MessageReceived = [this](IConnection* c,
                                                    unsigned char t,
                                                    unsigned char const* d,
-                                                   std::size_t s) { MessageHandler(c, t, d, s); };
+                                                   std::size_t s,
+                                                   ReceiveTime r) { MessageHandler(c, t, d, s, r); };
+    mExecutionConnection->MessagesWritten = [this] { RecordTickToTrade(); };
 
     RLOG(LG_BAT, LogLevel::LL_INFO) << "logging in with teamname='" << mTeamName
                                     << "' and secret='" << mSecret << '\'';
     mExecutionConnection->SendMessage(MessageType::LOGIN,
                                       LoginMessage{mTeamName, mSecret});
+    mPreTradeLimits.MessageSent(GetTime());
 
     mExecutionConnection->AsyncRead();
 }
@@ -45,65 +48,117 @@ void BaseAutoTrader::SetExecutionConnection(std::unique_ptr<IConnection>&& conne
 void BaseAutoTrader::MessageHandler(IConnection* connection,
                                     unsigned char messageType,
                                     unsigned char const* data,
-                                    std::size_t size)
+                                    std::size_t size,
+                                    ReceiveTime receiveTime)
 {
-    switch (messageType)
-    {
-    case MessageType::ERROR_MESSAGE:
-    {
-        auto err = makeMessage<ErrorMessage>(data, size);
-        ErrorMessageHandler(err.mClientOrderId, err.mMessage);
-        break;
-    }
-    case MessageType::HEDGE_FILLED:
-    {
-        auto filled = makeMessage<HedgeFilledMessage>(data, size);
-        HedgeFilledMessageHandler(filled.mClientOrderId, filled.mPrice, filled.mVolume);
-        break;
-    }
-    case MessageType::ORDER_FILLED:
-    {
-        auto filled = makeMessage<OrderFilledMessage>(data, size);
-        OrderFilledMessageHandler(filled.mClientOrderId, filled.mPrice, filled.mVolume);
-        break;
-    }
-    case MessageType::ORDER_STATUS:
+    HandleExecutionMessage(messageType, data, size, receiveTime, [this, receiveTime](const auto& message) {
+        using Message = std::decay_t<decltype(message)>;
+        if constexpr (std::is_same_v<Message, ErrorMessage>)
+        {
+            ErrorMessageHandler(message.mClientOrderId, message.mMessage.View(), receiveTime);
+        }
+        else if constexpr (std::is_same_v<Message, HedgeFilledMessage>)
+        {
+            HedgeFilledMessageHandler(message.mClientOrderId, message.mPrice, message.mVolume, receiveTime);
+        }
+        else if constexpr (std::is_same_v<Message, OrderFilledMessage>)
+        {
+            OrderFilledMessageHandler(message.mClientOrderId, message.mPrice, message.mVolume, receiveTime);
+        }
+        else
+        {
+            OrderStatusMessageHandler(message.mClientOrderId, message.mFillVolume,
+                                      message.mRemainingVolume, message.mFees, receiveTime);
+        }
+    });
+}
+
+void BaseAutoTrader::UnexpectedExecutionMessage(unsigned char messageType)
+{
+    RLOG(LG_BAT, LogLevel::LL_ERROR) << "received execution message with unexpected type: "
+                                     << static_cast<int>(messageType);
+    throw ReadyTraderGoError("received execution message with unexpected type");
+}
+
+void BaseAutoTrader::SendDeferredCancels()
+{
+    // Cancels go in the order they were asked for, as many as the message
+    // frequency limit and the send buffer allow, skipping any whose order
+    // has since finished.
+    const double now = GetTime();
+    std::size_t sent = 0;
+    for (; sent != mDeferredCancels.size(); ++sent)
     {
-        auto status = makeMessage<OrderStatusMessage>(data, size);
-        OrderStatusMessageHandler(status.mClientOrderId, status.mFillVolume,
-                                  status.mRemainingVolume, status.mFees);
-        break;
+        const unsigned long clientOrderId = mDeferredCancels[sent];
+        const ManagedOrder* order = mOrderManager.Find(clientOrderId);
+        if (order && !order->IsActive())
+        {
+            continue;
+        }
+        if (!mPreTradeLimits.IsWithinMessageFrequency(now))
+        {
+            break;
+        }
+        mPreTradeLimits.CheckCancel(now);
+        if (!mExecutionConnection->SendMessage(MessageType::CANCEL_ORDER, CancelMessage{clientOrderId}))
+        {
+            mPreTradeLimits.Reject(PreTradeReason::SEND_BUFFER_FULL);
+            break;
+        }
+        mOrderManager.CancelSent(clientOrderId);
     }
-    default:
+    mDeferredCancels.erase(mDeferredCancels.begin(), mDeferredCancels.begin() + sent);
+}
+
+void BaseAutoTrader::WriteTickToTradeStatistics(std::ostream& stream) const
+{
+    static const char* const sendTypeNames[SEND_TYPE_COUNT] = {"amend", "cancel", "hedge", "insert"};
+
+    for (std::size_t i = 0; i != INSTRUMENT_COUNT; ++i)
     {
-        RLOG(LG_BAT, LogLevel::LL_ERROR) << "received execution message with unexpected type: "
-                                         << static_cast<int>(messageType);
-        throw ReadyTraderGoError("received execution message with unexpected type");
-    }
+        for (std::size_t j = 0; j != SEND_TYPE_COUNT; ++j)
+        {
+            stream << "instrument=" << static_cast<Instrument>(i) << " send=" << sendTypeNames[j] << ' ';
+            mTickToTrade[i][j].WriteTo(stream);
+        }
     }
 }
 
+void BaseAutoTrader::OrderBookMessageHandler(const OrderBookView& view)
+{
+    auto book = makeMessage<OrderBookMessage>(view.GetData(), OrderBookMessage().Size());
+    OrderBookMessageHandler(book.mInstrument, book.mSequenceNumber, book.mAskPrices,
+                            book.mAskVolumes, book.mBidPrices, book.mBidVolumes);
+}
+
+void BaseAutoTrader::TradeTicksMessageHandler(const TradeTicksView& view)
+{
+    auto ticks = makeMessage<TradeTicksMessage>(view.GetData(), TradeTicksMessage().Size());
+    TradeTicksMessageHandler(ticks.mInstrument, ticks.mSequenceNumber, ticks.mAskPrices,
+                             ticks.mAskVolumes, ticks.mBidPrices, ticks.mBidVolumes);
+}
+
 void BaseAutoTrader::MessageHandler(ISubscription* subscription,
                                     unsigned char messageType,
                                     unsigned char const* data,
-                                    std::size_t size)
+                                    std::size_t size,
+                                    ReceiveTime receiveTime)
 {
+    BeginMessage();
+
     switch (messageType)
     {
     case MessageType::ORDER_BOOK_UPDATE:
     {
-        auto book = makeMessage<OrderBookMessage>(data, size);
-        OrderBookMessageHandler(book.mInstrument, book.mSequenceNumber, book.mAskPrices,
-                                book.mAskVolumes, book.mBidPrices, book.mBidVolumes);
+        OrderBookView book{data};
+        BeginOrderBook(subscription, book, receiveTime);
+        OrderBookMessageHandler(book, receiveTime);
+        EndOrderBook();
         break;
     }
     case MessageType::TRADE_TICKS:
-    {
-        auto ticks = makeMessage<TradeTicksMessage>(data, size);
-        TradeTicksMessageHandler(ticks.mInstrument, ticks.mSequenceNumber, ticks.mAskPrices,
-                                 ticks.mAskVolumes, ticks.mBidPrices, ticks.mBidVolumes);
+        TradeTicksMessageHandler(TradeTicksView{data}, receiveTime);
         break;
-    }
     default:
     {
         RLOG(LG_BAT, LogLevel::LL_ERROR) << "received information message with unexpected type: "
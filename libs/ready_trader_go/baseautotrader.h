@@ -18,26 +18,83 @@
 #ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_BASEAUTOTRADER_H
 #define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_BASEAUTOTRADER_H
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstddef>
+#include <functional>
 #include <memory>
+#include <ostream>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include <boost/asio/io_context.hpp>
 
 #include "connectivitytypes.h"
+#include "latencyhistogram.h"
+#include "ordermanager.h"
+#include "pretradelimits.h"
 #include "protocol.h"
+#include "strategyparameters.h"
 #include "types.h"
 
 namespace ReadyTraderGo {
 
+constexpr std::size_t INSTRUMENT_COUNT = 2;
+
+// Kinds of message sent by the auto-trader, for latency statistics.
+enum class SendType : unsigned char { AMEND, CANCEL, HEDGE, INSERT };
+constexpr std::size_t SEND_TYPE_COUNT = 4;
+
+// The most messages that can wait to be written before their tick-to-trade
+// latency is recorded; beyond this the latency of those waiting is recorded
+// early.
+constexpr std::size_t MAXIMUM_PENDING_TICK_TO_TRADE = 64;
+
+// What happened to a cancel: written to the exchange, or held back by the
+// message frequency limit (or a full send buffer) until a later message
+// arrives.
+enum class CancelResult : unsigned char { SENT, DEFERRED };
+
 class BaseAutoTrader
 {
 public:
-    explicit BaseAutoTrader(boost::asio::io_context& context) : mContext(context) {};
+    explicit BaseAutoTrader(boost::asio::io_context& context) : mContext(context)
+    {
+        mDeferredCancels.reserve(ORDER_MANAGER_CAPACITY);
+        mErrorMessage.reserve(MessageFieldSize::STRING);
+    };
+
+    // Queue the messages sent until the matching Flush() and then write
+    // them together. SendBatch does the same for the lifetime of a scope.
+    void BeginBatch() { mExecutionConnection->BeginBatch(); }
+    void Flush() { mExecutionConnection->Flush(); }
+    SendBatch MakeSendBatch() { return SendBatch(*mExecutionConnection); }
 
+    // Each message is first checked against the pre-trade limits and these
+    // return false if it was not sent, which is also the case when the
+    // connection's send buffer is full. A hedge or insert is also not sent
+    // if its client order id's slot in the order manager holds an active
+    // order (use HedgeOrder and InsertOrder below, which pick a free id). A cancel that would breach the message
+    // frequency limit, or that the send buffer has no room for, is instead
+    // held back and sent as soon as it can be (once a message arrives after
+    // that), unless the order has finished by then; the order is only marked
+    // as cancelling once its cancel has been written.
+    bool TryAmendOrder(unsigned long clientOrderId, unsigned long volume);
+    CancelResult TryCancelOrder(unsigned long clientOrderId);
+    bool TryHedgeOrder(unsigned long clientOrderId, Side side, unsigned long price, unsigned long volume);
+    bool TryInsertOrder(unsigned long clientOrderId,
+                        Side side,
+                        unsigned long price,
+                        unsigned long volume,
+                        Lifespan lifespan);
+
+    bool HasDeferredCancels() const { return !mDeferredCancels.empty(); }
+
+    // The same without the result, for strategies that override them.
     virtual void SendAmendOrder(unsigned long clientOrderId, unsigned long volume);
     virtual void SendCancelOrder(unsigned long clientOrderId);
     virtual void SendHedgeOrder(unsigned long clientOrderId,
@@ -50,10 +107,39 @@ public:
                                  unsigned long volume,
                                  Lifespan lifespan);
 
+    // Send a hedge or insert with the next client order id from the order
+    // manager and return the id, or return zero if it was not sent. These
+    // go through SendHedgeOrder and SendInsertOrder, so they honour any
+    // override of those.
+    unsigned long HedgeOrder(Side side, unsigned long price, unsigned long volume);
+    unsigned long InsertOrder(Side side, unsigned long price, unsigned long volume, Lifespan lifespan);
+
+    // Every order and hedge sent is tracked by the order manager, which is
+    // updated by each execution message before its handler is called.
+    const OrderManager& GetOrderManager() const { return mOrderManager; }
+
+    const PreTradeLimits& GetPreTradeLimits() const { return mPreTradeLimits; }
+    void SetPreTradeLimits(const PreTradeLimitsConfig& config) { mPreTradeLimits.Configure(config); }
+
+    // The clock, in seconds, for the message frequency limit. By default it
+    // is the steady clock; a backtest replaces it with market time.
+    void SetClock(std::function<double()> clock) { mClock = std::move(clock); }
+
     virtual void SetExecutionConnection(std::unique_ptr<IConnection>&& connection);
     virtual void SetInformationSubscription(std::shared_ptr<ISubscription>&& subscription);
     virtual void SetLoginDetails(std::string teamName, std::string secret);
 
+    // Strategy parameters are set before the auto-trader is connected.
+    virtual void SetParameters(StrategyParameters parameters) { mParameters = std::move(parameters); }
+    const StrategyParameters& GetParameters() const { return mParameters; }
+
+    // Tick-to-trade latency is the time from an order book frame being
+    // received to each message sent from within the handling of it being
+    // written to the socket, so batched messages include the wait for the
+    // batch to be flushed.
+    void WriteTickToTradeStatistics(std::ostream& stream) const;
+    void WritePreTradeStatistics(std::ostream& stream) const { mPreTradeLimits.WriteTo(stream); }
+
 protected:
     boost::asio::io_context& mContext;
     std::unique_ptr<IConnection> mExecutionConnection = nullptr;
@@ -61,15 +147,116 @@ protected:
 
     std::string mTeamName;
     std::string mSecret;
+    StrategyParameters mParameters;
+    OrderManager mOrderManager;
+    PreTradeLimits mPreTradeLimits;
+    std::function<double()> mClock;
+    std::vector<unsigned long> mDeferredCancels;
+    std::string mErrorMessage;
+
+    // The order book message currently being handled, if any, the messages
+    // sent because of an order book that have yet to be written, and the
+    // tick-to-trade latencies for each instrument and send type.
+    struct PendingTickToTrade
+    {
+        Instrument mInstrument;
+        SendType mSendType;
+        ReceiveTime mTriggerTime;
+    };
+    bool mHasTickToTradeTrigger = false;
+    Instrument mTickToTradeInstrument = Instrument::FUTURE;
+    ReceiveTime mTickToTradeTriggerTime;
+    std::array<PendingTickToTrade, MAXIMUM_PENDING_TICK_TO_TRADE> mPendingTickToTrade;
+    std::size_t mPendingTickToTradeCount = 0;
+    std::array<std::array<LatencyHistogram, SEND_TYPE_COUNT>, INSTRUMENT_COUNT> mTickToTrade;
+
+    double GetTime() const;
+    void DeferCancel(unsigned long clientOrderId);
+    void QueueTickToTrade(SendType sendType);
+    void UnqueueTickToTrade();
+    void RecordTickToTrade();
+    void SendDeferredCancels();
+
+    // Bookkeeping around each message, shared by every dispatcher: deferred
+    // cancels go out before any message is handled, and messages sent while
+    // an order book message is handled count towards tick-to-trade.
+    void BeginMessage();
+    void BeginOrderBook(ISubscription* subscription, const OrderBookView& book, ReceiveTime receiveTime);
+    void EndOrderBook() { mHasTickToTradeTrigger = false; }
+
+    // Decode an execution message, update the order manager from it and then
+    // call handle with the decoded ErrorMessage, HedgeFilledMessage,
+    // OrderFilledMessage or OrderStatusMessage. Every execution message
+    // dispatcher goes through this, so they differ only in whose handlers
+    // they call.
+    template<typename Handle>
+    void HandleExecutionMessage(unsigned char messageType,
+                                unsigned char const* data,
+                                std::size_t size,
+                                ReceiveTime receiveTime,
+                                Handle&& handle);
+    [[noreturn]] void UnexpectedExecutionMessage(unsigned char messageType);
 
     virtual void DisconnectHandler();
-    virtual void MessageHandler(IConnection*, unsigned char, unsigned char const*, std::size_t);
+    virtual void FramesDroppedHandler(unsigned long droppedCount) {};
+    virtual void MessageHandler(IConnection*, unsigned char, unsigned char const*, std::size_t, ReceiveTime);
     virtual void MessageHandler(ISubscription* subscription,
                                 unsigned char messageType,
                                 unsigned char const* data,
-                                std::size_t size);
+                                std::size_t size,
+                                ReceiveTime receiveTime);
 
     // Message callbacks
+    //
+    // Order book and trade ticks messages are first passed to the view
+    // overloads, which by default decode the whole message and call the
+    // array overloads. Override the view overloads to read fields on demand.
+    //
+    // Every message is first passed to an overload taking the time it was
+    // received, which by default calls the overload without it. Override the
+    // timestamped overloads to see how old a message is.
+    //
+    // The timestamped error handler is given a view of the message's inline
+    // text; the overload without the time gets a copy in a string reserved
+    // up front, so neither allocates.
+    virtual void ErrorMessageHandler(unsigned long clientOrderId,
+                                     std::string_view errorMessage,
+                                     ReceiveTime receiveTime)
+    {
+        mErrorMessage.assign(errorMessage.data(), errorMessage.size());
+        ErrorMessageHandler(clientOrderId, mErrorMessage);
+    }
+    virtual void HedgeFilledMessageHandler(unsigned long clientOrderId,
+                                           unsigned long price,
+                                           unsigned long volume,
+                                           ReceiveTime receiveTime)
+    {
+        HedgeFilledMessageHandler(clientOrderId, price, volume);
+    }
+    virtual void OrderBookMessageHandler(const OrderBookView& book, ReceiveTime receiveTime)
+    {
+        OrderBookMessageHandler(book);
+    }
+    virtual void OrderFilledMessageHandler(unsigned long clientOrderId,
+                                           unsigned long price,
+                                           unsigned long volume,
+                                           ReceiveTime receiveTime)
+    {
+        OrderFilledMessageHandler(clientOrderId, price, volume);
+    }
+    virtual void OrderStatusMessageHandler(unsigned long clientOrderId,
+                                           unsigned long fillVolume,
+                                           unsigned long remainingVolume,
+                                           signed long fees,
+                                           ReceiveTime receiveTime)
+    {
+        OrderStatusMessageHandler(clientOrderId, fillVolume, remainingVolume, fees);
+    }
+    virtual void TradeTicksMessageHandler(const TradeTicksView& ticks, ReceiveTime receiveTime)
+    {
+        TradeTicksMessageHandler(ticks);
+    }
+
     virtual void ErrorMessageHandler(unsigned long clientOrderId,
                                      const std::string& errorMessage) {};
     virtual void HedgeFilledMessageHandler(unsigned long clientOrderId,
@@ -81,6 +268,10 @@ protected:
                                          const std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
                                          const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
                                          const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes) {};
+    virtual void OrderBookMessageHandler(const OrderBookView& book);
+    // Called just before an order book message that replaces updateCount
+    // conflated updates (only when the subscription is conflating).
+    virtual void OrderBookConflatedHandler(Instrument instrument, unsigned long updateCount) {};
     virtual void OrderFilledMessageHandler(unsigned long clientOrderId,
                                            unsigned long price,
                                            unsigned long volume) {};
@@ -94,8 +285,126 @@ protected:
                                           const std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
                                           const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
                                           const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes) {};
+    virtual void TradeTicksMessageHandler(const TradeTicksView& ticks);
 };
 
+inline void BaseAutoTrader::DeferCancel(unsigned long clientOrderId)
+{
+    if (std::find(mDeferredCancels.begin(), mDeferredCancels.end(), clientOrderId) == mDeferredCancels.end())
+    {
+        mPreTradeLimits.Defer();
+        mDeferredCancels.push_back(clientOrderId);
+    }
+}
+
+// A message's tick-to-trade latency is queued before it is sent, since the
+// connection may write it straight away, and recorded when the connection
+// says it has been written.
+inline void BaseAutoTrader::QueueTickToTrade(SendType sendType)
+{
+    if (mHasTickToTradeTrigger)
+    {
+        if (mPendingTickToTradeCount == mPendingTickToTrade.size())
+        {
+            RecordTickToTrade();
+        }
+        mPendingTickToTrade[mPendingTickToTradeCount++] = {mTickToTradeInstrument, sendType, mTickToTradeTriggerTime};
+    }
+}
+
+// Forget the most recently queued latency, if any, when its message was not
+// sent after all.
+inline void BaseAutoTrader::UnqueueTickToTrade()
+{
+    if (mHasTickToTradeTrigger)
+    {
+        --mPendingTickToTradeCount;
+    }
+}
+
+inline void BaseAutoTrader::RecordTickToTrade()
+{
+    if (mPendingTickToTradeCount == 0)
+    {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i != mPendingTickToTradeCount; ++i)
+    {
+        const auto& pending = mPendingTickToTrade[i];
+        mTickToTrade[static_cast<std::size_t>(pending.mInstrument)][static_cast<std::size_t>(pending.mSendType)].Record(
+            now - pending.mTriggerTime);
+    }
+    mPendingTickToTradeCount = 0;
+}
+
+inline void BaseAutoTrader::BeginMessage()
+{
+    if (!mDeferredCancels.empty())
+    {
+        SendDeferredCancels();
+    }
+}
+
+inline void BaseAutoTrader::BeginOrderBook(ISubscription* subscription,
+                                           const OrderBookView& book,
+                                           ReceiveTime receiveTime)
+{
+    mHasTickToTradeTrigger = static_cast<std::size_t>(book.GetInstrument()) < INSTRUMENT_COUNT;
+    mTickToTradeInstrument = book.GetInstrument();
+    mTickToTradeTriggerTime = receiveTime;
+    if (subscription->GetConflatedCount() > 1)
+    {
+        OrderBookConflatedHandler(book.GetInstrument(), subscription->GetConflatedCount());
+    }
+}
+
+template<typename Handle>
+void BaseAutoTrader::HandleExecutionMessage(unsigned char messageType,
+                                            unsigned char const* data,
+                                            std::size_t size,
+                                            ReceiveTime receiveTime,
+                                            Handle&& handle)
+{
+    BeginMessage();
+
+    switch (messageType)
+    {
+    case MessageType::ERROR_MESSAGE:
+    {
+        auto err = makeMessage<ErrorMessage>(data, size);
+        mOrderManager.ErrorReceived(err.mClientOrderId, receiveTime);
+        handle(err);
+        break;
+    }
+    case MessageType::HEDGE_FILLED:
+    {
+        auto filled = makeMessage<HedgeFilledMessage>(data, size);
+        mOrderManager.HedgeFilled(filled.mClientOrderId, filled.mPrice, filled.mVolume, receiveTime);
+        handle(filled);
+        break;
+    }
+    case MessageType::ORDER_FILLED:
+    {
+        auto filled = makeMessage<OrderFilledMessage>(data, size);
+        mOrderManager.OrderFilled(filled.mClientOrderId, filled.mPrice, filled.mVolume, receiveTime);
+        handle(filled);
+        break;
+    }
+    case MessageType::ORDER_STATUS:
+    {
+        auto status = makeMessage<OrderStatusMessage>(data, size);
+        mOrderManager.OrderStatus(status.mClientOrderId, status.mFillVolume, status.mRemainingVolume,
+                                  status.mFees, receiveTime);
+        handle(status);
+        break;
+    }
+    default:
+        UnexpectedExecutionMessage(messageType);
+    }
+}
+
 inline void BaseAutoTrader::DisconnectHandler()
 {
     mContext.stop();
@@ -105,23 +414,164 @@ inline void BaseAutoTrader::SetInformationSubscription(std::shared_ptr<ISubscrip
 {
     mInformationSubscription = std::move(subscription);
     mInformationSubscription->SetName("Info");
+    mInformationSubscription->Disconnected = [this] { DisconnectHandler(); };
+    mInformationSubscription->FramesDropped = [this](ISubscription*, std::size_t n) { FramesDroppedHandler(n); };
     mInformationSubscription->MessageReceived = [this](ISubscription* s,
                                                        unsigned char t,
                                                        unsigned char const* d,
-                                                       std::size_t z) { MessageHandler(s, t, d, z); };
+                                                       std::size_t z,
+                                                       ReceiveTime r) { MessageHandler(s, t, d, z, r); };
     mInformationSubscription->AsyncReceive();
 }
 
+inline double BaseAutoTrader::GetTime() const
+{
+    return mClock ? mClock()
+                  : std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline bool BaseAutoTrader::TryAmendOrder(unsigned long clientOrderId, unsigned long volume)
+{
+    if (!mPreTradeLimits.CheckAmend(GetTime()))
+    {
+        return false;
+    }
+    QueueTickToTrade(SendType::AMEND);
+    if (!mExecutionConnection->SendMessage(MessageType::AMEND_ORDER,
+                                           AmendMessage{clientOrderId, volume}))
+    {
+        UnqueueTickToTrade();
+        mPreTradeLimits.Reject(PreTradeReason::SEND_BUFFER_FULL);
+        return false;
+    }
+    return true;
+}
+
+inline CancelResult BaseAutoTrader::TryCancelOrder(unsigned long clientOrderId)
+{
+    const double now = GetTime();
+    if (mPreTradeLimits.GetConfig().mIsEnabled && !mPreTradeLimits.IsWithinMessageFrequency(now))
+    {
+        DeferCancel(clientOrderId);
+        return CancelResult::DEFERRED;
+    }
+
+    mPreTradeLimits.CheckCancel(now);
+    QueueTickToTrade(SendType::CANCEL);
+    if (!mExecutionConnection->SendMessage(MessageType::CANCEL_ORDER,
+                                           CancelMessage{clientOrderId}))
+    {
+        UnqueueTickToTrade();
+        mPreTradeLimits.Reject(PreTradeReason::SEND_BUFFER_FULL);
+        DeferCancel(clientOrderId);
+        return CancelResult::DEFERRED;
+    }
+    mOrderManager.CancelSent(clientOrderId);
+    return CancelResult::SENT;
+}
+
+inline bool BaseAutoTrader::TryHedgeOrder(unsigned long clientOrderId,
+                                          Side side,
+                                          unsigned long price,
+                                          unsigned long volume)
+{
+    // An order the order manager can't track would leave the positions and
+    // the pre-trade checks wrong, so it is not sent.
+    if (!mOrderManager.CanAdd(clientOrderId))
+    {
+        mPreTradeLimits.Reject(PreTradeReason::ORDER_MANAGER_FULL);
+        return false;
+    }
+    if (!mPreTradeLimits.CheckHedge(mOrderManager, side, volume, GetTime()))
+    {
+        return false;
+    }
+    QueueTickToTrade(SendType::HEDGE);
+    if (!mExecutionConnection->SendMessage(MessageType::HEDGE_ORDER,
+                                           HedgeMessage{clientOrderId,
+                                                        side,
+                                                        price,
+                                                        volume}))
+    {
+        UnqueueTickToTrade();
+        mPreTradeLimits.Reject(PreTradeReason::SEND_BUFFER_FULL);
+        return false;
+    }
+    mOrderManager.Add(clientOrderId, Instrument::FUTURE, side, price, volume, Lifespan::FILL_AND_KILL,
+                      std::chrono::steady_clock::now());
+    return true;
+}
+
+// The order manager only knows a new client order id once its order has
+// been sent.
+inline unsigned long BaseAutoTrader::HedgeOrder(Side side, unsigned long price, unsigned long volume)
+{
+    const unsigned long clientOrderId = mOrderManager.NextClientOrderId();
+    if (clientOrderId == 0)
+    {
+        mPreTradeLimits.Reject(PreTradeReason::ORDER_MANAGER_FULL);
+        return 0;
+    }
+    SendHedgeOrder(clientOrderId, side, price, volume);
+    return mOrderManager.Find(clientOrderId) ? clientOrderId : 0;
+}
+
+inline bool BaseAutoTrader::TryInsertOrder(unsigned long clientOrderId,
+                                           Side side,
+                                           unsigned long price,
+                                           unsigned long volume,
+                                           Lifespan lifespan)
+{
+    // An order the order manager can't track would leave the positions and
+    // the pre-trade checks wrong, so it is not sent.
+    if (!mOrderManager.CanAdd(clientOrderId))
+    {
+        mPreTradeLimits.Reject(PreTradeReason::ORDER_MANAGER_FULL);
+        return false;
+    }
+    if (!mPreTradeLimits.CheckInsert(mOrderManager, side, volume, GetTime()))
+    {
+        return false;
+    }
+    QueueTickToTrade(SendType::INSERT);
+    if (!mExecutionConnection->SendMessage(MessageType::INSERT_ORDER,
+                                           InsertMessage{clientOrderId,
+                                                         side,
+                                                         price,
+                                                         volume,
+                                                         lifespan}))
+    {
+        UnqueueTickToTrade();
+        mPreTradeLimits.Reject(PreTradeReason::SEND_BUFFER_FULL);
+        return false;
+    }
+    mOrderManager.Add(clientOrderId, Instrument::ETF, side, price, volume, lifespan, std::chrono::steady_clock::now());
+    return true;
+}
+
+inline unsigned long BaseAutoTrader::InsertOrder(Side side,
+                                                 unsigned long price,
+                                                 unsigned long volume,
+                                                 Lifespan lifespan)
+{
+    const unsigned long clientOrderId = mOrderManager.NextClientOrderId();
+    if (clientOrderId == 0)
+    {
+        mPreTradeLimits.Reject(PreTradeReason::ORDER_MANAGER_FULL);
+        return 0;
+    }
+    SendInsertOrder(clientOrderId, side, price, volume, lifespan);
+    return mOrderManager.Find(clientOrderId) ? clientOrderId : 0;
+}
+
 inline void BaseAutoTrader::SendAmendOrder(unsigned long clientOrderId, unsigned long volume)
 {
-    mExecutionConnection->SendMessage(MessageType::AMEND_ORDER,
-                                      AmendMessage{clientOrderId, volume});
+    TryAmendOrder(clientOrderId, volume);
 }
 
 inline void BaseAutoTrader::SendCancelOrder(unsigned long clientOrderId)
 {
-    mExecutionConnection->SendMessage(MessageType::CANCEL_ORDER,
-                                      CancelMessage{clientOrderId});
+    TryCancelOrder(clientOrderId);
 }
 
 inline void BaseAutoTrader::SendHedgeOrder(unsigned long clientOrderId,
@@ -129,11 +579,7 @@ inline void BaseAutoTrader::SendHedgeOrder(unsigned long clientOrderId,
                                            unsigned long price,
                                            unsigned long volume)
 {
-    mExecutionConnection->SendMessage(MessageType::HEDGE_ORDER,
-                                      HedgeMessage{clientOrderId,
-                                                   side,
-                                                   price,
-                                                   volume});
+    TryHedgeOrder(clientOrderId, side, price, volume);
 }
 
 inline void BaseAutoTrader::SendInsertOrder(unsigned long clientOrderId,
@@ -142,12 +588,7 @@ inline void BaseAutoTrader::SendInsertOrder(unsigned long clientOrderId,
                                             unsigned long volume,
                                             Lifespan lifespan)
 {
-    mExecutionConnection->SendMessage(MessageType::INSERT_ORDER,
-                                      InsertMessage{clientOrderId,
-                                                    side,
-                                                    price,
-                                                    volume,
-                                                    lifespan});
+    TryInsertOrder(clientOrderId, side, price, volume, lifespan);
 }
 
 inline void BaseAutoTrader::SetLoginDetails(std::string teamName, std::string secret)
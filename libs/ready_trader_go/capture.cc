@@ -0,0 +1,124 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+#include <boost/endian/conversion.hpp>
+
+#include "capture.h"
+#include "connectivity.h"
+#include "error.h"
+#include "logging.h"
+
+RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_CAP, "CAPTURE")
+
+namespace ReadyTraderGo {
+
+CaptureWriter::CaptureWriter(const std::string& filename)
+    : mFilename(filename), mStream(filename, std::ios::binary | std::ios::app)
+{
+    if (!mStream)
+    {
+        throw ReadyTraderGoError("failed to open capture file '" + mFilename + "'");
+    }
+
+    mStream.seekp(0, std::ios::end);
+    if (mStream.tellp() == 0)
+    {
+        mStream.write(CAPTURE_FILE_MAGIC, CAPTURE_FILE_MAGIC_SIZE);
+    }
+
+    RLOG(LG_CAP, LogLevel::LL_INFO) << "capturing information messages to '" << mFilename << "'";
+}
+
+CaptureWriter::~CaptureWriter()
+{
+    mStream.flush();
+    RLOG(LG_CAP, LogLevel::LL_INFO) << "captured " << mRecordCount << " messages to '" << mFilename << "'";
+}
+
+void CaptureWriter::Write(std::chrono::system_clock::time_point receiveTime,
+                          unsigned char const* data,
+                          std::size_t size)
+{
+    const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(receiveTime.time_since_epoch());
+    const uint64_t timestamp = boost::endian::native_to_big(static_cast<uint64_t>(nanoseconds.count()));
+    mStream.write(reinterpret_cast<char const*>(&timestamp), sizeof(timestamp));
+    mStream.write(reinterpret_cast<char const*>(data), size);
+    ++mRecordCount;
+}
+
+CaptureReader::CaptureReader(const std::string& filename) : mFilename(filename)
+{
+    std::ifstream stream(filename, std::ios::binary);
+    if (!stream)
+    {
+        throw ReadyTraderGoError("failed to open capture file '" + mFilename + "'");
+    }
+
+    mBuffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    if (mBuffer.size() < CAPTURE_FILE_MAGIC_SIZE
+        || std::memcmp(mBuffer.data(), CAPTURE_FILE_MAGIC, CAPTURE_FILE_MAGIC_SIZE) != 0)
+    {
+        throw ReadyTraderGoError("'" + mFilename + "' is not a capture file");
+    }
+}
+
+bool CaptureReader::Next(CaptureRecord& record)
+{
+    const std::size_t available = mBuffer.size() - mPosition;
+    if (available == 0)
+    {
+        return false;
+    }
+
+    if (available < CAPTURE_RECORD_HEADER_SIZE + MESSAGE_HEADER_SIZE)
+    {
+        RLOG(LG_CAP, LogLevel::LL_WARNING) << "capture file '" << mFilename << "' ends with a truncated record";
+        mPosition = mBuffer.size();
+        return false;
+    }
+
+    unsigned char const* data = mBuffer.data() + mPosition;
+
+    uint64_t timestamp;
+    std::memcpy(&timestamp, data, sizeof(timestamp));
+    uint16_t messageLength;
+    std::memcpy(&messageLength, data + CAPTURE_RECORD_HEADER_SIZE, sizeof(messageLength));
+    messageLength = boost::endian::big_to_native(messageLength);
+
+    if (messageLength < MESSAGE_HEADER_SIZE || available < CAPTURE_RECORD_HEADER_SIZE + messageLength)
+    {
+        RLOG(LG_CAP, LogLevel::LL_WARNING) << "capture file '" << mFilename << "' ends with a truncated record";
+        mPosition = mBuffer.size();
+        return false;
+    }
+
+    record.mReceiveTime = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(boost::endian::big_to_native(timestamp))));
+    record.mData = data + CAPTURE_RECORD_HEADER_SIZE;
+    record.mSize = messageLength;
+
+    mPosition += CAPTURE_RECORD_HEADER_SIZE + messageLength;
+    ++mRecordCount;
+    return true;
+}
+
+}
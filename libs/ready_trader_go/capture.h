@@ -0,0 +1,86 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_CAPTURE_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_CAPTURE_H
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ReadyTraderGo {
+
+// A capture file begins with an eight-byte magic string followed by any
+// number of records. Each record is:
+//   1. receive time - an eight-byte, big endian, unsigned integer giving the
+//      number of nanoseconds since the Unix epoch at which the message was
+//      received; and
+//   2. message - a complete information message, beginning with its header
+//      (so the message's own length field gives the size of the record).
+constexpr char CAPTURE_FILE_MAGIC[] = "RTGCAP01";
+constexpr std::size_t CAPTURE_FILE_MAGIC_SIZE = sizeof(CAPTURE_FILE_MAGIC) - 1;
+constexpr std::size_t CAPTURE_RECORD_HEADER_SIZE = 8;
+
+struct CaptureRecord
+{
+    std::chrono::system_clock::time_point mReceiveTime;
+    unsigned char const* mData = nullptr;
+    std::size_t mSize = 0;
+};
+
+// Appends records to a capture file, creating it if necessary.
+class CaptureWriter
+{
+public:
+    explicit CaptureWriter(const std::string& filename);
+    ~CaptureWriter();
+
+    void Write(std::chrono::system_clock::time_point receiveTime, unsigned char const* data, std::size_t size);
+
+    unsigned long GetRecordCount() const { return mRecordCount; }
+
+private:
+    std::string mFilename;
+    std::ofstream mStream;
+    unsigned long mRecordCount = 0;
+};
+
+// Reads the whole of a capture file into memory and hands out its records
+// in order.
+class CaptureReader
+{
+public:
+    explicit CaptureReader(const std::string& filename);
+
+    // Fetch the next record, returning false at the end of the capture. The
+    // record's data remains valid for the lifetime of the reader.
+    bool Next(CaptureRecord& record);
+
+    unsigned long GetRecordCount() const { return mRecordCount; }
+
+private:
+    std::string mFilename;
+    std::vector<unsigned char> mBuffer;
+    std::size_t mPosition = CAPTURE_FILE_MAGIC_SIZE;
+    unsigned long mRecordCount = 0;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_CAPTURE_H
@@ -18,34 +18,102 @@
 #ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_CONFIG_H
 #define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_CONFIG_H
 
+#include <cstddef>
 #include <string>
 
 #include <boost/property_tree/ptree.hpp>
 
+#include "error.h"
+#include "pretradelimits.h"
+#include "strategyparameters.h"
+#include "waitstrategy.h"
+
 namespace ReadyTraderGo {
 
 struct Config
 {
     void readFromPropertyTree(const boost::property_tree::ptree& tree)
     {
-        mExecHost = tree.get<std::string>("Execution.Host");
-        mExecPort = tree.get<unsigned short>("Execution.Port");
+        mExecType = tree.get<std::string>("Execution.Type", "tcp");
+        if (mExecType != "null")
+        {
+            mExecHost = tree.get<std::string>("Execution.Host");
+            mExecPort = tree.get<unsigned short>("Execution.Port");
+        }
+        mExecReceiveBufferSize = tree.get<std::size_t>("Execution.ReceiveBufferSize", 65536);
+        mExecSendBufferSize = tree.get<std::size_t>("Execution.SendBufferSize", 65536);
+        mExecBusyPoll = tree.get<bool>("Execution.BusyPoll", false);
+        mExecSocketBusyPoll = tree.get<int>("Execution.SocketBusyPollMicroseconds", 0);
+        mExecReceiveTimestamps = tree.get<bool>("Execution.ReceiveTimestamps", true);
 
         mInfoType = tree.get<std::string>("Information.Type");
         mInfoName = tree.get<std::string>("Information.Name");
+        mInfoBusyPoll = tree.get<bool>("Information.BusyPoll", false);
+        mInfoConflate = tree.get<bool>("Information.Conflate", false);
+        mInfoWaitPolicy = tree.get<std::string>("Information.WaitPolicy", "spin");
+        mInfoSpinCount = tree.get<unsigned long>("Information.SpinCount", 1000);
+        mInfoMinimumSleep = tree.get<unsigned long>("Information.MinimumSleepMicroseconds", 1);
+        mInfoMaximumSleep = tree.get<unsigned long>("Information.MaximumSleepMicroseconds", 1000);
+        // A zero minimum would never double into a sleep, leaving a spin.
+        if (parseWaitPolicy(mInfoWaitPolicy) == WaitPolicy::SLEEP
+            && (mInfoMinimumSleep == 0 || mInfoMinimumSleep > mInfoMaximumSleep))
+        {
+            throw ReadyTraderGoError("the sleep wait policy needs 0 < Information.MinimumSleepMicroseconds <= "
+                                     "Information.MaximumSleepMicroseconds");
+        }
+        mInfoHugePages = tree.get<bool>("Information.HugePages", false);
+        mInfoPrefault = tree.get<bool>("Information.Prefault", false);
+        mInfoLock = tree.get<bool>("Information.Lock", false);
+        mInfoCaptureFile = tree.get<std::string>("Information.CaptureFile", "");
+        mInfoReplaySpeed = tree.get<double>("Information.ReplaySpeed", 0.0);
+
+        mBusyPollCpu = tree.get<int>("BusyPollCpu", -1);
+        mLatencyFile = tree.get<std::string>("LatencyFile", "");
 
         mTeamName = tree.get<std::string>("TeamName");
         mSecret = tree.get<std::string>("Secret");
+
+        if (auto limits = tree.get_child_optional("Limits"))
+        {
+            mPreTradeLimits.readFromPropertyTree(*limits);
+        }
+        if (auto parameters = tree.get_child_optional("Parameters"))
+        {
+            mParameters.readFromPropertyTree(*parameters);
+        }
     }
 
+    std::string mExecType;
     std::string mExecHost;
-    unsigned short mExecPort;
+    unsigned short mExecPort = 0;
+    std::size_t mExecReceiveBufferSize = 0;
+    std::size_t mExecSendBufferSize = 0;
+    bool mExecBusyPoll = false;
+    int mExecSocketBusyPoll = 0;
+    bool mExecReceiveTimestamps = true;
 
     std::string mInfoType;
     std::string mInfoName;
+    bool mInfoBusyPoll = false;
+    bool mInfoConflate = false;
+    std::string mInfoWaitPolicy;
+    unsigned long mInfoSpinCount = 0;
+    unsigned long mInfoMinimumSleep = 0;
+    unsigned long mInfoMaximumSleep = 0;
+    bool mInfoHugePages = false;
+    bool mInfoPrefault = false;
+    bool mInfoLock = false;
+    std::string mInfoCaptureFile;
+    double mInfoReplaySpeed = 0.0;
+
+    int mBusyPollCpu = -1;
+    std::string mLatencyFile;
 
     std::string mTeamName;
     std::string mSecret;
+
+    PreTradeLimitsConfig mPreTradeLimits;
+    StrategyParameters mParameters;
 };
 
 }
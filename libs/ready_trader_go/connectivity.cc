@@ -15,25 +15,40 @@
 //     You should have received a copy of the GNU Affero General Public
 //     License along with Ready Trader Go.  If not, see
 //     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstring>
 #include <iomanip>
 #include <memory>
 #include <string>
 #include <vector>
 
+#ifdef __unix__
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#endif
+
+#include <boost/asio/buffer.hpp>
 #include <boost/asio/connect.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/error.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/post.hpp>
 #include <boost/endian/conversion.hpp>
+#include <boost/interprocess/exceptions.hpp>
 #include <boost/interprocess/file_mapping.hpp>
 #include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
 #include <boost/system/error_code.hpp>
 
 #include "connectivity.h"
 #include "error.h"
 #include "logging.h"
+#include "protocol.h"
 
 namespace error = boost::asio::error;
 namespace interprocess = boost::interprocess;
@@ -44,21 +59,78 @@ RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_CON, "CON")
 
 namespace ReadyTraderGo {
 
-// Theoretical maximum size of an (IPv4) UDP packet (actual maximum is lower).
-constexpr std::size_t READ_SIZE = 65535;
+constexpr std::size_t FRAME_POSITION_MASK = SUBSCRIPTION_TRANSPORT_BUFFER_SIZE - 1;
+
+// The smallest mapping that transparent huge pages can back (on x86-64).
+constexpr std::size_t TRANSPARENT_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+#ifdef SO_TIMESTAMPNS
+// Kernel timestamps are on the real-time clock, so they are moved onto the
+// steady clock using how long ago they were.
+static ReceiveTime fromRealTime(const timespec& ts, ReceiveTime steadyNow)
+{
+    const auto kernelTime = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)));
+    const auto age = std::chrono::system_clock::now() - kernelTime;
+    return (age.count() > 0) ? steadyNow - std::chrono::duration_cast<ReceiveTime::duration>(age) : steadyNow;
+}
+#endif
+
+// The publisher writes a frame's payload before setting the frame's flag, so
+// the flag is read with acquire semantics to stop the payload reads being
+// hoisted above it.
+static inline unsigned char loadFrameFlag(unsigned char const* frame)
+{
+    const unsigned char flag = *static_cast<volatile unsigned char const*>(frame);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return flag;
+}
+
+// The second read of a frame's flag, after its payload has been copied. The
+// fence comes first this time: it stops the payload reads being delayed
+// until after the flag is read, which a weakly ordered CPU (such as ARM)
+// would otherwise allow, letting a frame overwritten during the copy pass
+// as intact.
+static inline unsigned char recheckFrameFlag(unsigned char const* frame)
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return *static_cast<volatile unsigned char const*>(frame);
+}
 
-Connection::Connection(boost::asio::io_context& context, tcp::socket&& socket)
+Connection::Connection(boost::asio::io_context& context,
+                       tcp::socket&& socket,
+                       const ConnectionOptions& options)
     : mContext(context),
-      mInBuffer(),
-      mOutBuffer(),
+      mInBuffer(options.mReceiveBufferSize),
+      mOutBuffer(options.mSendBufferSize),
+      mBusyPoll(options.mBusyPoll),
+      mReceiveTimestamps(options.mReceiveTimestamps),
       mSocket(std::move(socket))
 {
     SetName('\'' + std::to_string(mSocket.local_endpoint().port()) + '\'');
+
+#ifdef SO_TIMESTAMPNS
+    const int enable = 1;
+    if (mReceiveTimestamps
+        && setsockopt(mSocket.native_handle(), SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) != 0)
+    {
+        RLOG(LG_CON, LogLevel::LL_WARNING) << std::quoted(mName, '\'') << " failed to enable receive timestamps: "
+                                           << std::strerror(errno);
+        mReceiveTimestamps = false;
+    }
+#else
+    mReceiveTimestamps = false;
+#endif
 }
 
 Connection::~Connection()
 {
-    RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " closing";
+    RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " closing: messages_sent="
+                                    << mStatistics.mMessagesSent << " writes=" << mStatistics.mWrites
+                                    << " batches=" << mStatistics.mBatches << " batch_size_avg="
+                                    << ((mStatistics.mBatches != 0) ? static_cast<double>(mStatistics.mBatchedMessages) / mStatistics.mBatches : 0.0)
+                                    << " batch_size_max=" << mStatistics.mMaximumBatchSize;
     if (mSocket.is_open())
     {
         mSocket.close();
@@ -67,47 +139,216 @@ Connection::~Connection()
 
 void Connection::AsyncRead()
 {
-    auto buf = mInBuffer.prepare(READ_SIZE);
-    mSocket.async_read_some(
-        buf,
-        [this](auto& error, auto size) { ReadSomeHandler(error, size); });
+    mIsReading = true;
+
+    if (mBusyPoll)
+    {
+        RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " busy polling";
+        return;
+    }
+
+    // The read itself is done by Receive() once the socket is readable, so
+    // that the kernel's receive timestamp can be collected with the data.
+    if (PrepareRead())
+    {
+        mSocket.async_wait(tcp::socket::wait_read, [this](auto& error) { ReadReadyHandler(error); });
+    }
 }
 
-void Connection::ReadSomeHandler(const boost::system::error_code& error, std::size_t size)
+void Connection::Close()
 {
+    if (mIsClosing)
+    {
+        return;
+    }
+
+    RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " closing connection";
+    mIsClosing = true;
+    mIsReading = false;
+
+    // Anything already queued (even part way through a batch) is written
+    // before the socket is closed.
+    if (mIsSending)
+    {
+        return;
+    }
+    if (mOutBuffer.ReadSize() != 0)
+    {
+        Send();
+        return;
+    }
+    Shutdown();
+}
+
+void Connection::Shutdown()
+{
+    boost::system::error_code error;
+    mSocket.shutdown(tcp::socket::shutdown_both, error);
+    mSocket.close(error);
+}
+
+std::size_t Connection::Poll()
+{
+    if (!mBusyPoll || !mIsReading || !PrepareRead())
+    {
+        return 0;
+    }
+
+    boost::system::error_code error;
+    ReceiveTime receiveTime;
+    const std::size_t size = Receive(error, receiveTime);
     if (error)
     {
-        if (error == error::eof)
+        if (error == error::interrupted || error == error::try_again || error == error::would_block)
         {
-            RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " remote disconnect";
+            return 0;
         }
-        else if (error == error::interrupted || error == error::try_again || error == error::would_block)
+        ReadErrorHandler(error);
+        return 0;
+    }
+
+    return ProcessInput(size, receiveTime);
+}
+
+std::size_t Connection::Receive(boost::system::error_code& error, ReceiveTime& receiveTime)
+{
+#ifdef SO_TIMESTAMPNS
+    if (mReceiveTimestamps)
+    {
+        iovec iov{mInBuffer.WriteData(), mInBuffer.WriteSize()};
+        alignas(cmsghdr) unsigned char control[CMSG_SPACE(sizeof(timespec))];
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        const ssize_t result = recvmsg(mSocket.native_handle(), &msg, 0);
+        receiveTime = std::chrono::steady_clock::now();
+        if (result < 0)
         {
-            RLOG(LG_CON, LogLevel::LL_DEBUG) << std::quoted(mName, '\'') << " read interrupted: "
-                                             << error.message();
-            AsyncRead();
-            return;
+            error = boost::system::error_code(errno, boost::asio::error::get_system_category());
+            return 0;
         }
-        else
+        if (result == 0)
         {
-            RLOG(LG_CON, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " read error: "
-                                             << error.message();
+            error = error::eof;
+            return 0;
+        }
+
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS)
+            {
+                timespec ts;
+                std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                receiveTime = fromRealTime(ts, receiveTime);
+            }
         }
+
+        error.clear();
+        return static_cast<std::size_t>(result);
+    }
+#endif
+
+    const std::size_t size = mSocket.read_some(boost::asio::buffer(mInBuffer.WriteData(), mInBuffer.WriteSize()),
+                                               error);
+    receiveTime = std::chrono::steady_clock::now();
+    return size;
+}
+
+bool Connection::PrepareRead()
+{
+    // Any partial message left over from the last read is moved to the
+    // front so that the rest of it can be read in behind it.
+    mInBuffer.Compact();
+    if (mInBuffer.WriteSize() == 0)
+    {
+        RLOG(LG_CON, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " receive buffer of "
+                                         << mInBuffer.GetCapacity() << " bytes is too small for message";
+        mIsReading = false;
         OnDisconnect();
+        return false;
+    }
+    return true;
+}
+
+void Connection::ReadErrorHandler(const boost::system::error_code& error)
+{
+    if (error == error::eof)
+    {
+        RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " remote disconnect";
+    }
+    else
+    {
+        RLOG(LG_CON, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " read error: "
+                                         << error.message();
+    }
+    mIsReading = false;
+    OnDisconnect();
+}
+
+void Connection::ReadReadyHandler(const boost::system::error_code& error)
+{
+    if (mIsClosing)
+    {
         return;
     }
 
+    if (error)
+    {
+        ReadErrorHandler(error);
+        return;
+    }
+
+    boost::system::error_code readError;
+    ReceiveTime receiveTime;
+    const std::size_t size = Receive(readError, receiveTime);
+    if (readError)
+    {
+        if (readError == error::interrupted || readError == error::try_again || readError == error::would_block)
+        {
+            RLOG(LG_CON, LogLevel::LL_DEBUG) << std::quoted(mName, '\'') << " read interrupted: "
+                                             << readError.message();
+            AsyncRead();
+            return;
+        }
+        ReadErrorHandler(readError);
+        return;
+    }
+
+    ProcessInput(size, receiveTime);
+    if (mIsReading)
+    {
+        AsyncRead();
+    }
+}
+
+std::size_t Connection::ProcessInput(std::size_t size, ReceiveTime receiveTime)
+{
     RLOG(LG_CON, LogLevel::LL_DEBUG) << std::quoted(mName, '\'') << " received " << size
                                      << " bytes";
-    mInBuffer.commit(size);
+    mInBuffer.Commit(size);
 
-    auto* const begin = (unsigned char const*) mInBuffer.data().data();
-    auto* upto = begin;
-    auto available = size;
+    auto* upto = mInBuffer.ReadData();
+    auto available = mInBuffer.ReadSize();
+    std::size_t count = 0;
 
-    while (available >= MESSAGE_HEADER_SIZE)
+    // A message handler may close the connection, in which case nothing
+    // more is delivered.
+    while (mIsReading && available >= MESSAGE_HEADER_SIZE)
     {
-        const std::size_t messageLength = boost::endian::big_to_native(*(uint16_t*)upto);
+        uint16_t messageLength;
+        std::memcpy(&messageLength, upto, sizeof(messageLength));
+        messageLength = boost::endian::big_to_native(messageLength);
+        if (messageLength < MESSAGE_HEADER_SIZE)
+        {
+            RLOG(LG_CON, LogLevel::LL_ERROR) << std::quoted(mName, '\'') << " received malformed message with size="
+                                             << messageLength;
+            mIsReading = false;
+            OnDisconnect();
+            return count;
+        }
         if (available < messageLength)
             break;
 
@@ -115,21 +356,50 @@ void Connection::ReadSomeHandler(const boost::system::error_code& error, std::si
         RLOG(LG_CON, LogLevel::LL_DEBUG) << std::quoted(mName, '\'')
                                          << " received message with type=" << static_cast<int>(messageType)
                                          << " and size=" << messageLength;
-        OnMessageReceipt(messageType, upto + MESSAGE_HEADER_SIZE, messageLength - MESSAGE_HEADER_SIZE);
+        OnMessageReceipt(messageType, upto + MESSAGE_HEADER_SIZE, messageLength - MESSAGE_HEADER_SIZE, receiveTime);
+        ++count;
 
         upto += messageLength;
         available -= messageLength;
     }
 
-    mInBuffer.consume(upto - begin);
-    AsyncRead();
+    mInBuffer.Consume(mInBuffer.ReadSize() - available);
+    return count;
+}
+
+void Connection::BeginBatch()
+{
+    ++mBatchDepth;
+}
+
+void Connection::Flush()
+{
+    if (mBatchDepth == 0 || --mBatchDepth != 0)
+    {
+        return;
+    }
+
+    if (mBatchSize != 0)
+    {
+        ++mStatistics.mBatches;
+        mStatistics.mBatchedMessages += mBatchSize;
+        mStatistics.mMaximumBatchSize = std::max(mStatistics.mMaximumBatchSize, mBatchSize);
+        mBatchSize = 0;
+    }
+
+    if (!mIsSending && !mIsClosing && mOutBuffer.ReadSize() > 0)
+    {
+        Send();
+    }
 }
 
 void Connection::Send()
 {
     mIsSending = true;
-    mSocket.async_write_some(mOutBuffer.data(),
+    ++mStatistics.mWrites;
+    mSocket.async_write_some(boost::asio::buffer(mOutBuffer.ReadData(), mOutBuffer.ReadSize()),
                              [this](auto& err, auto sz) { WriteSomeHandler(err, sz); });
+    OnMessagesWritten();
 }
 
 void Connection::Send(SendMode mode)
@@ -142,7 +412,7 @@ void Connection::Send(SendMode mode)
     {
         boost::asio::post(mContext, [this] {
             mIsSendPosted = false;
-            if (!mIsSending)
+            if (!mIsSending && !mIsClosing && mBatchDepth == 0)
             {
                 Send();
             }
@@ -151,23 +421,67 @@ void Connection::Send(SendMode mode)
     }
 }
 
-void Connection::SendMessage(unsigned char messageType, const ISerialisable& serialisable, SendMode mode)
+bool Connection::SendMessage(unsigned char messageType, const ISerialisable& serialisable, SendMode mode)
 {
+    if (mIsClosing)
+    {
+        return false;
+    }
+
     const std::size_t size = MESSAGE_HEADER_SIZE + serialisable.Size();
-    auto buf = mOutBuffer.prepare(size);
-    auto* data = static_cast<unsigned char*>(buf.data());
-    *(uint16_t*)data = boost::endian::native_to_big((uint16_t)size);
+    if (mOutBuffer.WriteSize() < size && !mIsSending)
+    {
+        // Unsent data can only be moved when no write is using it.
+        mOutBuffer.Compact();
+    }
+    if (mOutBuffer.WriteSize() < size)
+    {
+        // The other end has stopped reading (or the buffer is too small for
+        // the traffic); the caller decides what to do with the message.
+        RLOG(LG_CON, LogLevel::LL_WARNING) << std::quoted(mName, '\'') << " send buffer of "
+                                           << mOutBuffer.GetCapacity() << " bytes is full";
+        return false;
+    }
+
+    auto* data = mOutBuffer.WriteData();
+    const uint16_t length = boost::endian::native_to_big((uint16_t)size);
+    std::memcpy(data, &length, sizeof(length));
     data[MESSAGE_TYPE_OFFSET] = messageType;
     serialisable.Serialise(data + MESSAGE_HEADER_SIZE);
-    mOutBuffer.commit(size);
-    if (!mIsSending)
+    mOutBuffer.Commit(size);
+    ++mStatistics.mMessagesSent;
+
+    if (mBatchDepth != 0)
+    {
+        ++mBatchSize;
+    }
+    else if (!mIsSending)
     {
         Send(mode);
     }
+    return true;
 }
 
 void Connection::WriteSomeHandler(const boost::system::error_code& error, std::size_t size)
 {
+    if (error == error::broken_pipe || error == error::connection_reset)
+    {
+        // The other end has gone away, which is reported the same way as a
+        // disconnect seen by a read.
+        RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " remote disconnect during send: "
+                                        << error.message();
+        mOutBuffer.Consume(mOutBuffer.ReadSize());
+        mIsSending = false;
+        Shutdown();
+        if (!mIsClosing)
+        {
+            mIsClosing = true;
+            mIsReading = false;
+            OnDisconnect();
+        }
+        return;
+    }
+
     if (error)
     {
         if (error != error::interrupted && error != error::would_block && error != error::try_again)
@@ -183,38 +497,94 @@ void Connection::WriteSomeHandler(const boost::system::error_code& error, std::s
     {
         RLOG(LG_CON, LogLevel::LL_DEBUG) << std::quoted(mName, '\'') << " sent "
                                          << size << " bytes";
-        mOutBuffer.consume(size);
+        mOutBuffer.Consume(size);
     }
 
-    if (mOutBuffer.size() > 0)
+    if (mOutBuffer.ReadSize() > 0)
     {
-        mSocket.async_write_some(
-            mOutBuffer.data(), [this](auto& err, auto sz) { WriteSomeHandler(err, sz); });
+        mOutBuffer.Compact();
+        ++mStatistics.mWrites;
+        mSocket.async_write_some(boost::asio::buffer(mOutBuffer.ReadData(), mOutBuffer.ReadSize()),
+                                 [this](auto& err, auto sz) { WriteSomeHandler(err, sz); });
+        OnMessagesWritten();
     }
     else
     {
         mIsSending = false;
+        if (mIsClosing)
+        {
+            Shutdown();
+        }
     }
 }
 
-Subscription::Subscription(boost::asio::io_context& context, interprocess::file_mapping& file, interprocess::mapped_region& region)
-    : mContext(context), mFile(std::move(file)), mRegion(std::move(region))
+NullConnection::NullConnection()
+{
+    SetName("'null'");
+}
+
+NullConnection::~NullConnection()
+{
+    RLOG(LG_CON, LogLevel::LL_INFO) << mName << " closing: discarded " << mMessageCount << " messages";
+}
+
+bool NullConnection::SendMessage(unsigned char messageType, const ISerialisable& serialisable, SendMode mode)
+{
+    RLOG(LG_CON, LogLevel::LL_DEBUG) << mName << " discarding message with type=" << static_cast<int>(messageType)
+                                     << " and size=" << MESSAGE_HEADER_SIZE + serialisable.Size();
+    ++mMessageCount;
+    OnMessagesWritten();
+    return true;
+}
+
+Subscription::Subscription(boost::asio::io_context& context,
+                           const std::string& name,
+                           interprocess::mapped_region& region,
+                           const SubscriptionOptions& options)
+    : mContext(context),
+      mTimer(context),
+      mRegion(std::move(region)),
+      mBuffer(static_cast<unsigned char const*>(mRegion.get_address())),
+      mBusyPoll(options.mBusyPoll),
+      mConflate(options.mConflate),
+      mWaitStrategy(options.mWaitStrategy)
 {
-    SetName(std::string(mFile.get_name()));
+    SetName(name);
+    if (!options.mCaptureFile.empty())
+    {
+        mCapture = std::make_unique<CaptureWriter>(options.mCaptureFile);
+    }
 }
 
 Subscription::~Subscription()
 {
-    RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " closing";
+    RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " closing: received="
+                                    << mStatistics.mFramesReceived << " dropped="
+                                    << mStatistics.mFramesDropped << " torn="
+                                    << mStatistics.mTornFrames << " stale="
+                                    << mStatistics.mStaleFrames << " resyncs="
+                                    << mStatistics.mResyncs << " conflated="
+                                    << mStatistics.mBooksConflated;
+    if (!mBusyPoll)
+    {
+        RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " wait statistics: "
+                                        << mWaitStrategy.GetStatistics();
+    }
 }
 
 void Subscription::AsyncReceive()
 {
+    if (mBusyPoll)
+    {
+        RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " busy polling";
+        return;
+    }
+
     std::weak_ptr<ISubscription> weak_this = shared_from_this();
-    mContext.post([this, weak_this](){ AsyncReceive(0, weak_this); });
+    mContext.post([this, weak_this](){ AsyncReceive(weak_this); });
 }
 
-void Subscription::AsyncReceive(unsigned long pos, std::weak_ptr<ISubscription> weak_this)
+void Subscription::AsyncReceive(std::weak_ptr<ISubscription> weak_this)
 {
     if (weak_this.expired())
     {
@@ -222,20 +592,197 @@ void Subscription::AsyncReceive(unsigned long pos, std::weak_ptr<ISubscription>
         return;
     }
 
-    unsigned char* addr = ((unsigned char*)mRegion.get_address()) + pos;
+    if (Poll() != 0)
+    {
+        mWaitStrategy.Busy();
+    }
+    else if (auto delay = mWaitStrategy.Idle(); delay.count() != 0)
+    {
+        mTimer.expires_after(delay);
+        mTimer.async_wait([this, weak_this](const boost::system::error_code& error) {
+            if (!error)
+            {
+                AsyncReceive(weak_this);
+            }
+        });
+        return;
+    }
+
+    mContext.post([this, weak_this](){ AsyncReceive(weak_this); });
+}
+
+std::size_t Subscription::Poll()
+{
+    if (mConflate)
+    {
+        return Drain();
+    }
+
+    const std::size_t size = ReadFrame();
+    if (size == 0)
+    {
+        return 0;
+    }
 
-    if (addr[0] != 0)
+    ReceiveFromHandler(mFrame.data(), size, mFrameReceiveTime);
+    return 1;
+}
+
+std::size_t Subscription::Drain()
+{
+    std::size_t delivered = 0;
+
+    // Trade ticks are delivered as they are read, but only the most recent
+    // order book for each instrument is kept and delivered at the end.
+    for (std::size_t i = 0; i != SUBSCRIPTION_TRANSPORT_FRAME_COUNT; ++i)
     {
-        const uint32_t* payload_size_ptr = (uint32_t*)(addr + FRAME_PAYLOAD_SIZE_OFFSET);
-        const std::size_t payloadSize = boost::endian::big_to_native(*payload_size_ptr);
-        ReceiveFromHandler(addr + FRAME_HEADER_SIZE, payloadSize);
-        pos = (pos + FRAME_SIZE) & (SUBSCRIPTION_TRANSPORT_BUFFER_SIZE - 1);
+        const std::size_t size = ReadFrame();
+        if (size == 0)
+        {
+            break;
+        }
+
+        const unsigned char instrument = mFrame[INFORMATION_INSTRUMENT_OFFSET];
+        if (mFrame[MESSAGE_TYPE_OFFSET] == MessageType::ORDER_BOOK_UPDATE && instrument < mBooks.size())
+        {
+            auto& book = mBooks[instrument];
+            std::memcpy(book.mFrame.data(), mFrame.data(), size);
+            book.mSize = size;
+            book.mReceiveTime = mFrameReceiveTime;
+            ++book.mCount;
+        }
+        else
+        {
+            ReceiveFromHandler(mFrame.data(), size, mFrameReceiveTime);
+            ++delivered;
+        }
     }
 
-    mContext.post([this, pos, weak_this](){ AsyncReceive(pos, weak_this); });
+    for (auto& book : mBooks)
+    {
+        if (book.mCount != 0)
+        {
+            mStatistics.mBooksConflated += book.mCount - 1;
+            mConflatedCount = book.mCount;
+            ReceiveFromHandler(book.mFrame.data(), book.mSize, book.mReceiveTime);
+            ++delivered;
+            book.mCount = 0;
+        }
+    }
+    mConflatedCount = 1;
+
+    return delivered;
 }
 
-void Subscription::ReceiveFromHandler(unsigned char const* data, std::size_t size)
+std::size_t Subscription::ReadFrame()
+{
+    unsigned char const* addr = mBuffer + mPosition;
+
+    if (loadFrameFlag(addr) == 0)
+    {
+        return 0;
+    }
+    mFrameReceiveTime = std::chrono::steady_clock::now();
+
+    uint32_t payloadSize;
+    std::memcpy(&payloadSize, addr + FRAME_PAYLOAD_SIZE_OFFSET, sizeof(payloadSize));
+    payloadSize = boost::endian::big_to_native(payloadSize);
+    if (payloadSize <= FRAME_MAXIMUM_PAYLOAD_SIZE)
+    {
+        std::memcpy(mFrame.data(), addr + FRAME_HEADER_SIZE, payloadSize);
+    }
+
+    // Before overwriting a frame the publisher clears its flag (when it
+    // writes the preceding frame), so if the flag is still set the copy is
+    // intact.
+    if (recheckFrameFlag(addr) == 0 || payloadSize > FRAME_MAXIMUM_PAYLOAD_SIZE || payloadSize == 0)
+    {
+        ++mStatistics.mTornFrames;
+        RLOG(LG_CON, LogLevel::LL_WARNING) << std::quoted(mName, '\'') << " torn frame at position "
+                                           << mPosition;
+        Resynchronise();
+        return 0;
+    }
+
+    mPosition = (mPosition + FRAME_SIZE) & FRAME_POSITION_MASK;
+
+    if (!CheckSequenceNumber(mFrame.data(), payloadSize))
+    {
+        Resynchronise();
+        return 0;
+    }
+
+    ++mStatistics.mFramesReceived;
+    return payloadSize;
+}
+
+bool Subscription::CheckSequenceNumber(unsigned char const* data, std::size_t size)
+{
+    if (size < INFORMATION_HEADER_SIZE)
+    {
+        return true;
+    }
+
+    const unsigned char messageType = data[MESSAGE_TYPE_OFFSET];
+    const unsigned char instrument = data[INFORMATION_INSTRUMENT_OFFSET];
+    if ((messageType != MessageType::ORDER_BOOK_UPDATE && messageType != MessageType::TRADE_TICKS)
+        || instrument >= mSequenceNumbers[0].size())
+    {
+        return true;
+    }
+
+    uint32_t sequenceNumber;
+    std::memcpy(&sequenceNumber, data + INFORMATION_SEQUENCE_NUMBER_OFFSET, sizeof(sequenceNumber));
+    sequenceNumber = boost::endian::big_to_native(sequenceNumber);
+
+    // Order book updates are numbered by tick, and the exchange's timer skips
+    // tick numbers when it runs late, so only a repeated or earlier number
+    // means anything for them. Trade ticks are numbered consecutively per
+    // instrument, so a gap in those means the publisher has lapped us and the
+    // missing frames have been overwritten; the frames still ahead of us are
+    // just as old, so they are skipped too.
+    const bool isTradeTicks = messageType == MessageType::TRADE_TICKS;
+    auto& last = mSequenceNumbers[isTradeTicks][instrument];
+    if (last != 0 && sequenceNumber <= last)
+    {
+        ++mStatistics.mStaleFrames;
+        RLOG(LG_CON, LogLevel::LL_WARNING) << std::quoted(mName, '\'') << " stale frame with type="
+                                           << static_cast<int>(messageType) << " sequence="
+                                           << sequenceNumber << " last=" << last;
+        return false;
+    }
+
+    const bool lapped = isTradeTicks && last != 0 && sequenceNumber > last + 1;
+    if (lapped)
+    {
+        const std::size_t dropped = sequenceNumber - last - 1;
+        mStatistics.mFramesDropped += dropped;
+        RLOG(LG_CON, LogLevel::LL_WARNING) << std::quoted(mName, '\'') << " dropped " << dropped
+                                           << " trade ticks for instrument=" << static_cast<int>(instrument);
+        OnFramesDropped(dropped);
+    }
+
+    last = sequenceNumber;
+    return !lapped;
+}
+
+void Subscription::Resynchronise()
+{
+    // The frame after the last one written by the publisher always has a
+    // clear flag.
+    for (std::size_t i = 0; i != SUBSCRIPTION_TRANSPORT_FRAME_COUNT; ++i)
+    {
+        const unsigned long position = (mPosition + i * FRAME_SIZE) & FRAME_POSITION_MASK;
+        if (loadFrameFlag(mBuffer + position) == 0)
+        {
+            mPosition = position;
+            break;
+        }
+    }
+    ++mStatistics.mResyncs;
+}
+
+void Subscription::ReceiveFromHandler(unsigned char const* data, std::size_t size, ReceiveTime receiveTime)
 {
     RLOG(LG_CON, LogLevel::LL_DEBUG) << std::quoted(mName, '\'') << " received "
                                      << size << " bytes";
@@ -254,13 +801,121 @@ void Subscription::ReceiveFromHandler(unsigned char const* data, std::size_t siz
     RLOG(LG_CON, LogLevel::LL_DEBUG) << std::quoted(mName, '\'')
                                      << " received message with type=" << static_cast<int>(messageType)
                                      << " and size=" << messageLength;
-    OnMessageReceipt(messageType, data + MESSAGE_HEADER_SIZE, messageLength - MESSAGE_HEADER_SIZE);
+    if (mCapture)
+    {
+        mCapture->Write(std::chrono::system_clock::now(), data, size);
+    }
+    OnMessageReceipt(messageType, data + MESSAGE_HEADER_SIZE, messageLength - MESSAGE_HEADER_SIZE, receiveTime);
+}
+
+ReplaySubscription::ReplaySubscription(boost::asio::io_context& context,
+                                       const std::string& name,
+                                       const SubscriptionOptions& options)
+    : mContext(context),
+      mTimer(context),
+      mReader(name),
+      mBusyPoll(options.mBusyPoll),
+      mSpeed(options.mReplaySpeed)
+{
+    SetName(name);
+    mHasRecord = mReader.Next(mRecord);
+    if (mHasRecord)
+    {
+        mFirstReceiveTime = mRecord.mReceiveTime;
+    }
+}
+
+ReplaySubscription::~ReplaySubscription()
+{
+    RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " closing: replayed="
+                                    << mStatistics.mFramesReceived;
+}
+
+void ReplaySubscription::AsyncReceive()
+{
+    RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " replaying "
+                                    << ((mSpeed > 0.0) ? "at speed " + std::to_string(mSpeed) : "as fast as possible");
+    if (mBusyPoll)
+    {
+        return;
+    }
+
+    std::weak_ptr<ISubscription> weak_this = shared_from_this();
+    mContext.post([this, weak_this](){ AsyncReceive(weak_this); });
+}
+
+void ReplaySubscription::AsyncReceive(std::weak_ptr<ISubscription> weak_this)
+{
+    if (weak_this.expired())
+    {
+        // The 'this' object has been deleted out from underneath us!
+        return;
+    }
+
+    if (Poll() == 0)
+    {
+        if (!mHasRecord)
+        {
+            return;
+        }
+
+        mTimer.expires_at(GetDueTime());
+        mTimer.async_wait([this, weak_this](const boost::system::error_code& error) {
+            if (!error)
+            {
+                AsyncReceive(weak_this);
+            }
+        });
+        return;
+    }
+
+    mContext.post([this, weak_this](){ AsyncReceive(weak_this); });
+}
+
+std::chrono::steady_clock::time_point ReplaySubscription::GetDueTime() const
+{
+    const std::chrono::duration<double> offset = mRecord.mReceiveTime - mFirstReceiveTime;
+    return mStartTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset / mSpeed);
+}
+
+std::size_t ReplaySubscription::Poll()
+{
+    if (!mHasRecord)
+    {
+        return 0;
+    }
+
+    if (!mIsStarted)
+    {
+        mStartTime = std::chrono::steady_clock::now();
+        mIsStarted = true;
+    }
+
+    if (mSpeed > 0.0 && std::chrono::steady_clock::now() < GetDueTime())
+    {
+        return 0;
+    }
+
+    const unsigned char messageType = mRecord.mData[MESSAGE_TYPE_OFFSET];
+    ++mStatistics.mFramesReceived;
+    OnMessageReceipt(messageType, mRecord.mData + MESSAGE_HEADER_SIZE, mRecord.mSize - MESSAGE_HEADER_SIZE,
+                     std::chrono::steady_clock::now());
+
+    mHasRecord = mReader.Next(mRecord);
+    if (!mHasRecord)
+    {
+        RLOG(LG_CON, LogLevel::LL_INFO) << std::quoted(mName, '\'') << " replay complete";
+        OnDisconnect();
+    }
+
+    return 1;
 }
 
 ConnectionFactory::ConnectionFactory(boost::asio::io_context& context,
                                      std::string host,
-                                     unsigned short port)
-    : mContext(context), mHost(std::move(host)), mPort(port)
+                                     unsigned short port,
+                                     ConnectionOptions options)
+    : mContext(context), mHost(std::move(host)), mPort(port), mOptions(options)
 {
     boost::system::error_code error;
     tcp::resolver resolver(mContext);
@@ -305,21 +960,118 @@ std::unique_ptr<IConnection> ConnectionFactory::Create()
     // It's not the end of the world if this fails, so any error is ignored.
     sock.set_option(tcp::no_delay(true), error);
 
-    return std::make_unique<Connection>(mContext, std::move(sock));
+    if (mOptions.mBusyPoll && mOptions.mSocketBusyPoll != 0)
+    {
+        // Ask the kernel to poll the device queue on reads rather than
+        // waiting for an interrupt. This usually needs CAP_NET_ADMIN, so
+        // failure is only logged.
+#ifdef SO_BUSY_POLL
+        const int value = mOptions.mSocketBusyPoll;
+        if (setsockopt(sock.native_handle(), SOL_SOCKET, SO_BUSY_POLL, &value, sizeof(value)) != 0)
+        {
+            RLOG(LG_CON, LogLevel::LL_WARNING) << "failed to set SO_BUSY_POLL: " << std::strerror(errno);
+        }
+#else
+        RLOG(LG_CON, LogLevel::LL_WARNING) << "SO_BUSY_POLL is not supported on this platform";
+#endif
+    }
+
+    return std::make_unique<Connection>(mContext, std::move(sock), mOptions);
+}
+
+std::unique_ptr<IConnection> NullConnectionFactory::Create()
+{
+    RLOG(LG_CON, LogLevel::LL_INFO) << "using a null execution connection";
+    return std::make_unique<NullConnection>();
 }
 
 SubscriptionFactory::SubscriptionFactory(boost::asio::io_context& context,
                                          const std::string& type,
-                                         const std::string& name)
-    : mContext(context), mType(type), mName(name)
+                                         const std::string& name,
+                                         SubscriptionOptions options)
+    : mContext(context), mType(type), mName(name), mOptions(std::move(options))
 {
 }
 
 std::shared_ptr<ISubscription> SubscriptionFactory::Create()
 {
-    interprocess::file_mapping file{mName.c_str(), interprocess::read_only};
-    interprocess::mapped_region region{file, interprocess::read_only};
-    return std::make_shared<Subscription>(mContext, file, region);
+    if (mType == "replay")
+    {
+        return std::make_shared<ReplaySubscription>(mContext, mName, mOptions);
+    }
+
+    interprocess::mapped_region region;
+
+    try
+    {
+        if (mType == "mmap")
+        {
+            interprocess::file_mapping file{mName.c_str(), interprocess::read_only};
+            region = interprocess::mapped_region{file, interprocess::read_only, 0, SUBSCRIPTION_TRANSPORT_BUFFER_SIZE};
+        }
+        else if (mType == "shm")
+        {
+            interprocess::shared_memory_object shm{interprocess::open_only, mName.c_str(), interprocess::read_only};
+            region = interprocess::mapped_region{shm, interprocess::read_only, 0, SUBSCRIPTION_TRANSPORT_BUFFER_SIZE};
+        }
+        else
+        {
+            throw ReadyTraderGoError("unknown information channel type '" + mType + "'");
+        }
+    }
+    catch (const interprocess::interprocess_exception& e)
+    {
+        RLOG(LG_CON, LogLevel::LL_ERROR) << "failed to map information channel '" << mName << "': " << e.what();
+        throw ReadyTraderGoError("failed to map information channel '" + mName + "': " + e.what());
+    }
+
+    PrepareRegion(region);
+    return std::make_shared<Subscription>(mContext, mName, region, mOptions);
+}
+
+void SubscriptionFactory::PrepareRegion(interprocess::mapped_region& region) const
+{
+    // None of these are essential, so failures are only logged.
+    if (mOptions.mHugePages)
+    {
+#if defined(__unix__) && defined(MADV_HUGEPAGE)
+        if (region.get_size() < TRANSPARENT_HUGE_PAGE_SIZE)
+        {
+            RLOG(LG_CON, LogLevel::LL_WARNING) << "'" << mName << "' is smaller than a huge page, so it can only"
+                                               << " have huge pages if it is on hugetlbfs";
+        }
+        else if (madvise(region.get_address(), region.get_size(), MADV_HUGEPAGE) != 0)
+        {
+            RLOG(LG_CON, LogLevel::LL_WARNING) << "huge pages not available for '" << mName << "': "
+                                               << std::strerror(errno);
+        }
+#else
+        RLOG(LG_CON, LogLevel::LL_WARNING) << "huge pages are not supported on this platform";
+#endif
+    }
+
+    if (mOptions.mPrefault)
+    {
+        auto* const begin = static_cast<volatile unsigned char const*>(region.get_address());
+        const std::size_t pageSize = interprocess::mapped_region::get_page_size();
+        for (std::size_t offset = 0; offset < region.get_size(); offset += pageSize)
+        {
+            (void) begin[offset];
+        }
+    }
+
+    if (mOptions.mLock)
+    {
+#ifdef __unix__
+        if (mlock(region.get_address(), region.get_size()) != 0)
+        {
+            RLOG(LG_CON, LogLevel::LL_WARNING) << "failed to lock '" << mName << "' into memory: "
+                                               << std::strerror(errno);
+        }
+#else
+        RLOG(LG_CON, LogLevel::LL_WARNING) << "locking memory is not supported on this platform";
+#endif
+    }
 }
 
-}
\ No newline at end of file
+}
@@ -18,6 +18,8 @@
 #ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_CONNECTIVITY_H
 #define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_CONNECTIVITY_H
 
+#include <array>
+#include <chrono>
 #include <cstddef>
 #include <memory>
 #include <string>
@@ -25,12 +27,16 @@
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
-#include <boost/asio/streambuf.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/interprocess/file_mapping.hpp>
 #include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
 #include <boost/system/error_code.hpp>
 
+#include "capture.h"
 #include "connectivitytypes.h"
+#include "messagebuffer.h"
+#include "waitstrategy.h"
 
 namespace interprocess = boost::interprocess;
 using boost::asio::ip::tcp;
@@ -49,48 +55,202 @@ constexpr std::size_t MESSAGE_TYPE_OFFSET = 2;
 constexpr std::size_t FRAME_PAYLOAD_SIZE_OFFSET = 4;
 constexpr std::size_t FRAME_HEADER_SIZE = 8;
 constexpr std::size_t FRAME_SIZE = 128;
-constexpr std::size_t SUBSCRIPTION_TRANSPORT_BUFFER_SIZE = 8182;
+constexpr std::size_t FRAME_MAXIMUM_PAYLOAD_SIZE = FRAME_SIZE - FRAME_HEADER_SIZE;
+constexpr std::size_t SUBSCRIPTION_TRANSPORT_BUFFER_SIZE = 8192;
+constexpr std::size_t SUBSCRIPTION_TRANSPORT_FRAME_COUNT = SUBSCRIPTION_TRANSPORT_BUFFER_SIZE / FRAME_SIZE;
 
+// Information messages begin with an instrument (one byte) and a sequence
+// number (four-byte, big endian, unsigned integer) immediately after the
+// message header.
+constexpr std::size_t INFORMATION_INSTRUMENT_OFFSET = MESSAGE_HEADER_SIZE;
+constexpr std::size_t INFORMATION_SEQUENCE_NUMBER_OFFSET = MESSAGE_HEADER_SIZE + 1;
+constexpr std::size_t INFORMATION_HEADER_SIZE = INFORMATION_SEQUENCE_NUMBER_OFFSET + 4;
+
+struct ConnectionOptions
+{
+    // Capacity of the receive and send buffers, which are allocated when
+    // the connection is made and never grow.
+    std::size_t mReceiveBufferSize = 65536;
+    std::size_t mSendBufferSize = 65536;
+
+    // When busy polling, the owner calls Poll() from its own loop to read
+    // from the socket and no asynchronous reads are started.
+    bool mBusyPoll = false;
+
+    // If not zero (and busy polling), the SO_BUSY_POLL value, in
+    // microseconds, to set on the socket.
+    int mSocketBusyPoll = 0;
+
+    // Use the kernel's receive timestamps (SO_TIMESTAMPNS) rather than the
+    // time at which a read returned.
+    bool mReceiveTimestamps = true;
+};
+
+struct SubscriptionOptions
+{
+    // When busy polling, the owner calls Poll() from its own loop and
+    // nothing is posted to the io_context.
+    bool mBusyPoll = false;
+
+    // Deliver everything that is ready on each poll, keeping only the most
+    // recent order book update for each instrument.
+    bool mConflate = false;
+
+    // How to wait between polls of an idle ring when not busy polling.
+    WaitStrategy mWaitStrategy;
+
+    // Ask for the ring to be backed by transparent huge pages, fault it in
+    // and lock it into memory when it is mapped, so that reading it never
+    // page faults. Transparent huge pages need a mapping of at least a huge
+    // page (2MB on x86-64), so for a smaller ring only an mmap file on a
+    // hugetlbfs mount gives huge pages.
+    bool mHugePages = false;
+    bool mPrefault = false;
+    bool mLock = false;
+
+    // If set, every message received is appended to this capture file.
+    std::string mCaptureFile;
+
+    // Speed at which a capture is replayed relative to the recorded pacing
+    // (so 1 is real time); zero replays as fast as possible.
+    double mReplaySpeed = 0.0;
+};
 
 class Connection : public IConnection
 {
 public:
-    Connection(boost::asio::io_context& context, tcp::socket&& socket);
+    Connection(boost::asio::io_context& context,
+               tcp::socket&& socket,
+               const ConnectionOptions& options = {});
     ~Connection() override;
     void AsyncRead() override;
-    void SendMessage(unsigned char messageType, const ISerialisable& serialisable, SendMode mode) override;
+    void BeginBatch() override;
+    void Close() override;
+    void Flush() override;
+    std::size_t Poll() override;
+    bool SendMessage(unsigned char messageType, const ISerialisable& serialisable, SendMode mode) override;
 
 private:
     void Send();
     void Send(SendMode mode);
+    void Shutdown();
 
-    void ReadSomeHandler(const boost::system::error_code& error, std::size_t size);
+    bool PrepareRead();
+    std::size_t ProcessInput(std::size_t size, ReceiveTime receiveTime);
+    std::size_t Receive(boost::system::error_code& error, ReceiveTime& receiveTime);
+    void ReadErrorHandler(const boost::system::error_code& error);
+    void ReadReadyHandler(const boost::system::error_code& error);
     void WriteSomeHandler(const boost::system::error_code& error, std::size_t size);
 
     boost::asio::io_context& mContext;
-    boost::asio::streambuf mInBuffer;
-    boost::asio::streambuf mOutBuffer;
+    MessageBuffer mInBuffer;
+    MessageBuffer mOutBuffer;
     bool mIsSending = false;
     bool mIsSendPosted = false;
+    unsigned long mBatchDepth = 0;
+    unsigned long mBatchSize = 0;
+    bool mBusyPoll;
+    bool mIsClosing = false;
+    bool mIsReading = false;
+    bool mReceiveTimestamps;
     tcp::socket mSocket;
 };
 
+// A connection that silently discards everything sent to it and never
+// receives anything, for running against a replayed information feed.
+class NullConnection : public IConnection
+{
+public:
+    NullConnection();
+    ~NullConnection() override;
+    void AsyncRead() override {};
+    void BeginBatch() override {};
+    void Close() override {};
+    void Flush() override {};
+    std::size_t Poll() override { return 0; };
+    bool SendMessage(unsigned char messageType, const ISerialisable& serialisable, SendMode mode) override;
+
+private:
+    unsigned long mMessageCount = 0;
+};
+
 class Subscription : public ISubscription
 {
 public:
     Subscription(boost::asio::io_context& context,
-                 interprocess::file_mapping& file,
-                 interprocess::mapped_region& region);
+                 const std::string& name,
+                 interprocess::mapped_region& region,
+                 const SubscriptionOptions& options = {});
     ~Subscription() override;
     void AsyncReceive() override;
+    std::size_t Poll() override;
 
 private:
-    void AsyncReceive(unsigned long, std::weak_ptr<ISubscription>);
-    void ReceiveFromHandler(unsigned char const*, std::size_t size);
+    void AsyncReceive(std::weak_ptr<ISubscription>);
+    bool CheckSequenceNumber(unsigned char const* data, std::size_t size);
+    std::size_t Drain();
+    std::size_t ReadFrame();
+    void ReceiveFromHandler(unsigned char const*, std::size_t size, ReceiveTime receiveTime);
+    void Resynchronise();
 
     boost::asio::io_context& mContext;
-    interprocess::file_mapping mFile;
+    boost::asio::steady_timer mTimer;
     interprocess::mapped_region mRegion;
+    unsigned char const* mBuffer;
+    unsigned long mPosition = 0;
+
+    // Frames are copied out of the ring before being validated and handled
+    // so the publisher can't change them underneath us.
+    alignas(64) std::array<unsigned char, FRAME_MAXIMUM_PAYLOAD_SIZE> mFrame;
+    ReceiveTime mFrameReceiveTime;
+
+    // Last sequence number seen for each message type and instrument.
+    std::array<std::array<unsigned long, 2>, 2> mSequenceNumbers = {};
+
+    // Most recent order book update for each instrument while draining.
+    struct ConflatedBook
+    {
+        std::array<unsigned char, FRAME_MAXIMUM_PAYLOAD_SIZE> mFrame;
+        std::size_t mSize = 0;
+        unsigned long mCount = 0;
+        ReceiveTime mReceiveTime;
+    };
+    std::array<ConflatedBook, 2> mBooks;
+
+    bool mBusyPoll;
+    bool mConflate;
+    WaitStrategy mWaitStrategy;
+    std::unique_ptr<CaptureWriter> mCapture;
+};
+
+// Plays back a capture file, either paced like the original feed (scaled
+// by the replay speed) or as fast as possible.
+class ReplaySubscription : public ISubscription
+{
+public:
+    ReplaySubscription(boost::asio::io_context& context,
+                       const std::string& name,
+                       const SubscriptionOptions& options = {});
+    ~ReplaySubscription() override;
+    void AsyncReceive() override;
+    std::size_t Poll() override;
+
+private:
+    void AsyncReceive(std::weak_ptr<ISubscription>);
+    std::chrono::steady_clock::time_point GetDueTime() const;
+
+    boost::asio::io_context& mContext;
+    boost::asio::steady_timer mTimer;
+    CaptureReader mReader;
+    CaptureRecord mRecord;
+    bool mHasRecord = false;
+    bool mBusyPoll;
+    double mSpeed;
+
+    // Replay time is measured from the first record.
+    std::chrono::system_clock::time_point mFirstReceiveTime;
+    std::chrono::steady_clock::time_point mStartTime;
+    bool mIsStarted = false;
 };
 
 class ConnectionFactory : public IConnectionFactory
@@ -98,7 +258,8 @@ class ConnectionFactory : public IConnectionFactory
 public:
     ConnectionFactory(boost::asio::io_context& context,
                       std::string host,
-                      unsigned short port);
+                      unsigned short port,
+                      ConnectionOptions options = {});
 
     std::unique_ptr<IConnection> Create() override;
 
@@ -107,6 +268,13 @@ private:
     std::vector<tcp::endpoint> mEndpoints;
     std::string mHost;
     unsigned short mPort;
+    ConnectionOptions mOptions;
+};
+
+class NullConnectionFactory : public IConnectionFactory
+{
+public:
+    std::unique_ptr<IConnection> Create() override;
 };
 
 class SubscriptionFactory : public ISubscriptionFactory
@@ -114,14 +282,18 @@ class SubscriptionFactory : public ISubscriptionFactory
 public:
     SubscriptionFactory(boost::asio::io_context& context,
                         const std::string& type,
-                        const std::string& name);
+                        const std::string& name,
+                        SubscriptionOptions options = {});
 
     std::shared_ptr<ISubscription> Create() override;
 
 private:
+    void PrepareRegion(interprocess::mapped_region& region) const;
+
     boost::asio::io_context& mContext;
     std::string mType;
     std::string mName;
+    SubscriptionOptions mOptions;
 };
 
 }
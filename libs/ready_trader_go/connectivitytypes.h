@@ -18,19 +18,54 @@
 #ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_CONNECTIVITYTYPES_H
 #define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_CONNECTIVITYTYPES_H
 
+#include <chrono>
 #include <cstddef>
 #include <functional>
 #include <memory>
+#include <string>
 #include <utility>
 
 namespace ReadyTraderGo {
 
+// When a message was received, on the steady clock. For the execution
+// connection this is the kernel's receive time if it is available.
+using ReceiveTime = std::chrono::steady_clock::time_point;
+
 enum class SendMode
 {
     ASAP,
     SOON
 };
 
+struct SubscriptionStatistics
+{
+    // Frames delivered to the handler.
+    unsigned long mFramesReceived = 0;
+    // Frames overwritten by the publisher before we could read them, as
+    // shown by gaps in the trade ticks' sequence numbers.
+    unsigned long mFramesDropped = 0;
+    // Frames that were rewritten by the publisher while they were being read.
+    unsigned long mTornFrames = 0;
+    // Frames with a sequence number older than one already seen.
+    unsigned long mStaleFrames = 0;
+    // Number of times the reader skipped forward to the publisher's position.
+    unsigned long mResyncs = 0;
+    // Order book updates that were superseded by a later update for the same
+    // instrument and never delivered.
+    unsigned long mBooksConflated = 0;
+};
+
+struct ConnectionStatistics
+{
+    unsigned long mMessagesSent = 0;
+    // Number of writes issued to the socket.
+    unsigned long mWrites = 0;
+    // Batches flushed, the messages sent in them and the largest batch.
+    unsigned long mBatches = 0;
+    unsigned long mBatchedMessages = 0;
+    unsigned long mMaximumBatchSize = 0;
+};
+
 struct ISerialisable
 {
     virtual std::size_t Size() const noexcept = 0;
@@ -42,19 +77,42 @@ struct IConnection
 {
     virtual ~IConnection() = default;
     virtual void AsyncRead() = 0;
-    virtual void SendMessage(unsigned char messageType,
+
+    // Stop reading and close the connection once everything already sent
+    // has been written. Nothing more is sent after Close() is called.
+    virtual void Close() = 0;
+
+    // Read from the connection, if busy polling, and deliver any complete
+    // messages. Returns the number of messages delivered.
+    virtual std::size_t Poll() = 0;
+
+    // Returns false, having sent nothing, if the message could not be queued
+    // because the connection is closing or its send buffer is full.
+    virtual bool SendMessage(unsigned char messageType,
                              const ISerialisable& serialisable,
                              SendMode mode) = 0;
-    void SendMessage(unsigned char messageType, const ISerialisable& serialisable)
+    bool SendMessage(unsigned char messageType, const ISerialisable& serialisable)
     {
-        SendMessage(messageType, serialisable, SendMode::ASAP);
+        return SendMessage(messageType, serialisable, SendMode::ASAP);
     }
 
+    // Messages sent between BeginBatch() and the matching Flush() are
+    // queued and then written together. Batches may be nested, in which
+    // case nothing is written until the outermost batch is flushed.
+    virtual void BeginBatch() = 0;
+    virtual void Flush() = 0;
+
+    const ConnectionStatistics& GetStatistics() const { return mStatistics; }
+
     const std::string& GetName() const { return mName; }
     void SetName(std::string name) { mName = std::move(name); }
 
     std::function<void()> Disconnected;
-    std::function<void(IConnection*, unsigned char, unsigned char const*, std::size_t)> MessageReceived;
+    std::function<void(IConnection*, unsigned char, unsigned char const*, std::size_t, ReceiveTime)> MessageReceived;
+
+    // Called each time the messages queued so far are handed to the socket
+    // (or are otherwise sent), whether or not they were batched.
+    std::function<void()> MessagesWritten;
 
 protected:
     void OnDisconnect()
@@ -65,15 +123,48 @@ protected:
         }
     }
 
-    void OnMessageReceipt(unsigned char messageType, unsigned char const* data, std::size_t size)
+    void OnMessagesWritten()
+    {
+        if (MessagesWritten)
+        {
+            MessagesWritten();
+        }
+    }
+
+    void OnMessageReceipt(unsigned char messageType,
+                          unsigned char const* data,
+                          std::size_t size,
+                          ReceiveTime receiveTime)
     {
         if (MessageReceived)
         {
-            MessageReceived(this, messageType, data, size);
+            MessageReceived(this, messageType, data, size, receiveTime);
         }
     }
 
     std::string mName;
+    ConnectionStatistics mStatistics;
+};
+
+// Begins a batch on construction and flushes it on destruction.
+class SendBatch
+{
+public:
+    explicit SendBatch(IConnection& connection) : mConnection(connection)
+    {
+        mConnection.BeginBatch();
+    }
+
+    ~SendBatch()
+    {
+        mConnection.Flush();
+    }
+
+    SendBatch(const SendBatch&) = delete;
+    SendBatch& operator=(const SendBatch&) = delete;
+
+private:
+    IConnection& mConnection;
 };
 
 struct ISubscription: public std::enable_shared_from_this<ISubscription>
@@ -81,21 +172,54 @@ struct ISubscription: public std::enable_shared_from_this<ISubscription>
     virtual ~ISubscription() = default;
     virtual void AsyncReceive() = 0;
 
+    // Check for a new message and, if there is one, deliver it. Returns the
+    // number of messages delivered.
+    virtual std::size_t Poll() = 0;
+
     const std::string& GetName() const { return mName; }
     void SetName(std::string name) { mName = std::move(name); }
 
-    std::function<void(ISubscription*, unsigned char, unsigned char const*, std::size_t)> MessageReceived;
+    const SubscriptionStatistics& GetStatistics() const { return mStatistics; }
+
+    // Number of order book updates represented by the message currently
+    // being delivered (more than one if updates have been conflated).
+    unsigned long GetConflatedCount() const { return mConflatedCount; }
+
+    std::function<void()> Disconnected;
+    std::function<void(ISubscription*, std::size_t)> FramesDropped;
+    std::function<void(ISubscription*, unsigned char, unsigned char const*, std::size_t, ReceiveTime)> MessageReceived;
 
 protected:
-    void OnMessageReceipt(unsigned char messageType, unsigned char const* data, std::size_t size)
+    void OnDisconnect()
+    {
+        if (Disconnected)
+        {
+            Disconnected();
+        }
+    }
+
+    void OnFramesDropped(std::size_t count)
+    {
+        if (FramesDropped)
+        {
+            FramesDropped(this, count);
+        }
+    }
+
+    void OnMessageReceipt(unsigned char messageType,
+                          unsigned char const* data,
+                          std::size_t size,
+                          ReceiveTime receiveTime)
     {
         if (MessageReceived)
         {
-            MessageReceived(this, messageType, data, size);
+            MessageReceived(this, messageType, data, size, receiveTime);
         }
     }
 
     std::string mName;
+    SubscriptionStatistics mStatistics;
+    unsigned long mConflatedCount = 1;
 };
 
 struct IConnectionFactory
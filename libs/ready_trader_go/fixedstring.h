@@ -0,0 +1,91 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_FIXEDSTRING_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_FIXEDSTRING_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace ReadyTraderGo {
+
+// A string of at most Capacity characters held inline, so that messages
+// carrying text never touch the heap. Longer values are truncated.
+template<std::size_t Capacity>
+class FixedString
+{
+public:
+    static constexpr std::size_t CAPACITY = Capacity;
+
+    FixedString() = default;
+    FixedString(const char* value) { Assign(std::string_view(value)); }
+    FixedString(std::string_view value) { Assign(value); }
+    FixedString(const std::string& value) { Assign(value); }
+
+    void Assign(std::string_view value)
+    {
+        mSize = std::min(value.size(), Capacity);
+        std::memcpy(mData, value.data(), mSize);
+        mData[mSize] = '\0';
+    }
+
+    // Assign at most Capacity characters, stopping at the first zero byte.
+    void AssignPadded(const char* data)
+    {
+        auto end = static_cast<const char*>(std::memchr(data, 0, Capacity));
+        Assign(std::string_view(data, end ? end - data : Capacity));
+    }
+
+    const char* c_str() const { return mData; }
+    const char* data() const { return mData; }
+    bool empty() const { return mSize == 0; }
+    std::size_t size() const { return mSize; }
+
+    std::string_view View() const { return std::string_view(mData, mSize); }
+    operator std::string_view() const { return View(); }
+    std::string ToString() const { return std::string(mData, mSize); }
+
+private:
+    char mData[Capacity + 1] = {};
+    std::size_t mSize = 0;
+};
+
+template<std::size_t Capacity>
+bool operator==(const FixedString<Capacity>& left, std::string_view right)
+{
+    return left.View() == right;
+}
+
+template<std::size_t Capacity>
+bool operator!=(const FixedString<Capacity>& left, std::string_view right)
+{
+    return left.View() != right;
+}
+
+template<std::size_t Capacity>
+std::ostream& operator<<(std::ostream& stream, const FixedString<Capacity>& value)
+{
+    return stream << value.View();
+}
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_FIXEDSTRING_H
@@ -0,0 +1,79 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cmath>
+
+#include "latencyhistogram.h"
+
+namespace ReadyTraderGo {
+
+void LatencyHistogram::Reset()
+{
+    mCounts.fill(0);
+    mCount = 0;
+    mTotal = 0;
+    mMaximum = 0;
+}
+
+std::uint64_t LatencyHistogram::upperBoundOf(std::size_t index)
+{
+    if (index < LATENCY_HISTOGRAM_SUB_BUCKET_COUNT)
+    {
+        return index;
+    }
+    const std::size_t shift = index / LATENCY_HISTOGRAM_SUB_BUCKET_COUNT - 1;
+    const std::uint64_t subBucket = index % LATENCY_HISTOGRAM_SUB_BUCKET_COUNT + LATENCY_HISTOGRAM_SUB_BUCKET_COUNT;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+std::uint64_t LatencyHistogram::GetValueAtPercentile(double percentile) const
+{
+    if (mCount == 0)
+    {
+        return 0;
+    }
+
+    const auto target = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(mCount))));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i != mCounts.size(); ++i)
+    {
+        seen += mCounts[i];
+        if (seen >= target)
+        {
+            return std::min(upperBoundOf(i), mMaximum);
+        }
+    }
+    return mMaximum;
+}
+
+void LatencyHistogram::WriteTo(std::ostream& stream) const
+{
+    stream << "count=" << mCount << " mean_ns=" << GetMean() << " p50_ns=" << GetValueAtPercentile(50.0)
+           << " p99_ns=" << GetValueAtPercentile(99.0) << " p99.9_ns=" << GetValueAtPercentile(99.9)
+           << " max_ns=" << mMaximum << '\n';
+    for (std::size_t i = 0; i != mCounts.size(); ++i)
+    {
+        if (mCounts[i] != 0)
+        {
+            stream << "    " << upperBoundOf(i) << ' ' << mCounts[i] << '\n';
+        }
+    }
+}
+
+}
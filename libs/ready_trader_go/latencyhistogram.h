@@ -0,0 +1,111 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_LATENCYHISTOGRAM_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_LATENCYHISTOGRAM_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace ReadyTraderGo {
+
+// Latencies are bucketed by power of two, with each power of two split into
+// LATENCY_HISTOGRAM_SUB_BUCKET_COUNT equal sub-buckets (as in an HDR
+// histogram), so a recorded value is out by no more than about 3%. Values
+// are in nanoseconds and anything of 2^40ns (about 18 minutes) or more is
+// counted in the last bucket.
+constexpr unsigned LATENCY_HISTOGRAM_SUB_BUCKET_BITS = 5;
+constexpr std::size_t LATENCY_HISTOGRAM_SUB_BUCKET_COUNT = std::size_t(1) << LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+constexpr unsigned LATENCY_HISTOGRAM_MAXIMUM_BITS = 40;
+constexpr std::size_t LATENCY_HISTOGRAM_BUCKET_COUNT =
+    (LATENCY_HISTOGRAM_MAXIMUM_BITS - LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1) * LATENCY_HISTOGRAM_SUB_BUCKET_COUNT;
+
+class LatencyHistogram
+{
+public:
+    // Recording never allocates and costs a handful of instructions.
+    void Record(std::chrono::nanoseconds latency)
+    {
+        std::uint64_t value = (latency.count() > 0) ? static_cast<std::uint64_t>(latency.count()) : 0;
+        if (value >= (std::uint64_t(1) << LATENCY_HISTOGRAM_MAXIMUM_BITS))
+        {
+            value = (std::uint64_t(1) << LATENCY_HISTOGRAM_MAXIMUM_BITS) - 1;
+        }
+
+        ++mCounts[indexOf(value)];
+        ++mCount;
+        mTotal += value;
+        if (value > mMaximum)
+        {
+            mMaximum = value;
+        }
+    }
+
+    void Reset();
+
+    std::uint64_t GetCount() const { return mCount; }
+    std::uint64_t GetMaximum() const { return mMaximum; }
+    std::uint64_t GetMean() const { return (mCount != 0) ? mTotal / mCount : 0; }
+
+    // The smallest recorded value that is greater than or equal to the
+    // given percentage of all recorded values (to within the bucket size).
+    std::uint64_t GetValueAtPercentile(double percentile) const;
+
+    // Write the percentile summary on one line followed by the upper bound
+    // and count of each non-empty bucket, one per line.
+    void WriteTo(std::ostream& stream) const;
+
+private:
+    static std::size_t indexOf(std::uint64_t value)
+    {
+        if (value < LATENCY_HISTOGRAM_SUB_BUCKET_COUNT)
+        {
+            return static_cast<std::size_t>(value);
+        }
+        const unsigned shift = mostSignificantBit(value) - LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+        return (shift + 1) * LATENCY_HISTOGRAM_SUB_BUCKET_COUNT + (value >> shift) - LATENCY_HISTOGRAM_SUB_BUCKET_COUNT;
+    }
+
+    static unsigned mostSignificantBit(std::uint64_t value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - __builtin_clzll(value);
+#else
+        unsigned result = 0;
+        while (value >>= 1)
+        {
+            ++result;
+        }
+        return result;
+#endif
+    }
+
+    // Largest value counted in the given bucket.
+    static std::uint64_t upperBoundOf(std::size_t index);
+
+    std::array<std::uint64_t, LATENCY_HISTOGRAM_BUCKET_COUNT> mCounts = {};
+    std::uint64_t mCount = 0;
+    std::uint64_t mTotal = 0;
+    std::uint64_t mMaximum = 0;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_LATENCYHISTOGRAM_H
@@ -0,0 +1,618 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "error.h"
+#include "logging.h"
+
+RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_LOG, "LOG")
+
+namespace ReadyTraderGo {
+
+namespace {
+
+// How long the writer sleeps when every ring is empty.
+constexpr std::chrono::milliseconds LOG_WRITER_IDLE_SLEEP{1};
+
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE must be a power of two");
+
+// Records written by one thread and read by the log writer. Only the
+// writing thread moves the head and only the log writer moves the tail.
+class LogRing
+{
+public:
+    LogRing() : mSlots(new Slot[LOG_RING_SIZE]) {}
+
+    // Copy a record into the ring, or count it as dropped if the ring is full.
+    void Push(const LogRecordHeader& header, const unsigned char* data)
+    {
+        auto head = mHead.load(std::memory_order_relaxed);
+        if (head - mCachedTail == LOG_RING_SIZE)
+        {
+            mCachedTail = mTail.load(std::memory_order_acquire);
+            if (head - mCachedTail == LOG_RING_SIZE)
+            {
+                mDropped.store(mDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        Slot& slot = mSlots[head & (LOG_RING_SIZE - 1)];
+        slot.mHeader = header;
+        std::memcpy(slot.mData, data, header.mSize);
+        mHead.store(head + 1, std::memory_order_release);
+    }
+
+    // The oldest record in the ring, or nullptr if it is empty.
+    const LogRecordHeader* Front(const unsigned char*& data) const
+    {
+        auto tail = mTail.load(std::memory_order_relaxed);
+        if (tail == mHead.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+        const Slot& slot = mSlots[tail & (LOG_RING_SIZE - 1)];
+        data = slot.mData;
+        return &slot.mHeader;
+    }
+
+    void Pop()
+    {
+        mTail.store(mTail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    unsigned long GetDropped() const { return mDropped.load(std::memory_order_relaxed); }
+
+    void Close() { mIsClosed.store(true, std::memory_order_release); }
+    bool IsClosed() const { return mIsClosed.load(std::memory_order_acquire); }
+
+private:
+    struct alignas(64) Slot
+    {
+        LogRecordHeader mHeader;
+        unsigned char mData[LOG_RECORD_DATA_SIZE];
+    };
+
+    std::unique_ptr<Slot[]> mSlots;
+
+    alignas(64) std::atomic<std::uint64_t> mHead{0};
+    std::uint64_t mCachedTail = 0;
+    std::atomic<unsigned long> mDropped{0};
+
+    alignas(64) std::atomic<std::uint64_t> mTail{0};
+    std::atomic<bool> mIsClosed{false};
+};
+
+// Every thread's ring, the background thread draining them and the
+// settings shared by all threads.
+class LogCore
+{
+public:
+    LogCore() = default;
+    ~LogCore() { Stop(); }
+
+    bool IsRunning() const { return mIsRunning.load(std::memory_order_acquire); }
+
+    void AddRing(std::shared_ptr<LogRing> ring);
+    void SetEnabled(bool enabled);
+    void SetLevel(LogLevel level);
+    void Start(const std::string& filename, LogFormat format);
+    void Stop();
+    void WriteToConsole(const LogRecordHeader& header, const unsigned char* data);
+
+private:
+    struct Reader
+    {
+        std::shared_ptr<LogRing> mRing;
+        unsigned long mDropped;
+    };
+
+    std::size_t Drain(Reader& reader);
+    void RemoveFinishedReaders();
+    void UpdateReaders();
+    void UpdateThreshold();
+    void Write(const LogRecordHeader& header, const unsigned char* data);
+    void WriteBinary(const LogRecordHeader& header, const unsigned char* data);
+    void WriterThread();
+
+    std::mutex mMutex;
+    bool mIsEnabled = true;
+    LogLevel mLevel = LogLevel::LL_DEBUG;
+    std::thread mThread;
+    std::atomic<bool> mIsRunning{false};
+    std::atomic<bool> mIsStopping{false};
+
+    std::mutex mRingsMutex;
+    std::vector<std::shared_ptr<LogRing>> mRings;
+    std::atomic<unsigned long> mRingsVersion{0};
+
+    std::mutex mConsoleMutex;
+
+    // Used only by the writer thread (and by Stop once it has finished).
+    std::ofstream mStream;
+    LogFormat mFormat = LogFormat::TEXT;
+    std::vector<Reader> mReaders;
+    unsigned long mReadersVersion = 0;
+    std::unordered_set<const LogSite*> mSites;
+    std::string mBuffer;
+};
+
+LogCore& getLogCore()
+{
+    static LogCore core;
+    return core;
+}
+
+// Owns the calling thread's ring, which the log writer drains and then
+// forgets once the thread has finished.
+struct ThreadLogRing
+{
+    ~ThreadLogRing()
+    {
+        if (mRing)
+        {
+            mRing->Close();
+        }
+    }
+
+    std::shared_ptr<LogRing> mRing;
+};
+
+thread_local ThreadLogRing threadLogRing;
+
+LogRing& getThreadLogRing()
+{
+    if (!threadLogRing.mRing)
+    {
+        threadLogRing.mRing = std::make_shared<LogRing>();
+        getLogCore().AddRing(threadLogRing.mRing);
+    }
+    return *threadLogRing.mRing;
+}
+
+template<typename T>
+T readArgument(const unsigned char* data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// The number of bytes taken by the argument at the start of the data
+// (including its tag), or zero if it is malformed.
+std::size_t getArgumentSize(const unsigned char* data, std::size_t size)
+{
+    std::size_t result = 0;
+    switch (static_cast<LogArgument>(data[0]))
+    {
+    case LogArgument::BOOL:
+    case LogArgument::CHAR:
+        result = 2;
+        break;
+    case LogArgument::SIGNED:
+    case LogArgument::UNSIGNED:
+    case LogArgument::DOUBLE:
+        result = 1 + sizeof(std::uint64_t);
+        break;
+    case LogArgument::STRING:
+        result = (size >= 2) ? 2 + data[1] : 0;
+        break;
+    case LogArgument::DEFERRED:
+        result = 1 + sizeof(LogDeferredFormatter) + sizeof(std::uint64_t);
+        break;
+    }
+    return (result <= size) ? result : 0;
+}
+
+template<typename T>
+void appendValue(std::string& buffer, T value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+}
+
+void LogCore::AddRing(std::shared_ptr<LogRing> ring)
+{
+    std::lock_guard<std::mutex> lock(mRingsMutex);
+    mRings.push_back(std::move(ring));
+    mRingsVersion.fetch_add(1, std::memory_order_release);
+}
+
+void LogCore::SetEnabled(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mIsEnabled = enabled;
+    UpdateThreshold();
+}
+
+void LogCore::SetLevel(LogLevel level)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mLevel = level;
+    UpdateThreshold();
+}
+
+void LogCore::Start(const std::string& filename, LogFormat format)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mThread.joinable())
+    {
+        throw ReadyTraderGoError("logging has already been started");
+    }
+
+    auto mode = std::ios_base::app;
+    if (format == LogFormat::BINARY)
+    {
+        mode |= std::ios_base::binary;
+    }
+    mStream.open(filename, mode);
+    if (!mStream)
+    {
+        throw ReadyTraderGoError("failed to open log file '" + filename + "': " + std::strerror(errno));
+    }
+
+    mFormat = format;
+    mSites.clear();
+    if (mFormat == LogFormat::BINARY)
+    {
+        mStream.write(BINARY_LOG_MAGIC, sizeof(BINARY_LOG_MAGIC));
+    }
+
+    mIsStopping.store(false, std::memory_order_relaxed);
+    mThread = std::thread([this] { WriterThread(); });
+    mIsRunning.store(true, std::memory_order_release);
+}
+
+void LogCore::Stop()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mThread.joinable())
+    {
+        return;
+    }
+
+    // New records go to the console from here on. The writer empties the
+    // rings before it finishes and they are emptied again once it has, for
+    // records from threads that saw it running just before it stopped.
+    mIsRunning.store(false, std::memory_order_release);
+    mIsStopping.store(true, std::memory_order_release);
+    mThread.join();
+
+    UpdateReaders();
+    for (auto& reader : mReaders)
+    {
+        Drain(reader);
+    }
+    mStream.close();
+}
+
+void LogCore::WriteToConsole(const LogRecordHeader& header, const unsigned char* data)
+{
+    std::lock_guard<std::mutex> lock(mConsoleMutex);
+    formatLogRecord(std::clog, header, header.mSite->mChannel, data);
+}
+
+std::size_t LogCore::Drain(Reader& reader)
+{
+    std::size_t count = 0;
+    const unsigned char* data;
+    while (auto header = reader.mRing->Front(data))
+    {
+        Write(*header, data);
+        reader.mRing->Pop();
+        ++count;
+    }
+
+    // This is written straight to the log, since the writer may be stopping.
+    auto dropped = reader.mRing->GetDropped();
+    if (dropped != reader.mDropped)
+    {
+        LogRecord record{RTG_LOG_SITE(LG_LOG), LogLevel::LL_WARNING};
+        if (record)
+        {
+            record << "dropped " << (dropped - reader.mDropped) << " log records because a thread's log ring was full";
+            Write(record.GetHeader(), record.GetData());
+        }
+        reader.mDropped = dropped;
+    }
+
+    return count;
+}
+
+void LogCore::RemoveFinishedReaders()
+{
+    for (auto it = mReaders.begin(); it != mReaders.end();)
+    {
+        const unsigned char* data;
+        if (it->mRing->IsClosed() && !it->mRing->Front(data))
+        {
+            std::lock_guard<std::mutex> lock(mRingsMutex);
+            mRings.erase(std::find(mRings.begin(), mRings.end(), it->mRing));
+            mRingsVersion.fetch_add(1, std::memory_order_release);
+            it = mReaders.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void LogCore::UpdateReaders()
+{
+    auto version = mRingsVersion.load(std::memory_order_acquire);
+    if (version == mReadersVersion)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mRingsMutex);
+    for (const auto& ring : mRings)
+    {
+        auto isRead = [&ring](const Reader& reader) { return reader.mRing == ring; };
+        if (std::none_of(mReaders.begin(), mReaders.end(), isRead))
+        {
+            mReaders.push_back(Reader{ring, ring->GetDropped()});
+        }
+    }
+    mReadersVersion = mRingsVersion.load(std::memory_order_relaxed);
+}
+
+void LogCore::UpdateThreshold()
+{
+    auto threshold = mIsEnabled ? static_cast<int>(mLevel) : static_cast<int>(LogLevel::LL_FATAL) + 1;
+    logThreshold.store(threshold, std::memory_order_relaxed);
+}
+
+void LogCore::Write(const LogRecordHeader& header, const unsigned char* data)
+{
+    if (mFormat == LogFormat::BINARY)
+    {
+        WriteBinary(header, data);
+    }
+    else
+    {
+        formatLogRecord(mStream, header, header.mSite->mChannel, data);
+    }
+}
+
+void LogCore::WriteBinary(const LogRecordHeader& header, const unsigned char* data)
+{
+    const LogSite* site = header.mSite;
+
+    mBuffer.clear();
+    if (mSites.insert(site).second)
+    {
+        auto channelLength = static_cast<unsigned char>(std::min<std::size_t>(std::strlen(site->mChannel), 255));
+        auto fileLength = static_cast<std::uint16_t>(std::min<std::size_t>(std::strlen(site->mFile), 65535));
+        mBuffer.push_back(static_cast<char>(BinaryLogEntry::SITE));
+        appendValue(mBuffer, reinterpret_cast<std::uint64_t>(site));
+        appendValue(mBuffer, static_cast<std::uint32_t>(site->mLine));
+        appendValue(mBuffer, channelLength);
+        mBuffer.append(site->mChannel, channelLength);
+        appendValue(mBuffer, fileLength);
+        mBuffer.append(site->mFile, fileLength);
+    }
+
+    mBuffer.push_back(static_cast<char>(BinaryLogEntry::RECORD));
+    appendValue(mBuffer, header.mTime);
+    appendValue(mBuffer, reinterpret_cast<std::uint64_t>(site));
+    appendValue(mBuffer, header.mLevel);
+    auto flagsPosition = mBuffer.size();
+    appendValue(mBuffer, header.mFlags);
+    auto sizePosition = mBuffer.size();
+    appendValue(mBuffer, std::uint16_t{0});
+    auto dataPosition = mBuffer.size();
+
+    // Enumerations are formatted here, since the function pointer that
+    // formats them means nothing outside this process, which can make the
+    // arguments longer than a record.
+    std::size_t offset = 0;
+    while (offset < header.mSize)
+    {
+        auto argumentSize = getArgumentSize(data + offset, header.mSize - offset);
+        if (argumentSize == 0)
+        {
+            break;
+        }
+
+        auto end = mBuffer.size();
+        if (static_cast<LogArgument>(data[offset]) == LogArgument::DEFERRED)
+        {
+            char text[255];
+            LogArgumentBuffer buffer{text, text + sizeof(text)};
+            std::ostream stream{&buffer};
+            const unsigned char* value = data + offset + 1;
+            readArgument<LogDeferredFormatter>(value)(stream, value + sizeof(LogDeferredFormatter));
+            mBuffer.push_back(static_cast<char>(LogArgument::STRING));
+            mBuffer.push_back(static_cast<char>(buffer.GetSize()));
+            mBuffer.append(text, buffer.GetSize());
+        }
+        else
+        {
+            mBuffer.append(reinterpret_cast<const char*>(data + offset), argumentSize);
+        }
+
+        if (mBuffer.size() - dataPosition > LOG_RECORD_DATA_SIZE)
+        {
+            mBuffer.resize(end);
+            mBuffer[flagsPosition] = static_cast<char>(header.mFlags | LOG_RECORD_TRUNCATED);
+            break;
+        }
+        offset += argumentSize;
+    }
+
+    auto size = static_cast<std::uint16_t>(mBuffer.size() - dataPosition);
+    std::memcpy(&mBuffer[sizePosition], &size, sizeof(size));
+
+    mStream.write(mBuffer.data(), static_cast<std::streamsize>(mBuffer.size()));
+}
+
+
+void LogCore::WriterThread()
+{
+    for (;;)
+    {
+        // Check for stopping first, so that everything logged before stop
+        // was called is written.
+        bool isStopping = mIsStopping.load(std::memory_order_acquire);
+
+        UpdateReaders();
+
+        std::size_t count = 0;
+        for (auto& reader : mReaders)
+        {
+            count += Drain(reader);
+        }
+
+        RemoveFinishedReaders();
+
+        if (count == 0)
+        {
+            if (isStopping)
+            {
+                break;
+            }
+            mStream.flush();
+            std::this_thread::sleep_for(LOG_WRITER_IDLE_SLEEP);
+        }
+    }
+
+    mStream.flush();
+}
+
+void setLogLevel(LogLevel level)
+{
+    getLogCore().SetLevel(level);
+}
+
+void setLoggingEnabled(bool enabled)
+{
+    getLogCore().SetEnabled(enabled);
+}
+
+void startLogging(const std::string& filename, LogFormat format)
+{
+    getLogCore().Start(filename, format);
+}
+
+void stopLogging()
+{
+    getLogCore().Stop();
+}
+
+void formatLogArguments(std::ostream& stream, const unsigned char* data, std::size_t size)
+{
+    std::size_t offset = 0;
+    while (offset < size)
+    {
+        auto argumentSize = getArgumentSize(data + offset, size - offset);
+        if (argumentSize == 0)
+        {
+            return;
+        }
+
+        const unsigned char* value = data + offset + 1;
+        switch (static_cast<LogArgument>(data[offset]))
+        {
+        case LogArgument::BOOL:
+            stream << (value[0] != 0);
+            break;
+        case LogArgument::CHAR:
+            stream << static_cast<char>(value[0]);
+            break;
+        case LogArgument::SIGNED:
+            stream << readArgument<std::int64_t>(value);
+            break;
+        case LogArgument::UNSIGNED:
+            stream << readArgument<std::uint64_t>(value);
+            break;
+        case LogArgument::DOUBLE:
+            stream << readArgument<double>(value);
+            break;
+        case LogArgument::STRING:
+            stream.write(reinterpret_cast<const char*>(value + 1), value[0]);
+            break;
+        case LogArgument::DEFERRED:
+            readArgument<LogDeferredFormatter>(value)(stream, value + sizeof(LogDeferredFormatter));
+            break;
+        }
+        offset += argumentSize;
+    }
+}
+
+void formatLogRecord(std::ostream& stream, const LogRecordHeader& header, const char* channel,
+                     const unsigned char* data)
+{
+    std::time_t seconds = header.mTime / 1000000000;
+    auto microseconds = static_cast<long>((header.mTime % 1000000000) / 1000);
+    std::tm localTime{};
+#ifdef _WIN32
+    localtime_s(&localTime, &seconds);
+#else
+    localtime_r(&seconds, &localTime);
+#endif
+
+    auto levelNumber = static_cast<std::size_t>(header.mLevel);
+    const char* level = (levelNumber < std::size(LOG_LEVEL_NAMES)) ? LOG_LEVEL_NAMES[levelNumber] : "?";
+
+    char prefix[256];
+    auto length = std::strftime(prefix, sizeof(prefix), "%Y-%m-%d %H:%M:%S", &localTime);
+    std::snprintf(prefix + length, sizeof(prefix) - length, ".%06ld [%-7s] [%s] ", microseconds, level, channel);
+
+    stream << prefix;
+    formatLogArguments(stream, data, header.mSize);
+    if (header.mFlags & LOG_RECORD_TRUNCATED)
+    {
+        stream << "...";
+    }
+    stream << '\n';
+}
+
+void publishLogRecord(const LogRecordHeader& header, const unsigned char* data)
+{
+    LogCore& core = getLogCore();
+    if (core.IsRunning())
+    {
+        getThreadLogRing().Push(header, data);
+    }
+    else
+    {
+        core.WriteToConsole(header, data);
+    }
+}
+
+std::ostream& getLogArgumentStream()
+{
+    thread_local std::ostream stream{nullptr};
+    return stream;
+}
+
+}
@@ -18,12 +18,16 @@
 #ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_LOGGING_H
 #define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_LOGGING_H
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <ostream>
-
-#include <boost/log/keywords/channel.hpp>
-#include <boost/log/sources/global_logger_storage.hpp>
-#include <boost/log/sources/record_ostream.hpp>
-#include <boost/log/sources/severity_channel_logger.hpp>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
 namespace ReadyTraderGo {
 
@@ -52,12 +56,316 @@ std::basic_ostream<C, T>& operator<<(std::basic_ostream<C, T>& strm, LogLevel lv
     return strm;
 }
 
+// Log statements don't format anything on the calling thread. Each RLOG
+// builds a fixed-size binary record on the stack holding a timestamp, the
+// address of a static LogSite (the record's format id) and the raw values
+// streamed into it, and pushes it onto a lock-free single producer, single
+// consumer ring belonging to the calling thread. A background thread
+// drains the rings and either formats the records into a text log or
+// writes them to a binary log, which logdecode renders later.
+//
+// Until startLogging is called (and after stopLogging) records are
+// formatted synchronously to std::clog instead.
+
+enum class LogFormat : unsigned char
+{
+    TEXT,
+    BINARY
+};
+
+// Where a log statement is, which together with its level and arguments is
+// everything needed to render it.
+struct LogSite
+{
+    const char* mChannel;
+    const char* mFile;
+    unsigned int mLine;
+};
+
+// How each argument is stored in a record: a LogArgument tag followed by
+// the value. Integers and doubles are 8 bytes, strings a one-byte length
+// followed by the characters. Enumerations are stored as their value plus
+// a pointer to the function that formats them, so they only ever appear in
+// the rings; everything else with an operator<< is formatted into the
+// record as a string.
+enum class LogArgument : unsigned char
+{
+    BOOL,
+    CHAR,
+    SIGNED,
+    UNSIGNED,
+    DOUBLE,
+    STRING,
+    DEFERRED
+};
+
+using LogDeferredFormatter = void (*)(std::ostream&, const unsigned char*);
+
+constexpr std::size_t LOG_RECORD_SIZE = 256;
+constexpr std::size_t LOG_RING_SIZE = 4096;
+
+// Set in LogRecordHeader::mFlags when arguments didn't fit in the record.
+constexpr std::uint8_t LOG_RECORD_TRUNCATED = 1;
+
+struct LogRecordHeader
+{
+    std::int64_t mTime;           // nanoseconds since the epoch
+    const LogSite* mSite;
+    std::uint16_t mSize;          // bytes of argument data
+    LogLevel mLevel;
+    std::uint8_t mFlags;
+};
+
+constexpr std::size_t LOG_RECORD_DATA_SIZE = LOG_RECORD_SIZE - sizeof(LogRecordHeader);
+
+// Binary logs start with BINARY_LOG_MAGIC (which appears again wherever a
+// later run appended to the file) followed by entries starting with a
+// BinaryLogEntry tag. A SITE entry (site id: 8, line: 4, channel length: 1,
+// channel, file length: 2, file) precedes the first record from each site
+// and a RECORD entry (time: 8, site id: 8, level: 1, flags: 1, size: 2,
+// argument data) holds a record whose arguments are all stored by value.
+// Numbers are in the byte order of the machine that wrote the log.
+constexpr char BINARY_LOG_MAGIC[8] = {'\x7f', 'R', 'T', 'G', 'L', 'O', 'G', '1'};
+
+enum class BinaryLogEntry : unsigned char
+{
+    SITE = 'S',
+    RECORD = 'R'
+};
+
+// Records below the threshold are discarded before any of their arguments
+// are evaluated. Use setLogLevel and setLoggingEnabled to change it.
+inline std::atomic<int> logThreshold{static_cast<int>(LogLevel::LL_DEBUG)};
+
+inline bool isLogLevelEnabled(LogLevel level)
+{
+    return static_cast<int>(level) >= logThreshold.load(std::memory_order_relaxed);
+}
+
+// Discard records below the given level.
+void setLogLevel(LogLevel level);
+
+// Turn logging off (or back on) altogether.
+void setLoggingEnabled(bool enabled);
+
+// Start the background thread writing records to the given file, which is
+// appended to. Throws ReadyTraderGoError if the file can't be opened.
+void startLogging(const std::string& filename, LogFormat format);
+
+// Write out every outstanding record and stop the background thread.
+void stopLogging();
+
+// Render a record's arguments, or a whole record the way the text log does.
+void formatLogArguments(std::ostream& stream, const unsigned char* data, std::size_t size);
+void formatLogRecord(std::ostream& stream, const LogRecordHeader& header, const char* channel,
+                     const unsigned char* data);
+
+// Hand a finished record to the calling thread's ring (or to the console
+// when the background thread isn't running).
+void publishLogRecord(const LogRecordHeader& header, const unsigned char* data);
+
+// The stream used to format arguments without a binary representation.
+std::ostream& getLogArgumentStream();
+
+// A stream buffer over the unused part of a record.
+class LogArgumentBuffer : public std::streambuf
+{
+public:
+    LogArgumentBuffer(char* begin, char* end) { setp(begin, end); }
+
+    std::size_t GetSize() const { return pptr() - pbase(); }
+    bool IsFull() const { return mIsFull; }
+
+protected:
+    int_type overflow(int_type) override
+    {
+        mIsFull = true;
+        return traits_type::eof();
+    }
+
+private:
+    bool mIsFull = false;
+};
+
+template<typename T>
+void formatDeferredLogArgument(std::ostream& stream, const unsigned char* data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    stream << value;
+}
+
+// A log record under construction, see RLOG.
+class LogRecord
+{
+public:
+    LogRecord(const LogSite* site, LogLevel level)
+    {
+        mIsOpen = isLogLevelEnabled(level);
+        if (mIsOpen)
+        {
+            auto now = std::chrono::system_clock::now().time_since_epoch();
+            mHeader.mTime = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+            mHeader.mSite = site;
+            mHeader.mSize = 0;
+            mHeader.mLevel = level;
+            mHeader.mFlags = 0;
+        }
+    }
+
+    // Log records can't be copied or moved
+    LogRecord(const LogRecord&) = delete;
+    void operator=(const LogRecord&) = delete;
+
+    explicit operator bool() const { return mIsOpen; }
+
+    void Commit()
+    {
+        publishLogRecord(mHeader, mData);
+        mIsOpen = false;
+    }
+
+    const LogRecordHeader& GetHeader() const { return mHeader; }
+    const unsigned char* GetData() const { return mData; }
+
+    template<typename T>
+    LogRecord& operator<<(const T& value)
+    {
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            WriteValue(LogArgument::BOOL, static_cast<unsigned char>(value));
+        }
+        else if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char>
+                           || std::is_same_v<T, unsigned char>)
+        {
+            WriteValue(LogArgument::CHAR, static_cast<char>(value));
+        }
+        else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+        {
+            WriteValue(LogArgument::SIGNED, static_cast<std::int64_t>(value));
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            WriteValue(LogArgument::UNSIGNED, static_cast<std::uint64_t>(value));
+        }
+        else if constexpr (std::is_floating_point_v<T> && sizeof(T) <= sizeof(double))
+        {
+            WriteValue(LogArgument::DOUBLE, static_cast<double>(value));
+        }
+        else if constexpr (std::is_enum_v<T> && sizeof(T) <= sizeof(std::uint64_t))
+        {
+            WriteDeferred(&formatDeferredLogArgument<T>, value);
+        }
+        else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+        {
+            WriteString(std::string_view(value));
+        }
+        else
+        {
+            WriteFormatted(value);
+        }
+        return *this;
+    }
+
+private:
+    // Once something hasn't fit, everything after it is dropped too.
+    bool Reserve(std::size_t size)
+    {
+        if ((mHeader.mFlags & LOG_RECORD_TRUNCATED) == 0 && mHeader.mSize + size <= LOG_RECORD_DATA_SIZE)
+        {
+            return true;
+        }
+        mHeader.mFlags |= LOG_RECORD_TRUNCATED;
+        return false;
+    }
+
+    template<typename T>
+    void WriteValue(LogArgument type, T value)
+    {
+        if (Reserve(1 + sizeof(value)))
+        {
+            mData[mHeader.mSize] = static_cast<unsigned char>(type);
+            std::memcpy(mData + mHeader.mSize + 1, &value, sizeof(value));
+            mHeader.mSize += 1 + sizeof(value);
+        }
+    }
+
+    template<typename T>
+    void WriteDeferred(LogDeferredFormatter formatter, T value)
+    {
+        if (Reserve(1 + sizeof(formatter) + sizeof(std::uint64_t)))
+        {
+            mData[mHeader.mSize] = static_cast<unsigned char>(LogArgument::DEFERRED);
+            std::memcpy(mData + mHeader.mSize + 1, &formatter, sizeof(formatter));
+            std::memcpy(mData + mHeader.mSize + 1 + sizeof(formatter), &value, sizeof(value));
+            mHeader.mSize += 1 + sizeof(formatter) + sizeof(std::uint64_t);
+        }
+    }
+
+    void WriteString(std::string_view value)
+    {
+        if (!Reserve(2))
+        {
+            return;
+        }
+        std::size_t length = value.size();
+        if (mHeader.mSize + 2 + length > LOG_RECORD_DATA_SIZE)
+        {
+            length = LOG_RECORD_DATA_SIZE - mHeader.mSize - 2;
+            mHeader.mFlags |= LOG_RECORD_TRUNCATED;
+        }
+        mData[mHeader.mSize] = static_cast<unsigned char>(LogArgument::STRING);
+        mData[mHeader.mSize + 1] = static_cast<unsigned char>(length);
+        std::memcpy(mData + mHeader.mSize + 2, value.data(), length);
+        mHeader.mSize += 2 + length;
+    }
+
+    template<typename T>
+    void WriteFormatted(const T& value)
+    {
+        if (!Reserve(2))
+        {
+            return;
+        }
+        auto begin = reinterpret_cast<char*>(mData + mHeader.mSize + 2);
+        LogArgumentBuffer buffer{begin, begin + (LOG_RECORD_DATA_SIZE - mHeader.mSize - 2)};
+        std::ostream& stream = getLogArgumentStream();
+        std::streambuf* previous = stream.rdbuf(&buffer);
+        stream << value;
+        stream.rdbuf(previous);
+        if (buffer.IsFull())
+        {
+            mHeader.mFlags |= LOG_RECORD_TRUNCATED;
+        }
+        mData[mHeader.mSize] = static_cast<unsigned char>(LogArgument::STRING);
+        mData[mHeader.mSize + 1] = static_cast<unsigned char>(buffer.GetSize());
+        mHeader.mSize += 2 + buffer.GetSize();
+    }
+
+    bool mIsOpen;
+    LogRecordHeader mHeader;
+    unsigned char mData[LOG_RECORD_DATA_SIZE];
+};
+
+// Declares a logger for a channel, for use with RLOG.
 #define RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(loggerName, channelName)\
-    BOOST_LOG_INLINE_GLOBAL_LOGGER_CTOR_ARGS(loggerName,\
-        boost::log::sources::severity_channel_logger<ReadyTraderGo::LogLevel>,\
-        (boost::log::keywords::channel = (channelName)));
+    struct loggerName\
+    {\
+        static constexpr const char* CHANNEL = (channelName);\
+    };
+
+#define RTG_LOG_SITE(loggerName)\
+    ([]() -> const ReadyTraderGo::LogSite* {\
+        static constexpr ReadyTraderGo::LogSite site{loggerName::CHANNEL, __FILE__, __LINE__};\
+        return &site;\
+    }())
 
-#define RLOG(loggerName, logLevel) BOOST_LOG_SEV(loggerName::get(), (logLevel))
+// Usage: RLOG(LG_XYZ, LogLevel::LL_INFO) << "value=" << value;
+// Nothing to the right of RLOG is evaluated unless the level is enabled.
+#define RLOG(loggerName, logLevel)\
+    for (ReadyTraderGo::LogRecord rtgLogRecord{RTG_LOG_SITE(loggerName), (logLevel)};\
+         rtgLogRecord; rtgLogRecord.Commit())\
+        rtgLogRecord
 }
 
 #endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_LOGGING_H
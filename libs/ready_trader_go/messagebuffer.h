@@ -0,0 +1,104 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_MESSAGEBUFFER_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_MESSAGEBUFFER_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+
+namespace ReadyTraderGo {
+
+constexpr std::size_t MESSAGE_BUFFER_ALIGNMENT = 64;
+
+// A fixed-capacity, cache-aligned byte buffer that is allocated once.
+//
+// Data is appended at the back and consumed from the front. Rather than
+// wrapping around, the buffer rewinds to the start whenever it is emptied
+// and can be compacted (moving any unconsumed bytes to the start) to make
+// room at the back. This keeps every message contiguous so it can be
+// serialised or parsed in place.
+class MessageBuffer
+{
+public:
+    explicit MessageBuffer(std::size_t capacity)
+        : mCapacity(capacity),
+          mData(static_cast<unsigned char*>(std::aligned_alloc(MESSAGE_BUFFER_ALIGNMENT, roundUp(capacity))))
+    {
+        if (!mData)
+        {
+            throw std::bad_alloc();
+        }
+    }
+
+    std::size_t GetCapacity() const { return mCapacity; }
+
+    // Bytes that have been committed but not yet consumed.
+    unsigned char const* ReadData() const { return mData.get() + mBegin; }
+    std::size_t ReadSize() const { return mEnd - mBegin; }
+
+    // Space available at the back of the buffer.
+    unsigned char* WriteData() { return mData.get() + mEnd; }
+    std::size_t WriteSize() const { return mCapacity - mEnd; }
+
+    void Commit(std::size_t size) { mEnd += size; }
+
+    void Consume(std::size_t size)
+    {
+        mBegin += size;
+        if (mBegin == mEnd)
+        {
+            mBegin = mEnd = 0;
+        }
+    }
+
+    // Move any unconsumed bytes to the start of the buffer. Must not be
+    // called while an asynchronous operation is using the buffer.
+    void Compact()
+    {
+        if (mBegin != 0)
+        {
+            std::memmove(mData.get(), mData.get() + mBegin, mEnd - mBegin);
+            mEnd -= mBegin;
+            mBegin = 0;
+        }
+    }
+
+private:
+    struct Free
+    {
+        void operator()(unsigned char* data) const { std::free(data); }
+    };
+
+    // aligned_alloc requires the size to be a multiple of the alignment.
+    static std::size_t roundUp(std::size_t size)
+    {
+        return (size + MESSAGE_BUFFER_ALIGNMENT - 1) & ~(MESSAGE_BUFFER_ALIGNMENT - 1);
+    }
+
+    std::size_t mCapacity;
+    std::unique_ptr<unsigned char, Free> mData;
+    std::size_t mBegin = 0;
+    std::size_t mEnd = 0;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_MESSAGEBUFFER_H
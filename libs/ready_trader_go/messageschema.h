@@ -0,0 +1,300 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_MESSAGESCHEMA_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_MESSAGESCHEMA_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <boost/endian/conversion.hpp>
+
+#include "connectivitytypes.h"
+#include "fixedstring.h"
+#include "toplevels.h"
+
+namespace ReadyTraderGo {
+
+// Message bodies are described by a list of fields, from which the size,
+// field offsets, Serialise and Deserialise are all generated at compile
+// time. The fields are ByteField, LongField, StringField and TopLevelsField;
+// they are packed with no padding, in network byte order, and are read and
+// written with memcpy so they may sit at any alignment.
+//
+//     struct CancelMessage : SerialisableMessage<CancelMessage>
+//     {
+//         unsigned long mClientOrderId = 0;
+//
+//         using Schema = MessageSchema<LongField<&CancelMessage::mClientOrderId>>;
+//     };
+//
+// Each field also has a Python struct format code, so a schema can be
+// checked against the format the Python exchange uses with MatchesFormat.
+
+namespace Detail {
+
+template<typename T>
+struct MemberPointerTraits;
+
+template<typename C, typename T>
+struct MemberPointerTraits<T C::*>
+{
+    using ClassType = C;
+    using MemberType = T;
+};
+
+template<auto Member>
+using MemberType = typename MemberPointerTraits<decltype(Member)>::MemberType;
+
+}
+
+inline std::uint32_t readLong(unsigned char const* data)
+{
+    std::uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return boost::endian::big_to_native(value);
+}
+
+inline void writeLong(unsigned char* buf, std::uint32_t value)
+{
+    value = boost::endian::native_to_big(value);
+    std::memcpy(buf, &value, sizeof(value));
+}
+
+// A single byte holding an enumeration or small integer (Python "B").
+template<auto Member>
+struct ByteField
+{
+    static constexpr std::size_t SIZE = 1;
+    static constexpr std::size_t COUNT = 1;
+    static constexpr char CODE = 'B';
+
+    template<typename M>
+    static void Read(M& message, unsigned char const* data)
+    {
+        message.*Member = static_cast<Detail::MemberType<Member>>(*data);
+    }
+
+    template<typename M>
+    static void Write(const M& message, unsigned char* buf)
+    {
+        *buf = static_cast<unsigned char>(message.*Member);
+    }
+};
+
+// A 32-bit integer, signed if the member is (Python "I" or "i").
+template<auto Member>
+struct LongField
+{
+    static constexpr std::size_t SIZE = 4;
+    static constexpr std::size_t COUNT = 1;
+    static constexpr char CODE = std::is_signed_v<Detail::MemberType<Member>> ? 'i' : 'I';
+
+    template<typename M>
+    static void Read(M& message, unsigned char const* data)
+    {
+        if constexpr (std::is_signed_v<Detail::MemberType<Member>>)
+        {
+            message.*Member = static_cast<std::int32_t>(readLong(data));
+        }
+        else
+        {
+            message.*Member = readLong(data);
+        }
+    }
+
+    template<typename M>
+    static void Write(const M& message, unsigned char* buf)
+    {
+        writeLong(buf, static_cast<std::uint32_t>(message.*Member));
+    }
+};
+
+// A FixedString sent in as many bytes as it can hold, padded with zeroes
+// (Python "ns").
+template<auto Member>
+struct StringField
+{
+    static constexpr std::size_t SIZE = Detail::MemberType<Member>::CAPACITY;
+    static constexpr std::size_t COUNT = SIZE;
+    static constexpr char CODE = 's';
+
+    template<typename M>
+    static void Read(M& message, unsigned char const* data)
+    {
+        (message.*Member).AssignPadded(reinterpret_cast<char const*>(data));
+    }
+
+    template<typename M>
+    static void Write(const M& message, unsigned char* buf)
+    {
+        const auto& value = message.*Member;
+        std::memcpy(buf, value.data(), value.size());
+        std::memset(buf + value.size(), 0, SIZE - value.size());
+    }
+};
+
+// The ask prices, ask volumes, bid prices and bid volumes of the top
+// levels (Python "20I"), converted all at once by decodeTopLevels and
+// encodeTopLevels.
+template<auto AskPrices, auto AskVolumes, auto BidPrices, auto BidVolumes>
+struct TopLevelsField
+{
+    static constexpr std::size_t SIZE = TOP_LEVELS_SIZE;
+    static constexpr std::size_t COUNT = 4 * TOP_LEVEL_COUNT;
+    static constexpr char CODE = 'I';
+
+    template<typename M>
+    static void Read(M& message, unsigned char const* data)
+    {
+        decodeTopLevels(data, message.*AskPrices, message.*AskVolumes, message.*BidPrices, message.*BidVolumes);
+    }
+
+    template<typename M>
+    static void Write(const M& message, unsigned char* buf)
+    {
+        encodeTopLevels(message.*AskPrices, message.*AskVolumes, message.*BidPrices, message.*BidVolumes, buf);
+    }
+};
+
+template<typename... Fields>
+struct MessageSchema
+{
+    static constexpr std::size_t FIELD_COUNT = sizeof...(Fields);
+    static constexpr std::size_t SIZE = (Fields::SIZE + ... + 0);
+
+    // The offset of each field from the start of the message body.
+    static constexpr std::array<std::size_t, FIELD_COUNT> OFFSETS = []
+    {
+        std::array<std::size_t, FIELD_COUNT> offsets{};
+        const std::size_t sizes[] = {Fields::SIZE...};
+        for (std::size_t i = 1; i < FIELD_COUNT; ++i)
+        {
+            offsets[i] = offsets[i - 1] + sizes[i - 1];
+        }
+        return offsets;
+    }();
+
+    template<typename M>
+    static void Read(M& message, unsigned char const* data)
+    {
+        Read(message, data, std::index_sequence_for<Fields...>{});
+    }
+
+    template<typename M>
+    static void Write(const M& message, unsigned char* buf)
+    {
+        Write(message, buf, std::index_sequence_for<Fields...>{});
+    }
+
+    // Return true if the fields are, in order, those of the given Python
+    // struct format (e.g. "!IBII"). Repeat counts may span several fields.
+    static constexpr bool MatchesFormat(std::string_view format);
+
+private:
+    template<typename M, std::size_t... I>
+    static void Read(M& message, unsigned char const* data, std::index_sequence<I...>)
+    {
+        (Fields::Read(message, data + OFFSETS[I]), ...);
+    }
+
+    template<typename M, std::size_t... I>
+    static void Write(const M& message, unsigned char* buf, std::index_sequence<I...>)
+    {
+        (Fields::Write(message, buf + OFFSETS[I]), ...);
+    }
+};
+
+template<typename... Fields>
+constexpr bool MessageSchema<Fields...>::MatchesFormat(std::string_view format)
+{
+    const char codes[] = {Fields::CODE..., '\0'};
+    const std::size_t counts[] = {Fields::COUNT..., 0};
+
+    std::size_t position = (!format.empty() && format[0] == '!') ? 1 : 0;
+    std::size_t remaining = 0;
+    char code = '\0';
+
+    for (std::size_t i = 0; i != FIELD_COUNT; ++i)
+    {
+        std::size_t needed = counts[i];
+        while (needed != 0)
+        {
+            if (remaining == 0)
+            {
+                if (position == format.size())
+                {
+                    return false;
+                }
+                std::size_t count = 0;
+                bool hasCount = false;
+                while (position != format.size() && format[position] >= '0' && format[position] <= '9')
+                {
+                    count = count * 10 + (format[position++] - '0');
+                    hasCount = true;
+                }
+                if (position == format.size())
+                {
+                    return false;
+                }
+                code = format[position++];
+                remaining = hasCount ? count : 1;
+                // A string is a single item whatever its length.
+                if (code == 's' && remaining != needed)
+                {
+                    return false;
+                }
+            }
+            if (code != codes[i])
+            {
+                return false;
+            }
+            const std::size_t taken = std::min(needed, remaining);
+            needed -= taken;
+            remaining -= taken;
+        }
+    }
+
+    return remaining == 0 && position == format.size();
+}
+
+// Implements ISerialisable from the message's Schema.
+template<typename T>
+struct SerialisableMessage : ISerialisable
+{
+    std::size_t Size() const noexcept final { return T::Schema::SIZE; }
+
+    void Deserialise(unsigned char const* data, std::size_t) final
+    {
+        T::Schema::Read(static_cast<T&>(*this), data);
+    }
+
+    void Serialise(unsigned char* buf) const final
+    {
+        T::Schema::Write(static_cast<const T&>(*this), buf);
+    }
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_MESSAGESCHEMA_H
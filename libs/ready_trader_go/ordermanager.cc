@@ -0,0 +1,129 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include "ordermanager.h"
+
+namespace ReadyTraderGo {
+
+unsigned long OrderManager::NextClientOrderId()
+{
+    if (mActiveOrderCount == ORDER_MANAGER_CAPACITY)
+    {
+        return 0;
+    }
+
+    // Skip the ids of slots still in use. There is a free slot, so this
+    // stops within one lap of the slots.
+    while (mSlots[mNextClientOrderId & SLOT_MASK].IsActive() || mNextClientOrderId == 0)
+    {
+        ++mNextClientOrderId;
+    }
+    return mNextClientOrderId;
+}
+
+ManagedOrder* OrderManager::Add(unsigned long clientOrderId,
+                                Instrument instrument,
+                                Side side,
+                                unsigned long price,
+                                unsigned long volume,
+                                Lifespan lifespan,
+                                std::chrono::steady_clock::time_point sendTime)
+{
+    if (clientOrderId >= mNextClientOrderId)
+    {
+        mNextClientOrderId = clientOrderId + 1;
+    }
+
+    ManagedOrder& order = mSlots[clientOrderId & SLOT_MASK];
+    if (order.IsActive() || clientOrderId == 0)
+    {
+        return nullptr;
+    }
+
+    order = ManagedOrder();
+    order.mClientOrderId = clientOrderId;
+    order.mInstrument = instrument;
+    order.mSide = side;
+    order.mLifespan = lifespan;
+    order.mState = OrderState::PENDING;
+    order.mPrice = price;
+    order.mVolume = volume;
+    order.mRemainingVolume = volume;
+    order.mSendTime = sendTime;
+    order.mUpdateTime = sendTime;
+    ++mActiveOrderCount;
+    if (instrument == Instrument::ETF)
+    {
+        ++mActiveEtfOrderCount;
+        mActiveEtfVolumes[static_cast<std::size_t>(side)] += volume;
+    }
+    return &order;
+}
+
+void OrderManager::Finish(ManagedOrder& order, OrderState state)
+{
+    // The remaining volume has already been set to zero.
+    if (order.IsActive())
+    {
+        --mActiveOrderCount;
+        if (order.mInstrument == Instrument::ETF)
+        {
+            --mActiveEtfOrderCount;
+        }
+    }
+    order.mState = state;
+}
+
+void OrderManager::CancelSent(unsigned long clientOrderId)
+{
+    ManagedOrder* order = Find(clientOrderId);
+    if (order && order->IsActive())
+    {
+        order->mState = OrderState::CANCELLING;
+    }
+}
+
+void OrderManager::ErrorReceived(unsigned long clientOrderId, std::chrono::steady_clock::time_point receiveTime)
+{
+    // Only an order the exchange has not acknowledged can have been refused:
+    // an error about an acknowledged order leaves it as it is.
+    ManagedOrder* order = Find(clientOrderId);
+    if (order && order->IsActive() && !order->mIsAcknowledged)
+    {
+        SetRemainingVolume(*order, 0);
+        order->mUpdateTime = receiveTime;
+        Finish(*order, OrderState::REJECTED);
+    }
+}
+
+void OrderManager::HedgeFilled(unsigned long clientOrderId,
+                               unsigned long price,
+                               unsigned long volume,
+                               std::chrono::steady_clock::time_point receiveTime)
+{
+    if (ManagedOrder* order = Find(clientOrderId))
+    {
+        order->mFillPrice = price;
+        order->mFilledVolume += volume;
+        SetRemainingVolume(*order, 0);
+        order->mUpdateTime = receiveTime;
+        mFuturePosition += (order->mSide == Side::BUY) ? static_cast<long>(volume) : -static_cast<long>(volume);
+        Finish(*order, OrderState::COMPLETE);
+    }
+}
+
+}
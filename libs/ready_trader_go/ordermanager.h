@@ -0,0 +1,247 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_ORDERMANAGER_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_ORDERMANAGER_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+
+#include "types.h"
+
+namespace ReadyTraderGo {
+
+// The number of orders an OrderManager can keep track of at once. It must
+// be a power of two and should be well above the exchange's active order
+// limit, because a slot is only reused once its order is finished.
+constexpr std::size_t ORDER_MANAGER_CAPACITY = 256;
+
+enum class OrderState : unsigned char
+{
+    PENDING,     // sent, not yet acknowledged by the exchange
+    LIVE,        // acknowledged and not yet finished
+    CANCELLING,  // a cancel has been sent
+    COMPLETE,    // filled, cancelled or expired (remaining volume is zero)
+    REJECTED     // refused by the exchange with an error
+};
+
+template<typename C, typename T>
+std::basic_ostream<C, T>& operator<<(std::basic_ostream<C, T>& strm, OrderState state)
+{
+    static const char* const names[] = {"Pending", "Live", "Cancelling", "Complete", "Rejected"};
+    strm << names[static_cast<std::size_t>(state)];
+    return strm;
+}
+
+struct ManagedOrder
+{
+    bool IsActive() const { return mState == OrderState::PENDING || mState == OrderState::LIVE
+                                   || mState == OrderState::CANCELLING; }
+
+    unsigned long mClientOrderId = 0;
+    Instrument mInstrument = Instrument::ETF;
+    Side mSide = Side::BUY;
+    Lifespan mLifespan = Lifespan::GOOD_FOR_DAY;
+    OrderState mState = OrderState::COMPLETE;
+    bool mIsAcknowledged = false;
+
+    // Prices are in cents. The fill price is that of the latest fill, or the
+    // average price of a hedge.
+    unsigned long mPrice = 0;
+    unsigned long mVolume = 0;
+    unsigned long mFilledVolume = 0;
+    unsigned long mRemainingVolume = 0;
+    unsigned long mFillPrice = 0;
+    long mFees = 0;
+
+    // When the order was sent and when a message about it last arrived.
+    std::chrono::steady_clock::time_point mSendTime;
+    std::chrono::steady_clock::time_point mUpdateTime;
+};
+
+// Keeps track of an auto-trader's orders and the positions they have built.
+//
+// The order manager hands out client order ids, in increasing order as the
+// exchange requires. Orders live in a fixed array of slots indexed by
+// the low bits of the client order id, so a lookup is a mask and a compare
+// and nothing is allocated once the manager exists. The rest of the id acts
+// as a generation count: an id whose order has finished and whose slot has
+// since been reused is no longer found. When the next id would land on the
+// slot of an active order, that id is skipped.
+//
+// BaseAutoTrader feeds every order it sends and every execution message it
+// receives to its order manager before calling the message handlers, so
+// the handlers see the orders and positions already updated.
+class OrderManager
+{
+public:
+    // Return the client order id to use for the next order or hedge, or zero
+    // if every slot holds an active order.
+    unsigned long NextClientOrderId();
+
+    // Track an order or hedge that has been sent. Later ids returned by
+    // NextClientOrderId will be greater. Returns nullptr (and the order is
+    // not tracked) if its slot holds another active order.
+    ManagedOrder* Add(unsigned long clientOrderId,
+                      Instrument instrument,
+                      Side side,
+                      unsigned long price,
+                      unsigned long volume,
+                      Lifespan lifespan,
+                      std::chrono::steady_clock::time_point sendTime);
+
+    // Whether Add would track an order with the given client order id, i.e.
+    // the id is not zero and its slot holds no active order.
+    bool CanAdd(unsigned long clientOrderId) const;
+
+    // Return the order with the given client order id, or nullptr if it is
+    // unknown. A finished order can be found until its slot is reused.
+    ManagedOrder* Find(unsigned long clientOrderId);
+    const ManagedOrder* Find(unsigned long clientOrderId) const;
+
+    // Active orders are those that are pending, live or being cancelled.
+    // The ETF counts cover what the exchange's active order count and
+    // active volume limits apply to, assuming the worst for orders whose
+    // fate is not yet known.
+    std::size_t GetActiveOrderCount() const { return mActiveOrderCount; }
+    std::size_t GetActiveEtfOrderCount() const { return mActiveEtfOrderCount; }
+    unsigned long GetActiveEtfVolume() const { return mActiveEtfVolumes[0] + mActiveEtfVolumes[1]; }
+    unsigned long GetActiveEtfVolume(Side side) const { return mActiveEtfVolumes[static_cast<std::size_t>(side)]; }
+    unsigned long GetLastClientOrderId() const { return mNextClientOrderId - 1; }
+
+    // Positions built by the fills of the orders and hedges tracked.
+    long GetEtfPosition() const { return mEtfPosition; }
+    long GetFuturePosition() const { return mFuturePosition; }
+
+    // Call fn for each active order, in no particular order.
+    template<typename Fn>
+    void ForEachActiveOrder(Fn fn) const;
+
+    // Updates for messages sent and received.
+    void CancelSent(unsigned long clientOrderId);
+    void ErrorReceived(unsigned long clientOrderId, std::chrono::steady_clock::time_point receiveTime);
+    void HedgeFilled(unsigned long clientOrderId,
+                     unsigned long price,
+                     unsigned long volume,
+                     std::chrono::steady_clock::time_point receiveTime);
+    void OrderFilled(unsigned long clientOrderId,
+                     unsigned long price,
+                     unsigned long volume,
+                     std::chrono::steady_clock::time_point receiveTime);
+    void OrderStatus(unsigned long clientOrderId,
+                     unsigned long fillVolume,
+                     unsigned long remainingVolume,
+                     long fees,
+                     std::chrono::steady_clock::time_point receiveTime);
+
+private:
+    static constexpr unsigned long SLOT_MASK = ORDER_MANAGER_CAPACITY - 1;
+    static_assert((ORDER_MANAGER_CAPACITY & SLOT_MASK) == 0, "ORDER_MANAGER_CAPACITY must be a power of two");
+
+    void Finish(ManagedOrder& order, OrderState state);
+    void SetRemainingVolume(ManagedOrder& order, unsigned long remainingVolume);
+
+    std::array<ManagedOrder, ORDER_MANAGER_CAPACITY> mSlots{};
+    unsigned long mNextClientOrderId = 1;
+    std::size_t mActiveOrderCount = 0;
+    std::size_t mActiveEtfOrderCount = 0;
+    std::array<unsigned long, 2> mActiveEtfVolumes{};
+    long mEtfPosition = 0;
+    long mFuturePosition = 0;
+};
+
+inline bool OrderManager::CanAdd(unsigned long clientOrderId) const
+{
+    return clientOrderId != 0 && !mSlots[clientOrderId & SLOT_MASK].IsActive();
+}
+
+inline ManagedOrder* OrderManager::Find(unsigned long clientOrderId)
+{
+    ManagedOrder& order = mSlots[clientOrderId & SLOT_MASK];
+    return (order.mClientOrderId == clientOrderId && clientOrderId != 0) ? &order : nullptr;
+}
+
+inline const ManagedOrder* OrderManager::Find(unsigned long clientOrderId) const
+{
+    const ManagedOrder& order = mSlots[clientOrderId & SLOT_MASK];
+    return (order.mClientOrderId == clientOrderId && clientOrderId != 0) ? &order : nullptr;
+}
+
+template<typename Fn>
+void OrderManager::ForEachActiveOrder(Fn fn) const
+{
+    for (const ManagedOrder& order : mSlots)
+    {
+        if (order.IsActive())
+        {
+            fn(order);
+        }
+    }
+}
+
+inline void OrderManager::SetRemainingVolume(ManagedOrder& order, unsigned long remainingVolume)
+{
+    if (order.mInstrument == Instrument::ETF && order.IsActive())
+    {
+        unsigned long& activeVolume = mActiveEtfVolumes[static_cast<std::size_t>(order.mSide)];
+        activeVolume = activeVolume - order.mRemainingVolume + remainingVolume;
+    }
+    order.mRemainingVolume = remainingVolume;
+}
+
+inline void OrderManager::OrderFilled(unsigned long clientOrderId,
+                                      unsigned long price,
+                                      unsigned long volume,
+                                      std::chrono::steady_clock::time_point receiveTime)
+{
+    if (ManagedOrder* order = Find(clientOrderId))
+    {
+        order->mFillPrice = price;
+        order->mUpdateTime = receiveTime;
+        mEtfPosition += (order->mSide == Side::BUY) ? static_cast<long>(volume) : -static_cast<long>(volume);
+    }
+}
+
+inline void OrderManager::OrderStatus(unsigned long clientOrderId,
+                                      unsigned long fillVolume,
+                                      unsigned long remainingVolume,
+                                      long fees,
+                                      std::chrono::steady_clock::time_point receiveTime)
+{
+    if (ManagedOrder* order = Find(clientOrderId))
+    {
+        order->mFilledVolume = fillVolume;
+        SetRemainingVolume(*order, remainingVolume);
+        order->mFees = fees;
+        order->mUpdateTime = receiveTime;
+        order->mIsAcknowledged = true;
+        if (remainingVolume == 0)
+        {
+            Finish(*order, OrderState::COMPLETE);
+        }
+        else if (order->mState == OrderState::PENDING)
+        {
+            order->mState = OrderState::LIVE;
+        }
+    }
+}
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_ORDERMANAGER_H
@@ -0,0 +1,40 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include "pretradelimits.h"
+
+namespace ReadyTraderGo {
+
+void PreTradeLimits::Configure(const PreTradeLimitsConfig& config)
+{
+    mConfig = config;
+    mSendTimes.assign(config.mMessageFrequencyLimit, 0.0);
+    mSendTimeCount = 0;
+    mNextSendTime = 0;
+}
+
+void PreTradeLimits::WriteTo(std::ostream& stream) const
+{
+    stream << "pre-trade rejections:";
+    for (std::size_t i = 0; i != PRE_TRADE_REASON_COUNT; ++i)
+    {
+        stream << ' ' << static_cast<PreTradeReason>(i) << '=' << mRejectCounts[i];
+    }
+    stream << " deferred=" << mDeferredCount << '\n';
+}
+
+}
@@ -0,0 +1,231 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_PRETRADELIMITS_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_PRETRADELIMITS_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include "ordermanager.h"
+#include "types.h"
+
+namespace ReadyTraderGo {
+
+// The reasons a message can be stopped before it is sent.
+enum class PreTradeReason : unsigned char
+{
+    ACTIVE_ORDER_COUNT,
+    ACTIVE_VOLUME,
+    POSITION,
+    MESSAGE_FREQUENCY,
+    ORDER_MANAGER_FULL,
+    SEND_BUFFER_FULL
+};
+constexpr std::size_t PRE_TRADE_REASON_COUNT = 6;
+
+// How much longer than the message frequency interval a message must be
+// gone for before it no longer counts, in seconds.
+constexpr double MESSAGE_FREQUENCY_MARGIN = 1e-6;
+
+template<typename C, typename T>
+std::basic_ostream<C, T>& operator<<(std::basic_ostream<C, T>& strm, PreTradeReason reason)
+{
+    static const char* const names[PRE_TRADE_REASON_COUNT] = {"active_order_count", "active_volume", "position",
+                                                              "message_frequency", "order_manager_full",
+                                                              "send_buffer_full"};
+    strm << names[static_cast<std::size_t>(reason)];
+    return strm;
+}
+
+// The limits checked before each message is sent. The defaults are those
+// of the exchange; the message frequency is measured by the exchange when
+// messages arrive, so a trader that sends in bursts may want some headroom.
+// A message frequency limit of zero means no limit.
+struct PreTradeLimitsConfig
+{
+    void readFromPropertyTree(const boost::property_tree::ptree& tree)
+    {
+        mIsEnabled = tree.get<bool>("Enabled", mIsEnabled);
+        mActiveOrderCountLimit = tree.get<std::size_t>("ActiveOrderCountLimit", mActiveOrderCountLimit);
+        mActiveVolumeLimit = tree.get<unsigned long>("ActiveVolumeLimit", mActiveVolumeLimit);
+        mPositionLimit = tree.get<long>("PositionLimit", mPositionLimit);
+        mMessageFrequencyInterval = tree.get<double>("MessageFrequencyInterval", mMessageFrequencyInterval);
+        mMessageFrequencyLimit = tree.get<std::size_t>("MessageFrequencyLimit", mMessageFrequencyLimit);
+    }
+
+    bool mIsEnabled = true;
+    std::size_t mActiveOrderCountLimit = 10;
+    unsigned long mActiveVolumeLimit = 200;
+    long mPositionLimit = 100;
+    double mMessageFrequencyInterval = 1.0;
+    std::size_t mMessageFrequencyLimit = 50;
+};
+
+// Checks messages against the exchange's limits before they are sent, so
+// that an order the exchange would refuse, or one whose fills could breach
+// the position limit, costs nothing, and the message frequency limit is
+// never breached.
+//
+// Active orders, active volume and positions come from the order manager.
+// The position check assumes every active order on the same side is filled.
+// The message frequency limit uses the same sliding window as the exchange,
+// kept as a ring holding the send times of the last so many messages, so
+// every check takes constant time.
+class PreTradeLimits
+{
+public:
+    PreTradeLimits() { Configure(PreTradeLimitsConfig()); }
+
+    void Configure(const PreTradeLimitsConfig& config);
+    const PreTradeLimitsConfig& GetConfig() const { return mConfig; }
+
+    // Each check returns true if the message may be sent, in which case it
+    // counts towards the message frequency, and otherwise records the reason.
+    bool CheckAmend(double now);
+    bool CheckCancel(double now);
+    bool CheckHedge(const OrderManager& orders, Side side, unsigned long volume, double now);
+    bool CheckInsert(const OrderManager& orders, Side side, unsigned long volume, double now);
+
+    // Count a message sent without being checked (such as a login) towards
+    // the message frequency.
+    void MessageSent(double now);
+
+    // Record a message stopped for a reason found elsewhere, or held back
+    // to be sent later.
+    void Reject(PreTradeReason reason) { ++mRejectCounts[static_cast<std::size_t>(reason)]; }
+    void Defer() { ++mDeferredCount; }
+
+    // True if a message sent now would be within the message frequency limit.
+    bool IsWithinMessageFrequency(double now) const;
+
+    unsigned long GetRejectCount(PreTradeReason reason) const
+    {
+        return mRejectCounts[static_cast<std::size_t>(reason)];
+    }
+    unsigned long GetDeferredCount() const { return mDeferredCount; }
+
+    // Write the number of messages stopped for each reason, and the number
+    // held back, on one line.
+    void WriteTo(std::ostream& stream) const;
+
+private:
+    bool Check(PreTradeReason reason, bool isWithinLimit);
+    bool CheckMessageFrequency(double now);
+
+    PreTradeLimitsConfig mConfig;
+    std::array<unsigned long, PRE_TRADE_REASON_COUNT> mRejectCounts{};
+    unsigned long mDeferredCount = 0;
+
+    // The send times of the most recent messages, oldest at mNextSendTime
+    // once the ring is full.
+    std::vector<double> mSendTimes;
+    std::size_t mSendTimeCount = 0;
+    std::size_t mNextSendTime = 0;
+};
+
+inline bool PreTradeLimits::Check(PreTradeReason reason, bool isWithinLimit)
+{
+    if (!isWithinLimit)
+    {
+        ++mRejectCounts[static_cast<std::size_t>(reason)];
+    }
+    return isWithinLimit;
+}
+
+inline bool PreTradeLimits::IsWithinMessageFrequency(double now) const
+{
+    if (mSendTimeCount < mSendTimes.size() || mSendTimes.empty())
+    {
+        return true;
+    }
+
+    // The exchange lets a message (within rounding) exactly one interval old
+    // leave the window, but it sees the times later and rounds them
+    // differently, so here such a message has to be a little older.
+    const double oldest = mSendTimes[mNextSendTime];
+    const double windowStart = now - mConfig.mMessageFrequencyInterval;
+    return oldest < windowStart - MESSAGE_FREQUENCY_MARGIN;
+}
+
+inline void PreTradeLimits::MessageSent(double now)
+{
+    if (!mSendTimes.empty())
+    {
+        mSendTimes[mNextSendTime] = now;
+        mNextSendTime = (mNextSendTime + 1 == mSendTimes.size()) ? 0 : mNextSendTime + 1;
+        mSendTimeCount = std::min(mSendTimeCount + 1, mSendTimes.size());
+    }
+}
+
+inline bool PreTradeLimits::CheckMessageFrequency(double now)
+{
+    if (!Check(PreTradeReason::MESSAGE_FREQUENCY, IsWithinMessageFrequency(now)))
+    {
+        return false;
+    }
+    MessageSent(now);
+    return true;
+}
+
+inline bool PreTradeLimits::CheckAmend(double now)
+{
+    return !mConfig.mIsEnabled || CheckMessageFrequency(now);
+}
+
+inline bool PreTradeLimits::CheckCancel(double now)
+{
+    return !mConfig.mIsEnabled || CheckMessageFrequency(now);
+}
+
+inline bool PreTradeLimits::CheckHedge(const OrderManager& orders, Side side, unsigned long volume, double now)
+{
+    if (!mConfig.mIsEnabled)
+    {
+        return true;
+    }
+
+    const long delta = (side == Side::BUY) ? static_cast<long>(volume) : -static_cast<long>(volume);
+    const long position = orders.GetFuturePosition() + delta;
+    return Check(PreTradeReason::POSITION, position >= -mConfig.mPositionLimit && position <= mConfig.mPositionLimit)
+           && CheckMessageFrequency(now);
+}
+
+inline bool PreTradeLimits::CheckInsert(const OrderManager& orders, Side side, unsigned long volume, double now)
+{
+    if (!mConfig.mIsEnabled)
+    {
+        return true;
+    }
+
+    const long exposure = static_cast<long>(orders.GetActiveEtfVolume(side) + volume);
+    const long position = (side == Side::BUY) ? orders.GetEtfPosition() + exposure
+                                              : orders.GetEtfPosition() - exposure;
+    return Check(PreTradeReason::ACTIVE_ORDER_COUNT, orders.GetActiveEtfOrderCount() < mConfig.mActiveOrderCountLimit)
+           && Check(PreTradeReason::ACTIVE_VOLUME, orders.GetActiveEtfVolume() + volume <= mConfig.mActiveVolumeLimit)
+           && Check(PreTradeReason::POSITION, position >= -mConfig.mPositionLimit && position <= mConfig.mPositionLimit)
+           && CheckMessageFrequency(now);
+}
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_PRETRADELIMITS_H
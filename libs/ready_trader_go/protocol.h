@@ -20,11 +20,18 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include <boost/endian/conversion.hpp>
+
 #include "connectivitytypes.h"
+#include "fixedstring.h"
+#include "messageschema.h"
 #include "types.h"
 
 namespace ReadyTraderGo {
@@ -51,53 +58,50 @@ enum MessageFieldSize : std::size_t
     STRING = 50
 };
 
-struct AmendMessage : ISerialisable
+// The text fields of messages, held inline.
+using MessageString = FixedString<MessageFieldSize::STRING>;
+
+// Each message body is described by its Schema (see messageschema.h), in
+// the order the fields are sent. The formats checked against at the end of
+// this file are those in the Python exchange's messages.py.
+
+struct AmendMessage : SerialisableMessage<AmendMessage>
 {
     AmendMessage() = default;
     AmendMessage(unsigned long clientOrderId, unsigned long newVolume)
         : mClientOrderId(clientOrderId), mNewVolume(newVolume) {}
 
-    std::size_t Size() const noexcept override { return MessageFieldSize::LONG * 2; }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
-
     unsigned long mClientOrderId = 0;
     unsigned long mNewVolume = 0;
+
+    using Schema = MessageSchema<LongField<&AmendMessage::mClientOrderId>,
+                                 LongField<&AmendMessage::mNewVolume>>;
 };
 
-struct CancelMessage : ISerialisable
+struct CancelMessage : SerialisableMessage<CancelMessage>
 {
     CancelMessage() = default;
     explicit CancelMessage(unsigned long clientOrderId) : mClientOrderId(clientOrderId) {}
 
-    std::size_t Size() const noexcept override { return MessageFieldSize::LONG; }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
-
     unsigned long mClientOrderId = 0;
+
+    using Schema = MessageSchema<LongField<&CancelMessage::mClientOrderId>>;
 };
 
-struct ErrorMessage : ISerialisable
+struct ErrorMessage : SerialisableMessage<ErrorMessage>
 {
     ErrorMessage() = default;
-    ErrorMessage(unsigned long clientOrderId, std::string message)
-        : mClientOrderId(clientOrderId), mMessage(std::move(message)) {}
-
-    std::size_t Size() const noexcept override
-    {
-        return MessageFieldSize::LONG + MessageFieldSize::STRING;
-    }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
+    ErrorMessage(unsigned long clientOrderId, std::string_view message)
+        : mClientOrderId(clientOrderId), mMessage(message) {}
 
     unsigned long mClientOrderId = 0;
-    std::string mMessage;
+    MessageString mMessage;
+
+    using Schema = MessageSchema<LongField<&ErrorMessage::mClientOrderId>,
+                                 StringField<&ErrorMessage::mMessage>>;
 };
 
-struct HedgeMessage : ISerialisable
+struct HedgeMessage : SerialisableMessage<HedgeMessage>
 {
     HedgeMessage() = default;
     HedgeMessage(unsigned long clientOrderId,
@@ -109,18 +113,18 @@ struct HedgeMessage : ISerialisable
           mPrice(price),
           mVolume(volume) {}
 
-    std::size_t Size() const noexcept override { return MessageFieldSize::LONG * 3 + MessageFieldSize::BYTE; }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
-
     unsigned long mClientOrderId = 0;
     Side mSide = Side::SELL;
     unsigned long mPrice = 0;
     unsigned long mVolume = 0;
+
+    using Schema = MessageSchema<LongField<&HedgeMessage::mClientOrderId>,
+                                 ByteField<&HedgeMessage::mSide>,
+                                 LongField<&HedgeMessage::mPrice>,
+                                 LongField<&HedgeMessage::mVolume>>;
 };
 
-struct HedgeFilledMessage : ISerialisable
+struct HedgeFilledMessage : SerialisableMessage<HedgeFilledMessage>
 {
     HedgeFilledMessage() = default;
     HedgeFilledMessage(unsigned long clientOrderId,
@@ -130,17 +134,16 @@ struct HedgeFilledMessage : ISerialisable
           mPrice(price),
           mVolume(volume) {}
 
-    std::size_t Size() const noexcept override { return MessageFieldSize::LONG * 3; }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
-
     unsigned long mClientOrderId = 0;
     unsigned long mPrice = 0;
     unsigned long mVolume = 0;
+
+    using Schema = MessageSchema<LongField<&HedgeFilledMessage::mClientOrderId>,
+                                 LongField<&HedgeFilledMessage::mPrice>,
+                                 LongField<&HedgeFilledMessage::mVolume>>;
 };
 
-struct InsertMessage : ISerialisable
+struct InsertMessage : SerialisableMessage<InsertMessage>
 {
     InsertMessage() = default;
     InsertMessage(unsigned long clientOrderId,
@@ -154,71 +157,33 @@ struct InsertMessage : ISerialisable
           mVolume(volume),
           mLifespan(lifespan) {}
 
-    std::size_t Size() const noexcept override { return MessageFieldSize::LONG * 3 + MessageFieldSize::BYTE * 2; }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
-
     unsigned long mClientOrderId = 0;
     Side mSide = Side::SELL;
     unsigned long mPrice = 0;
     unsigned long mVolume = 0;
     Lifespan mLifespan = Lifespan::FILL_AND_KILL;
+
+    using Schema = MessageSchema<LongField<&InsertMessage::mClientOrderId>,
+                                 ByteField<&InsertMessage::mSide>,
+                                 LongField<&InsertMessage::mPrice>,
+                                 LongField<&InsertMessage::mVolume>,
+                                 ByteField<&InsertMessage::mLifespan>>;
 };
 
-struct LoginMessage : ISerialisable
+struct LoginMessage : SerialisableMessage<LoginMessage>
 {
     LoginMessage() = default;
-    LoginMessage(std::string name, std::string secret)
-        : mName(std::move(name)), mSecret(std::move(secret)) {}
+    LoginMessage(std::string_view name, std::string_view secret)
+        : mName(name), mSecret(secret) {}
 
-    std::size_t Size() const noexcept override
-    {
-        return MessageFieldSize::STRING * 2;
-    }
+    MessageString mName;
+    MessageString mSecret;
 
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
-
-    std::string mName;
-    std::string mSecret;
+    using Schema = MessageSchema<StringField<&LoginMessage::mName>,
+                                 StringField<&LoginMessage::mSecret>>;
 };
 
-struct OrderBookMessage : ISerialisable
-{
-    OrderBookMessage() = default;
-    OrderBookMessage(Instrument instrument,
-                     unsigned long sequenceNumber,
-                     const std::array<unsigned long, TOP_LEVEL_COUNT>& askPrices,
-                     const std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
-                     const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
-                     const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes)
-        : mInstrument(instrument),
-          mSequenceNumber(sequenceNumber),
-          mAskPrices(askPrices),
-          mAskVolumes(askVolumes),
-          mBidPrices(bidPrices),
-          mBidVolumes(bidVolumes) {}
-
-    std::size_t Size() const noexcept override
-    {
-        return MessageFieldSize::BYTE
-            + MessageFieldSize::LONG
-            + MessageFieldSize::LONG * TOP_LEVEL_COUNT * 4;
-    }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
-
-    Instrument mInstrument = Instrument::FUTURE;
-    unsigned long mSequenceNumber = 0;
-    std::array<unsigned long, TOP_LEVEL_COUNT> mAskPrices = {};
-    std::array<unsigned long, TOP_LEVEL_COUNT> mAskVolumes = {};
-    std::array<unsigned long, TOP_LEVEL_COUNT> mBidPrices = {};
-    std::array<unsigned long, TOP_LEVEL_COUNT> mBidVolumes = {};
-};
-
-struct OrderFilledMessage : ISerialisable
+struct OrderFilledMessage : SerialisableMessage<OrderFilledMessage>
 {
     OrderFilledMessage() = default;
     OrderFilledMessage(unsigned long clientOrderId,
@@ -228,17 +193,16 @@ struct OrderFilledMessage : ISerialisable
           mPrice(price),
           mVolume(volume) {}
 
-    std::size_t Size() const noexcept override { return MessageFieldSize::LONG * 3; }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
-
     unsigned long mClientOrderId = 0;
     unsigned long mPrice = 0;
     unsigned long mVolume = 0;
+
+    using Schema = MessageSchema<LongField<&OrderFilledMessage::mClientOrderId>,
+                                 LongField<&OrderFilledMessage::mPrice>,
+                                 LongField<&OrderFilledMessage::mVolume>>;
 };
 
-struct OrderStatusMessage : ISerialisable
+struct OrderStatusMessage : SerialisableMessage<OrderStatusMessage>
 {
     OrderStatusMessage() = default;
     OrderStatusMessage(unsigned long clientOrderId,
@@ -250,42 +214,34 @@ struct OrderStatusMessage : ISerialisable
           mRemainingVolume(remainingVolume),
           mFees(fees) {}
 
-    std::size_t Size() const noexcept override { return MessageFieldSize::LONG * 4; }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
-
     unsigned long mClientOrderId = 0;
     unsigned long mFillVolume = 0;
     unsigned long mRemainingVolume = 0;
     signed long mFees = 0;
+
+    using Schema = MessageSchema<LongField<&OrderStatusMessage::mClientOrderId>,
+                                 LongField<&OrderStatusMessage::mFillVolume>,
+                                 LongField<&OrderStatusMessage::mRemainingVolume>,
+                                 LongField<&OrderStatusMessage::mFees>>;
 };
 
-struct TradeTicksMessage : ISerialisable
+// The body shared by order book and trade ticks messages: the instrument,
+// a sequence number and the prices and volumes of the top levels.
+struct TopLevelsMessage : SerialisableMessage<TopLevelsMessage>
 {
-    TradeTicksMessage() = default;
-    TradeTicksMessage(Instrument instrument,
-                      unsigned long sequenceNumber,
-                      const std::array<unsigned long, TOP_LEVEL_COUNT> &askPrices,
-                      const std::array<unsigned long, TOP_LEVEL_COUNT> &askVolumes,
-                      const std::array<unsigned long, TOP_LEVEL_COUNT> &bidPrices,
-                      const std::array<unsigned long, TOP_LEVEL_COUNT> &bidVolumes)
-            : mInstrument(instrument),
-              mSequenceNumber(sequenceNumber),
-              mAskPrices(askPrices),
-              mAskVolumes(askVolumes),
-              mBidPrices(bidPrices),
-              mBidVolumes(bidVolumes) {}
-
-    std::size_t Size() const noexcept override
-    {
-        return MessageFieldSize::BYTE
-               + MessageFieldSize::LONG
-               + MessageFieldSize::LONG * TOP_LEVEL_COUNT * 4;
-    }
-
-    void Deserialise(unsigned char const* data, std::size_t size) override;
-    void Serialise(unsigned char* buf) const override;
+    TopLevelsMessage() = default;
+    TopLevelsMessage(Instrument instrument,
+                     unsigned long sequenceNumber,
+                     const std::array<unsigned long, TOP_LEVEL_COUNT>& askPrices,
+                     const std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
+                     const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
+                     const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes)
+        : mInstrument(instrument),
+          mSequenceNumber(sequenceNumber),
+          mAskPrices(askPrices),
+          mAskVolumes(askVolumes),
+          mBidPrices(bidPrices),
+          mBidVolumes(bidVolumes) {}
 
     Instrument mInstrument = Instrument::FUTURE;
     unsigned long mSequenceNumber = 0;
@@ -293,6 +249,70 @@ struct TradeTicksMessage : ISerialisable
     std::array<unsigned long, TOP_LEVEL_COUNT> mAskVolumes = {};
     std::array<unsigned long, TOP_LEVEL_COUNT> mBidPrices = {};
     std::array<unsigned long, TOP_LEVEL_COUNT> mBidVolumes = {};
+
+    using Schema = MessageSchema<ByteField<&TopLevelsMessage::mInstrument>,
+                                 LongField<&TopLevelsMessage::mSequenceNumber>,
+                                 TopLevelsField<&TopLevelsMessage::mAskPrices,
+                                                &TopLevelsMessage::mAskVolumes,
+                                                &TopLevelsMessage::mBidPrices,
+                                                &TopLevelsMessage::mBidVolumes>>;
+};
+
+struct OrderBookMessage : TopLevelsMessage
+{
+    using TopLevelsMessage::TopLevelsMessage;
+};
+
+struct TradeTicksMessage : TopLevelsMessage
+{
+    using TopLevelsMessage::TopLevelsMessage;
+};
+
+// Read-only view over the body of an order book or trade ticks message.
+// Nothing is decoded up front: each field is byte swapped when accessed, so
+// a handler that only looks at the best prices only pays for those.
+class TopLevelsView
+{
+public:
+    explicit TopLevelsView(unsigned char const* data) : mData(data) {}
+
+    Instrument GetInstrument() const { return Instrument(*mData); }
+    unsigned long GetSequenceNumber() const { return readLong(mData + SEQUENCE_NUMBER_OFFSET); }
+
+    unsigned long GetAskPrice(std::size_t level) const { return ReadLevel(ASK_PRICES_OFFSET, level); }
+    unsigned long GetAskVolume(std::size_t level) const { return ReadLevel(ASK_VOLUMES_OFFSET, level); }
+    unsigned long GetBidPrice(std::size_t level) const { return ReadLevel(BID_PRICES_OFFSET, level); }
+    unsigned long GetBidVolume(std::size_t level) const { return ReadLevel(BID_VOLUMES_OFFSET, level); }
+
+    // Decode every level at once, which is cheaper than reading more than
+    // a few of them one at a time.
+    void GetLevels(TopLevels& levels) const { decodeTopLevels(mData + ASK_PRICES_OFFSET, levels); }
+
+    unsigned char const* GetData() const { return mData; }
+
+private:
+    static constexpr std::size_t SEQUENCE_NUMBER_OFFSET = TopLevelsMessage::Schema::OFFSETS[1];
+    static constexpr std::size_t ASK_PRICES_OFFSET = TopLevelsMessage::Schema::OFFSETS[2];
+    static constexpr std::size_t ASK_VOLUMES_OFFSET = ASK_PRICES_OFFSET + MessageFieldSize::LONG * TOP_LEVEL_COUNT;
+    static constexpr std::size_t BID_PRICES_OFFSET = ASK_VOLUMES_OFFSET + MessageFieldSize::LONG * TOP_LEVEL_COUNT;
+    static constexpr std::size_t BID_VOLUMES_OFFSET = BID_PRICES_OFFSET + MessageFieldSize::LONG * TOP_LEVEL_COUNT;
+
+    unsigned long ReadLevel(std::size_t offset, std::size_t level) const
+    {
+        return readLong(mData + offset + level * MessageFieldSize::LONG);
+    }
+
+    unsigned char const* mData;
+};
+
+struct OrderBookView : TopLevelsView
+{
+    using TopLevelsView::TopLevelsView;
+};
+
+struct TradeTicksView : TopLevelsView
+{
+    using TopLevelsView::TopLevelsView;
 };
 
 template<class T>
@@ -303,6 +323,18 @@ T makeMessage(unsigned char const* data, std::size_t size)
     return message;
 }
 
+static_assert(AmendMessage::Schema::MatchesFormat("!II"));
+static_assert(CancelMessage::Schema::MatchesFormat("!I"));
+static_assert(ErrorMessage::Schema::MatchesFormat("!I50s"));
+static_assert(HedgeMessage::Schema::MatchesFormat("!IBII"));
+static_assert(HedgeFilledMessage::Schema::MatchesFormat("!III"));
+static_assert(InsertMessage::Schema::MatchesFormat("!IBIIB"));
+static_assert(LoginMessage::Schema::MatchesFormat("!50s50s"));
+static_assert(OrderFilledMessage::Schema::MatchesFormat("!III"));
+static_assert(OrderStatusMessage::Schema::MatchesFormat("!IIIi"));
+// ORDER_BOOK_HEADER and TRADE_TICKS_HEADER followed by the levels.
+static_assert(TopLevelsMessage::Schema::MatchesFormat("!BI20I"));
+
 }
 
 #endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_PROTOCOL_H
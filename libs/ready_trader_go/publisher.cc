@@ -0,0 +1,132 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <boost/endian/conversion.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+#include "connectivity.h"
+#include "error.h"
+#include "logging.h"
+#include "publisher.h"
+
+RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_PUB, "PUBLISHER")
+
+namespace ReadyTraderGo {
+
+constexpr std::size_t PUBLISHER_POSITION_MASK = SUBSCRIPTION_TRANSPORT_BUFFER_SIZE - 1;
+
+Publisher::Publisher(std::string type, std::string name) : mType(std::move(type)), mName(std::move(name))
+{
+    try
+    {
+        if (mType == "mmap")
+        {
+            // Start from an empty ring, whatever was left by a previous run.
+            // An existing file is overwritten in place rather than truncated,
+            // as truncating it would crash anything that still has it mapped.
+            std::fstream file{mName, std::ios::binary | std::ios::in | std::ios::out};
+            if (!file)
+            {
+                file.open(mName, std::ios::binary | std::ios::out);
+            }
+            const std::vector<char> zeros(SUBSCRIPTION_TRANSPORT_BUFFER_SIZE, 0);
+            file.write(zeros.data(), zeros.size());
+            file.close();
+            if (!file)
+            {
+                throw ReadyTraderGoError("failed to create information channel file '" + mName + "'");
+            }
+
+            interprocess::file_mapping mapping{mName.c_str(), interprocess::read_write};
+            mRegion = interprocess::mapped_region{mapping, interprocess::read_write, 0,
+                                                  SUBSCRIPTION_TRANSPORT_BUFFER_SIZE};
+        }
+        else if (mType == "shm")
+        {
+            // Left behind by a previous run
+            interprocess::shared_memory_object::remove(mName.c_str());
+            interprocess::shared_memory_object shm{interprocess::create_only, mName.c_str(),
+                                                   interprocess::read_write};
+            shm.truncate(SUBSCRIPTION_TRANSPORT_BUFFER_SIZE);
+            mRegion = interprocess::mapped_region{shm, interprocess::read_write, 0,
+                                                  SUBSCRIPTION_TRANSPORT_BUFFER_SIZE};
+            std::memset(mRegion.get_address(), 0, SUBSCRIPTION_TRANSPORT_BUFFER_SIZE);
+        }
+        else
+        {
+            throw ReadyTraderGoError("unknown information channel type '" + mType + "'");
+        }
+    }
+    catch (const interprocess::interprocess_exception& e)
+    {
+        RLOG(LG_PUB, LogLevel::LL_ERROR) << "failed to create information channel '" << mName << "': " << e.what();
+        throw ReadyTraderGoError("failed to create information channel '" + mName + "': " + e.what());
+    }
+
+    mBuffer = static_cast<unsigned char*>(mRegion.get_address());
+    RLOG(LG_PUB, LogLevel::LL_INFO) << "publishing information messages: type=" << mType << " name='" << mName
+                                    << '\'';
+}
+
+Publisher::~Publisher()
+{
+    RLOG(LG_PUB, LogLevel::LL_INFO) << "published " << mMessageCount << " information messages to '" << mName
+                                    << '\'';
+    if (mType == "shm")
+    {
+        interprocess::shared_memory_object::remove(mName.c_str());
+    }
+}
+
+void Publisher::Publish(unsigned char messageType, const ISerialisable& serialisable)
+{
+    const std::size_t size = MESSAGE_HEADER_SIZE + serialisable.Size();
+    if (size > FRAME_MAXIMUM_PAYLOAD_SIZE)
+    {
+        throw ReadyTraderGoError("information message is longer than the maximum payload size");
+    }
+
+    unsigned char* frame = mBuffer + mPosition;
+    unsigned char* payload = frame + FRAME_HEADER_SIZE;
+    const uint16_t length = boost::endian::native_to_big((uint16_t)size);
+    std::memcpy(payload, &length, sizeof(length));
+    payload[MESSAGE_TYPE_OFFSET] = messageType;
+    serialisable.Serialise(payload + MESSAGE_HEADER_SIZE);
+
+    const uint32_t payloadSize = boost::endian::native_to_big((uint32_t)size);
+    std::memcpy(frame + FRAME_PAYLOAD_SIZE_OFFSET, &payloadSize, sizeof(payloadSize));
+
+    // The following frame is marked empty before this one is marked full, so
+    // a subscriber that sees this frame's flag never mistakes the stale
+    // contents of the next frame for a new message. The payload must be
+    // visible before the flag is.
+    mPosition = (mPosition + FRAME_SIZE) & PUBLISHER_POSITION_MASK;
+    *static_cast<volatile unsigned char*>(mBuffer + mPosition) = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    *static_cast<volatile unsigned char*>(frame) = 1;
+
+    ++mMessageCount;
+}
+
+}
@@ -0,0 +1,64 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_PUBLISHER_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_PUBLISHER_H
+
+#include <cstddef>
+#include <string>
+
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "connectivitytypes.h"
+
+namespace ReadyTraderGo {
+
+// The writing end of an information channel: a ring of frames in a memory
+// mapped file ("mmap") or a POSIX shared memory block ("shm"), laid out the
+// same way as by the Python exchange's publisher so that any subscriber can
+// read it.
+//
+// Each message is written to the next frame, after which that frame's flag
+// is set and the following frame's flag is cleared. Subscribers must keep up
+// (there is no back pressure) or they will see torn frames.
+class Publisher
+{
+public:
+    Publisher(std::string type, std::string name);
+    ~Publisher();
+
+    // Publisher instances can't be copied or moved
+    Publisher(const Publisher&) = delete;
+    Publisher& operator=(const Publisher&) = delete;
+
+    // Write a message, including its header, to the next frame.
+    void Publish(unsigned char messageType, const ISerialisable& serialisable);
+
+    unsigned long GetMessageCount() const { return mMessageCount; }
+
+private:
+    std::string mType;
+    std::string mName;
+    boost::interprocess::mapped_region mRegion;
+    unsigned char* mBuffer = nullptr;
+    unsigned long mPosition = 0;
+    unsigned long mMessageCount = 0;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_PUBLISHER_H
@@ -0,0 +1,193 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_STATICAUTOTRADER_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_STATICAUTOTRADER_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <boost/asio/io_context.hpp>
+
+#include "baseautotrader.h"
+#include "connectivitytypes.h"
+#include "error.h"
+#include "protocol.h"
+#include "types.h"
+
+namespace ReadyTraderGo {
+
+// An auto-trader whose message handlers are found at compile time. Derive
+// from StaticAutoTrader<YourAutoTrader> and define any of:
+//
+//     void OnOrderBook(const OrderBookView& book, ReceiveTime receiveTime);
+//     void OnTradeTicks(const TradeTicksView& ticks, ReceiveTime receiveTime);
+//     void OnOrderFilled(unsigned long clientOrderId, unsigned long price, unsigned long volume,
+//                        ReceiveTime receiveTime);
+//     void OnHedgeFilled(unsigned long clientOrderId, unsigned long price, unsigned long volume,
+//                        ReceiveTime receiveTime);
+//     void OnOrderStatus(unsigned long clientOrderId, unsigned long fillVolume, unsigned long remainingVolume,
+//                        signed long fees, ReceiveTime receiveTime);
+//     void OnError(unsigned long clientOrderId, std::string_view errorMessage, ReceiveTime receiveTime);
+//
+// The handlers must be public (or StaticAutoTrader<YourAutoTrader> made a
+// friend). They are called directly, rather than through the vtable, from the
+// subscription's message callback, so the compiler can inline a strategy's
+// order book handler into the decode of the message. Handlers that are not
+// defined fall back to BaseAutoTrader's virtual handlers, so a strategy can
+// move over one handler at a time. Everything else (sending, the order
+// manager, pre-trade limits and statistics) is BaseAutoTrader's.
+template<typename Derived>
+class StaticAutoTrader : public BaseAutoTrader
+{
+public:
+    explicit StaticAutoTrader(boost::asio::io_context& context) : BaseAutoTrader(context) {}
+
+    void SetInformationSubscription(std::shared_ptr<ISubscription>&& subscription) override;
+
+protected:
+    void MessageHandler(IConnection* connection,
+                        unsigned char messageType,
+                        unsigned char const* data,
+                        std::size_t size,
+                        ReceiveTime receiveTime) final;
+    void MessageHandler(ISubscription* subscription,
+                        unsigned char messageType,
+                        unsigned char const* data,
+                        std::size_t size,
+                        ReceiveTime receiveTime) final
+    {
+        Dispatch(subscription, messageType, data, size, receiveTime);
+    }
+
+    // Default handlers, hidden by the derived class's own.
+    void OnError(unsigned long clientOrderId, std::string_view errorMessage, ReceiveTime receiveTime)
+    {
+        ErrorMessageHandler(clientOrderId, errorMessage, receiveTime);
+    }
+    void OnHedgeFilled(unsigned long clientOrderId, unsigned long price, unsigned long volume, ReceiveTime receiveTime)
+    {
+        HedgeFilledMessageHandler(clientOrderId, price, volume, receiveTime);
+    }
+    void OnOrderBook(const OrderBookView& book, ReceiveTime receiveTime)
+    {
+        OrderBookMessageHandler(book, receiveTime);
+    }
+    void OnOrderFilled(unsigned long clientOrderId, unsigned long price, unsigned long volume, ReceiveTime receiveTime)
+    {
+        OrderFilledMessageHandler(clientOrderId, price, volume, receiveTime);
+    }
+    void OnOrderStatus(unsigned long clientOrderId,
+                       unsigned long fillVolume,
+                       unsigned long remainingVolume,
+                       signed long fees,
+                       ReceiveTime receiveTime)
+    {
+        OrderStatusMessageHandler(clientOrderId, fillVolume, remainingVolume, fees, receiveTime);
+    }
+    void OnTradeTicks(const TradeTicksView& ticks, ReceiveTime receiveTime)
+    {
+        TradeTicksMessageHandler(ticks, receiveTime);
+    }
+
+private:
+    Derived& GetDerived() { return static_cast<Derived&>(*this); }
+
+    void Dispatch(ISubscription* subscription,
+                  unsigned char messageType,
+                  unsigned char const* data,
+                  std::size_t size,
+                  ReceiveTime receiveTime);
+};
+
+template<typename Derived>
+void StaticAutoTrader<Derived>::SetInformationSubscription(std::shared_ptr<ISubscription>&& subscription)
+{
+    mInformationSubscription = std::move(subscription);
+    mInformationSubscription->SetName("Info");
+    mInformationSubscription->Disconnected = [this] { DisconnectHandler(); };
+    mInformationSubscription->FramesDropped = [this](ISubscription*, std::size_t n) { FramesDroppedHandler(n); };
+    mInformationSubscription->MessageReceived = [this](ISubscription* s,
+                                                       unsigned char t,
+                                                       unsigned char const* d,
+                                                       std::size_t z,
+                                                       ReceiveTime r) { Dispatch(s, t, d, z, r); };
+    mInformationSubscription->AsyncReceive();
+}
+
+template<typename Derived>
+inline void StaticAutoTrader<Derived>::Dispatch(ISubscription* subscription,
+                                                unsigned char messageType,
+                                                unsigned char const* data,
+                                                std::size_t size,
+                                                ReceiveTime receiveTime)
+{
+    BeginMessage();
+
+    if (messageType == MessageType::ORDER_BOOK_UPDATE)
+    {
+        OrderBookView book{data};
+        BeginOrderBook(subscription, book, receiveTime);
+        GetDerived().OnOrderBook(book, receiveTime);
+        EndOrderBook();
+    }
+    else if (messageType == MessageType::TRADE_TICKS)
+    {
+        GetDerived().OnTradeTicks(TradeTicksView{data}, receiveTime);
+    }
+    else
+    {
+        throw ReadyTraderGoError("received information message with unexpected type");
+    }
+}
+
+template<typename Derived>
+void StaticAutoTrader<Derived>::MessageHandler(IConnection* connection,
+                                               unsigned char messageType,
+                                               unsigned char const* data,
+                                               std::size_t size,
+                                               ReceiveTime receiveTime)
+{
+    HandleExecutionMessage(messageType, data, size, receiveTime, [this, receiveTime](const auto& message) {
+        using Message = std::decay_t<decltype(message)>;
+        if constexpr (std::is_same_v<Message, ErrorMessage>)
+        {
+            GetDerived().OnError(message.mClientOrderId, message.mMessage.View(), receiveTime);
+        }
+        else if constexpr (std::is_same_v<Message, HedgeFilledMessage>)
+        {
+            GetDerived().OnHedgeFilled(message.mClientOrderId, message.mPrice, message.mVolume, receiveTime);
+        }
+        else if constexpr (std::is_same_v<Message, OrderFilledMessage>)
+        {
+            GetDerived().OnOrderFilled(message.mClientOrderId, message.mPrice, message.mVolume, receiveTime);
+        }
+        else
+        {
+            GetDerived().OnOrderStatus(message.mClientOrderId, message.mFillVolume,
+                                       message.mRemainingVolume, message.mFees, receiveTime);
+        }
+    });
+}
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_STATICAUTOTRADER_H
@@ -0,0 +1,66 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_STRATEGYPARAMETERS_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_STRATEGYPARAMETERS_H
+
+#include <map>
+#include <string>
+
+#include <boost/property_tree/ptree.hpp>
+
+namespace ReadyTraderGo {
+
+// Named numbers an auto-trader's strategy can be tuned with (lot sizes,
+// thresholds and so on) without rebuilding it. They come from the optional
+// "Parameters" section of the auto-trader's configuration, or from whatever
+// drives a backtest. A strategy asks for each one with its own default, so
+// parameters that are not set leave it unchanged.
+class StrategyParameters
+{
+public:
+    using const_iterator = std::map<std::string, double>::const_iterator;
+
+    void readFromPropertyTree(const boost::property_tree::ptree& tree)
+    {
+        for (const auto& child : tree)
+        {
+            Set(child.first, child.second.get_value<double>());
+        }
+    }
+
+    template<typename T>
+    T Get(const std::string& name, T defaultValue) const
+    {
+        auto it = mValues.find(name);
+        return it != mValues.end() ? static_cast<T>(it->second) : defaultValue;
+    }
+
+    bool IsSet(const std::string& name) const { return mValues.count(name) != 0; }
+    void Set(const std::string& name, double value) { mValues[name] = value; }
+
+    bool IsEmpty() const { return mValues.empty(); }
+    const_iterator begin() const { return mValues.begin(); }
+    const_iterator end() const { return mValues.end(); }
+
+private:
+    std::map<std::string, double> mValues;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_STRATEGYPARAMETERS_H
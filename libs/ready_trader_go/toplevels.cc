@@ -0,0 +1,322 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cstring>
+
+#include <boost/endian/conversion.hpp>
+
+#if defined(__x86_64__) && defined(__LP64__) && (defined(__GNUC__) || defined(__clang__))
+#define RTG_X86_BYTE_SWAP 1
+#include <immintrin.h>
+#endif
+
+#include "toplevels.h"
+
+namespace ReadyTraderGo {
+
+// Each kernel reverses the bytes of every 32-bit value in a block of
+// TOP_LEVELS_SIZE bytes, which converts big-endian to native order on a
+// little-endian machine and back again. The wide versions convert the
+// same block to and from four arrays (ask prices, ask volumes, bid prices
+// and bid volumes) of native unsigned longs.
+struct ByteSwapFunctions
+{
+    void (*mSwap)(unsigned char*, unsigned char const*);
+    void (*mDecodeWide)(unsigned long* const*, unsigned char const*);
+    void (*mEncodeWide)(unsigned char*, const unsigned long* const*);
+};
+
+static std::uint32_t loadBig(unsigned char const* in)
+{
+    std::uint32_t value;
+    std::memcpy(&value, in, sizeof(value));
+    return boost::endian::big_to_native(value);
+}
+
+static void storeBig(unsigned char* out, std::uint32_t value)
+{
+    value = boost::endian::native_to_big(value);
+    std::memcpy(out, &value, sizeof(value));
+}
+
+static void swapScalar(unsigned char* out, unsigned char const* in)
+{
+    for (std::size_t i = 0; i != TOP_LEVELS_SIZE; i += sizeof(std::uint32_t))
+    {
+        const std::uint32_t value = loadBig(in + i);
+        std::memcpy(out + i, &value, sizeof(value));
+    }
+}
+
+static void decodeArrayScalar(unsigned long* out, unsigned char const* in)
+{
+    for (std::size_t i = 0; i != TOP_LEVEL_COUNT; ++i)
+    {
+        out[i] = loadBig(in + i * sizeof(std::uint32_t));
+    }
+}
+
+static void encodeArrayScalar(unsigned char* out, const unsigned long* in)
+{
+    for (std::size_t i = 0; i != TOP_LEVEL_COUNT; ++i)
+    {
+        storeBig(out + i * sizeof(std::uint32_t), static_cast<std::uint32_t>(in[i]));
+    }
+}
+
+static void decodeWideScalar(unsigned long* const* out, unsigned char const* in)
+{
+    for (std::size_t i = 0; i != 4; ++i)
+    {
+        decodeArrayScalar(out[i], in + i * TOP_LEVEL_COUNT * sizeof(std::uint32_t));
+    }
+}
+
+static void encodeWideScalar(unsigned char* out, const unsigned long* const* in)
+{
+    for (std::size_t i = 0; i != 4; ++i)
+    {
+        encodeArrayScalar(out + i * TOP_LEVEL_COUNT * sizeof(std::uint32_t), in[i]);
+    }
+}
+
+#ifdef RTG_X86_BYTE_SWAP
+
+// The vector kernels handle the first four levels of an array in one go
+// and the fifth on its own.
+static_assert(TOP_LEVEL_COUNT == 5, "the vector kernels assume five levels");
+static_assert(sizeof(unsigned long) == 8, "the wide vector kernels assume 64-bit unsigned longs");
+
+__attribute__((target("ssse3")))
+static __m128i swapMask()
+{
+    return _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+}
+
+__attribute__((target("ssse3")))
+static void swapSsse3(unsigned char* out, unsigned char const* in)
+{
+    const __m128i mask = swapMask();
+    for (std::size_t i = 0; i != TOP_LEVELS_SIZE; i += 16)
+    {
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_shuffle_epi8(value, mask));
+    }
+}
+
+__attribute__((target("ssse3")))
+static void decodeArraySsse3(unsigned long* out, unsigned char const* in)
+{
+    const __m128i value = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), swapMask());
+    const __m128i zero = _mm_setzero_si128();
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi32(value, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2), _mm_unpackhi_epi32(value, zero));
+    out[4] = loadBig(in + 16);
+}
+
+__attribute__((target("ssse3")))
+static void encodeArraySsse3(unsigned char* out, const unsigned long* in)
+{
+    // Gather the low halves of the four values, then swap their bytes.
+    const __m128i low = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), 0x08);
+    const __m128i high = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2)), 0x08);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(_mm_unpacklo_epi64(low, high), swapMask()));
+    storeBig(out + 16, static_cast<std::uint32_t>(in[4]));
+}
+
+__attribute__((target("ssse3")))
+static void decodeWideSsse3(unsigned long* const* out, unsigned char const* in)
+{
+    for (std::size_t i = 0; i != 4; ++i)
+    {
+        decodeArraySsse3(out[i], in + i * TOP_LEVEL_COUNT * sizeof(std::uint32_t));
+    }
+}
+
+__attribute__((target("ssse3")))
+static void encodeWideSsse3(unsigned char* out, const unsigned long* const* in)
+{
+    for (std::size_t i = 0; i != 4; ++i)
+    {
+        encodeArraySsse3(out + i * TOP_LEVEL_COUNT * sizeof(std::uint32_t), in[i]);
+    }
+}
+
+__attribute__((target("avx2")))
+static void swapAvx2(unsigned char* out, unsigned char const* in)
+{
+    const __m256i mask = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                          3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+    const __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 32));
+    const __m128i last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 64));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_shuffle_epi8(first, mask));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), _mm256_shuffle_epi8(second, mask));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 64), _mm_shuffle_epi8(last, _mm256_castsi256_si128(mask)));
+}
+
+__attribute__((target("avx2")))
+static void decodeArrayAvx2(unsigned long* out, unsigned char const* in)
+{
+    const __m128i value = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), swapMask());
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_cvtepu32_epi64(value));
+    out[4] = loadBig(in + 16);
+}
+
+__attribute__((target("avx2")))
+static void encodeArrayAvx2(unsigned char* out, const unsigned long* in)
+{
+    const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+    const __m256i low = _mm256_permutevar8x32_epi32(value, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(_mm256_castsi256_si128(low), swapMask()));
+    storeBig(out + 16, static_cast<std::uint32_t>(in[4]));
+}
+
+__attribute__((target("avx2")))
+static void decodeWideAvx2(unsigned long* const* out, unsigned char const* in)
+{
+    for (std::size_t i = 0; i != 4; ++i)
+    {
+        decodeArrayAvx2(out[i], in + i * TOP_LEVEL_COUNT * sizeof(std::uint32_t));
+    }
+}
+
+__attribute__((target("avx2")))
+static void encodeWideAvx2(unsigned char* out, const unsigned long* const* in)
+{
+    for (std::size_t i = 0; i != 4; ++i)
+    {
+        encodeArrayAvx2(out + i * TOP_LEVEL_COUNT * sizeof(std::uint32_t), in[i]);
+    }
+}
+
+#endif
+
+bool isByteSwapKernelSupported(ByteSwapKernel kernel)
+{
+    switch (kernel)
+    {
+    case ByteSwapKernel::SCALAR:
+        return true;
+#ifdef RTG_X86_BYTE_SWAP
+    case ByteSwapKernel::SSSE3:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("ssse3");
+    case ByteSwapKernel::AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+static ByteSwapFunctions getByteSwapFunctions(ByteSwapKernel kernel)
+{
+    switch (kernel)
+    {
+#ifdef RTG_X86_BYTE_SWAP
+    case ByteSwapKernel::SSSE3:
+        return {swapSsse3, decodeWideSsse3, encodeWideSsse3};
+    case ByteSwapKernel::AVX2:
+        return {swapAvx2, decodeWideAvx2, encodeWideAvx2};
+#endif
+    default:
+        return {swapScalar, decodeWideScalar, encodeWideScalar};
+    }
+}
+
+static ByteSwapKernel chooseByteSwapKernel()
+{
+    for (auto kernel : {ByteSwapKernel::AVX2, ByteSwapKernel::SSSE3})
+    {
+        if (isByteSwapKernelSupported(kernel))
+        {
+            return kernel;
+        }
+    }
+    return ByteSwapKernel::SCALAR;
+}
+
+// Start with the scalar kernel so that decoding works even during static
+// initialisation, then switch to the best one.
+static ByteSwapKernel currentKernel = ByteSwapKernel::SCALAR;
+static ByteSwapFunctions currentFunctions = {swapScalar, decodeWideScalar, encodeWideScalar};
+
+ByteSwapKernel getByteSwapKernel()
+{
+    return currentKernel;
+}
+
+bool setByteSwapKernel(ByteSwapKernel kernel)
+{
+    if (!isByteSwapKernelSupported(kernel))
+    {
+        return false;
+    }
+    currentKernel = kernel;
+    currentFunctions = getByteSwapFunctions(kernel);
+    return true;
+}
+
+[[maybe_unused]] static const bool kernelChosen = setByteSwapKernel(chooseByteSwapKernel());
+
+const char* toString(ByteSwapKernel kernel)
+{
+    switch (kernel)
+    {
+    case ByteSwapKernel::SCALAR:
+        return "scalar";
+    case ByteSwapKernel::SSSE3:
+        return "ssse3";
+    case ByteSwapKernel::AVX2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+void decodeTopLevels(unsigned char const* data, TopLevels& levels)
+{
+    currentFunctions.mSwap(reinterpret_cast<unsigned char*>(&levels), data);
+}
+
+void encodeTopLevels(const TopLevels& levels, unsigned char* buf)
+{
+    currentFunctions.mSwap(buf, reinterpret_cast<unsigned char const*>(&levels));
+}
+
+void decodeTopLevels(unsigned char const* data,
+                     TopLevelArray& askPrices,
+                     TopLevelArray& askVolumes,
+                     TopLevelArray& bidPrices,
+                     TopLevelArray& bidVolumes)
+{
+    unsigned long* const out[4] = {askPrices.data(), askVolumes.data(), bidPrices.data(), bidVolumes.data()};
+    currentFunctions.mDecodeWide(out, data);
+}
+
+void encodeTopLevels(const TopLevelArray& askPrices,
+                     const TopLevelArray& askVolumes,
+                     const TopLevelArray& bidPrices,
+                     const TopLevelArray& bidVolumes,
+                     unsigned char* buf)
+{
+    const unsigned long* const in[4] = {askPrices.data(), askVolumes.data(), bidPrices.data(), bidVolumes.data()};
+    currentFunctions.mEncodeWide(buf, in);
+}
+
+}
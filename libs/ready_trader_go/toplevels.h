@@ -0,0 +1,77 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_TOPLEVELS_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_TOPLEVELS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "types.h"
+
+namespace ReadyTraderGo {
+
+// The prices and volumes of the top levels of an order book or trade ticks
+// message, as 32-bit values in the same order as on the wire, so that the
+// whole block can be converted with a few vector byte shuffles.
+struct TopLevels
+{
+    std::array<std::uint32_t, TOP_LEVEL_COUNT> mAskPrices;
+    std::array<std::uint32_t, TOP_LEVEL_COUNT> mAskVolumes;
+    std::array<std::uint32_t, TOP_LEVEL_COUNT> mBidPrices;
+    std::array<std::uint32_t, TOP_LEVEL_COUNT> mBidVolumes;
+};
+
+constexpr std::size_t TOP_LEVELS_SIZE = 4 * TOP_LEVEL_COUNT * sizeof(std::uint32_t);
+static_assert(sizeof(TopLevels) == TOP_LEVELS_SIZE, "TopLevels must have no padding");
+
+// Implementations of the top levels byte swap. The best one the processor
+// supports is chosen when the program starts.
+enum class ByteSwapKernel : unsigned char { SCALAR, SSSE3, AVX2 };
+
+ByteSwapKernel getByteSwapKernel();
+bool isByteSwapKernelSupported(ByteSwapKernel kernel);
+
+// Use the given implementation (for testing and benchmarks). Returns false,
+// leaving the current one, if the processor does not support it.
+bool setByteSwapKernel(ByteSwapKernel kernel);
+
+const char* toString(ByteSwapKernel kernel);
+
+// Convert TOP_LEVELS_SIZE bytes of big-endian levels, which need not be
+// aligned, to native order, and back again.
+void decodeTopLevels(unsigned char const* data, TopLevels& levels);
+void encodeTopLevels(const TopLevels& levels, unsigned char* buf);
+
+// The same, widening to or narrowing from the unsigned long arrays of the
+// order book and trade ticks messages.
+using TopLevelArray = std::array<unsigned long, TOP_LEVEL_COUNT>;
+void decodeTopLevels(unsigned char const* data,
+                     TopLevelArray& askPrices,
+                     TopLevelArray& askVolumes,
+                     TopLevelArray& bidPrices,
+                     TopLevelArray& bidVolumes);
+void encodeTopLevels(const TopLevelArray& askPrices,
+                     const TopLevelArray& askVolumes,
+                     const TopLevelArray& bidPrices,
+                     const TopLevelArray& bidVolumes,
+                     unsigned char* buf);
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_TOPLEVELS_H
@@ -0,0 +1,109 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+#include "error.h"
+#include "waitstrategy.h"
+
+namespace ReadyTraderGo {
+
+static inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+WaitPolicy parseWaitPolicy(const std::string& name)
+{
+    if (name == "spin")
+        return WaitPolicy::SPIN;
+    if (name == "pause")
+        return WaitPolicy::PAUSE;
+    if (name == "yield")
+        return WaitPolicy::YIELD;
+    if (name == "sleep")
+        return WaitPolicy::SLEEP;
+    throw ReadyTraderGoError("unknown wait policy '" + name + "'");
+}
+
+std::chrono::nanoseconds WaitStrategy::Idle()
+{
+    if (mHasWaited)
+    {
+        EndWait();
+    }
+    ++mIdleCount;
+
+    if (mPolicy == WaitPolicy::SPIN)
+    {
+        return std::chrono::nanoseconds::zero();
+    }
+
+    if (mPolicy == WaitPolicy::PAUSE || mIdleCount <= mSpinCount)
+    {
+        cpuRelax();
+        ++mStatistics.mPauses;
+        return std::chrono::nanoseconds::zero();
+    }
+
+    mWaitStart = std::chrono::steady_clock::now();
+    mHasWaited = true;
+
+    if (mPolicy == WaitPolicy::YIELD)
+    {
+        mRequestedWait = std::chrono::nanoseconds::zero();
+        std::this_thread::yield();
+        ++mStatistics.mYields;
+        return std::chrono::nanoseconds::zero();
+    }
+
+    mNextSleep = (mIdleCount == mSpinCount + 1) ? mMinimumSleep : std::min(mNextSleep * 2, mMaximumSleep);
+    ++mStatistics.mSleeps;
+    mRequestedWait = mNextSleep;
+    return mNextSleep;
+}
+
+void WaitStrategy::EndWait()
+{
+    // A sleep on an io_context can end early when another event arrives,
+    // which is not oversleeping.
+    const auto oversleep = std::max<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - mWaitStart - mRequestedWait, std::chrono::nanoseconds::zero());
+    ++mStatistics.mTimedWaits;
+    mStatistics.mTotalOversleep += oversleep;
+    mStatistics.mMaximumOversleep = std::max(mStatistics.mMaximumOversleep, oversleep);
+    mHasWaited = false;
+}
+
+void WaitStrategy::WakeUp()
+{
+    ++mStatistics.mWakeUps;
+    mIdleCount = 0;
+}
+
+}
@@ -0,0 +1,118 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_WAITSTRATEGY_H
+#define CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_WAITSTRATEGY_H
+
+#include <chrono>
+#include <ostream>
+#include <string>
+
+namespace ReadyTraderGo {
+
+// How a poller waits when there is nothing to do:
+//   SPIN - poll again immediately;
+//   PAUSE - execute a CPU pause (or equivalent) instruction between polls;
+//   YIELD - pause for a number of polls and then yield the CPU between polls;
+//   SLEEP - pause for a number of polls and then sleep between polls for an
+//           interval that doubles (up to a maximum) while things stay quiet.
+enum class WaitPolicy : unsigned char { SPIN, PAUSE, YIELD, SLEEP };
+
+WaitPolicy parseWaitPolicy(const std::string& name);
+
+struct WaitStatistics
+{
+    // Number of times work was found after at least one idle poll.
+    unsigned long mWakeUps = 0;
+    unsigned long mPauses = 0;
+    unsigned long mYields = 0;
+    unsigned long mSleeps = 0;
+
+    // How much longer than requested each yield or sleep took to return to
+    // the next poll (a yield requests no time at all). This is the delay the
+    // wait added to noticing new work beyond the sleep that was asked for.
+    unsigned long mTimedWaits = 0;
+    std::chrono::nanoseconds mTotalOversleep{0};
+    std::chrono::nanoseconds mMaximumOversleep{0};
+};
+
+class WaitStrategy
+{
+public:
+    WaitStrategy() = default;
+    WaitStrategy(WaitPolicy policy,
+                 unsigned long spinCount,
+                 std::chrono::microseconds minimumSleep,
+                 std::chrono::microseconds maximumSleep)
+        : mPolicy(policy),
+          mSpinCount(spinCount),
+          mMinimumSleep(minimumSleep),
+          mMaximumSleep(maximumSleep) {}
+
+    // Called after a poll that found work.
+    void Busy()
+    {
+        if (mHasWaited)
+        {
+            EndWait();
+        }
+        if (mIdleCount != 0)
+        {
+            WakeUp();
+        }
+    }
+
+    // Called after a poll that found nothing. Pauses or yields as the policy
+    // requires and returns how long the caller should sleep before polling
+    // again (zero means poll again straight away). Sleeping is left to the
+    // caller so that it can wait on other events at the same time.
+    std::chrono::nanoseconds Idle();
+
+    WaitPolicy GetPolicy() const { return mPolicy; }
+    const WaitStatistics& GetStatistics() const { return mStatistics; }
+
+private:
+    void EndWait();
+    void WakeUp();
+
+    WaitPolicy mPolicy = WaitPolicy::SPIN;
+    unsigned long mSpinCount = 0;
+    std::chrono::nanoseconds mMinimumSleep{0};
+    std::chrono::nanoseconds mMaximumSleep{0};
+
+    unsigned long mIdleCount = 0;
+    std::chrono::nanoseconds mNextSleep{0};
+    std::chrono::steady_clock::time_point mWaitStart;
+    std::chrono::nanoseconds mRequestedWait{0};
+    bool mHasWaited = false;
+
+    WaitStatistics mStatistics;
+};
+
+template<typename C, typename T>
+std::basic_ostream<C, T>& operator<<(std::basic_ostream<C, T>& strm, const WaitStatistics& stats)
+{
+    strm << "wake_ups=" << stats.mWakeUps << " pauses=" << stats.mPauses << " yields="
+         << stats.mYields << " sleeps=" << stats.mSleeps << " oversleep_avg_ns="
+         << ((stats.mTimedWaits != 0) ? stats.mTotalOversleep.count() / stats.mTimedWaits : 0)
+         << " oversleep_max_ns=" << stats.mMaximumOversleep.count();
+    return strm;
+}
+
+}
+
+#endif //CPPREADY_TRADER_GO_LIBS_READY_TRADER_GO_WAITSTRATEGY_H
@@ -20,6 +20,8 @@ import mmap
 import os
 import struct
 
+from multiprocessing import resource_tracker, shared_memory
+
 from typing import Coroutine, Optional, Tuple, Union
 
 BUFFER_SIZE = 8192
@@ -100,6 +102,24 @@ class MmapPublisher(Publisher):
             self.__fileno = None
 
 
+class ShmPublisher(Publisher):
+    """A publisher based on a POSIX shared memory block."""
+    __slots__ = ("__shm",)
+
+    def __init__(self, shm: shared_memory.SharedMemory, protocol: asyncio.BaseProtocol):
+        super().__init__(shm.buf, protocol)
+        self.__shm: Optional[shared_memory.SharedMemory] = shm
+
+    def close(self) -> None:
+        """Close the publisher and remove the shared memory block."""
+        super().close()
+        if self.__shm:
+            self._buffer = None
+            self.__shm.close()
+            self.__shm.unlink()
+            self.__shm = None
+
+
 class Subscriber(asyncio.DatagramTransport):
     """Subscriber side of a datagram transport based on shared memory.
 
@@ -187,6 +207,25 @@ class MmapSubscriber(Subscriber):
             self.__fileno = None
 
 
+class ShmSubscriber(Subscriber):
+    """A subscriber based on a POSIX shared memory block."""
+    __slots__ = ("__shm",)
+
+    def __init__(self, shm: shared_memory.SharedMemory, from_addr: Tuple[str, int],
+                 protocol: Optional[asyncio.DatagramProtocol] = None):
+        super().__init__(shm.buf, from_addr, protocol)
+        self.__shm: Optional[shared_memory.SharedMemory] = shm
+        self._task.add_done_callback(lambda _: self.__close_shm())
+
+    def __del__(self):
+        self.__close_shm()
+
+    def __close_shm(self):
+        if self.__shm:
+            self.__shm.close()
+            self.__shm = None
+
+
 class PublisherFactory:
     """A factory class for Publisher instances."""
     def __init__(self, typ: str, name: str):
@@ -212,7 +251,15 @@ class PublisherFactory:
             os.write(fileno, b"\x00" * BUFFER_SIZE)
             buffer = mmap.mmap(fileno, BUFFER_SIZE, access=mmap.ACCESS_WRITE)
             return MmapPublisher(fileno, buffer, protocol)
-        raise RuntimeError("PublisherFactory type was not 'mmap'")
+        if self.__typ == "shm":
+            try:
+                shm = shared_memory.SharedMemory(self.__name, create=True, size=BUFFER_SIZE)
+            except FileExistsError:
+                # Left behind by a previous run
+                shared_memory.SharedMemory(self.__name).unlink()
+                shm = shared_memory.SharedMemory(self.__name, create=True, size=BUFFER_SIZE)
+            return ShmPublisher(shm, protocol)
+        raise RuntimeError("PublisherFactory type was not 'mmap' or 'shm'")
 
 
 class SubscriberFactory:
@@ -239,4 +286,10 @@ class SubscriberFactory:
             fileno = os.open(self.__name, os.O_RDONLY)
             mm = mmap.mmap(fileno, BUFFER_SIZE, access=mmap.ACCESS_READ)
             return MmapSubscriber(fileno, mm, (self.__name, fileno), protocol)
-        raise RuntimeError("SubscriberFactory type was not 'mmap'")
+        if self.__typ == "shm":
+            shm = shared_memory.SharedMemory(self.__name)
+            # The block belongs to the publisher, so stop the resource tracker
+            # removing it when this process exits.
+            resource_tracker.unregister(shm._name, "shared_memory")
+            return ShmSubscriber(shm, (self.__name, 0), protocol)
+        raise RuntimeError("SubscriberFactory type was not 'mmap' or 'shm'")
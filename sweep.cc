@@ -0,0 +1,190 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <backtest/backtest.h>
+#include <backtest/parametergrid.h>
+#include <backtest/workstealingpool.h>
+#include <exchange/exchangeconfig.h>
+#include <market_data/marketevents.h>
+#include <ready_trader_go/logging.h>
+
+#include "autotrader.h"
+
+using namespace ReadyTraderGo;
+
+// Backtest the auto-trader with every combination of a grid of strategy
+// parameters against every one of a set of market data files, running the
+// matches in parallel, and write a line of results for each match as it
+// finishes.
+
+static int usage(const char* program)
+{
+    std::cerr << "usage: " << program << " [options] --param SPEC... MARKET_DATA_FILE...\n"
+                 "\n"
+                 "  --config FILE       exchange configuration (default exchange.json)\n"
+                 "  --latency SECONDS   market time taken by each message (default 0.0001)\n"
+                 "  --log               log to the console (logging is off by default)\n"
+                 "  --output FILE       write results to FILE (default standard output)\n"
+                 "  --param SPEC        strategy parameter values, NAME=V1,V2,... or NAME=FIRST:LAST:STEP\n"
+                 "                      (may be repeated; every combination is tried)\n"
+                 "  --threads N         number of matches to run at once, 0 for one per core (default 0)\n";
+    return 2;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* configFilename = "exchange.json";
+    const char* outputFilename = nullptr;
+    double latency = DEFAULT_BACKTEST_LATENCY;
+    bool log = false;
+    std::size_t threadCount = 0;
+    std::vector<std::string> specifications;
+    std::vector<std::string> marketDataFilenames;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--config") == 0 && hasValue)
+            configFilename = argv[++i];
+        else if (std::strcmp(argv[i], "--latency") == 0 && hasValue)
+            latency = std::strtod(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "--log") == 0)
+            log = true;
+        else if (std::strcmp(argv[i], "--output") == 0 && hasValue)
+            outputFilename = argv[++i];
+        else if (std::strcmp(argv[i], "--param") == 0 && hasValue)
+            specifications.emplace_back(argv[++i]);
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+            threadCount = std::strtoul(argv[++i], nullptr, 10);
+        else if (argv[i][0] != '-')
+            marketDataFilenames.emplace_back(argv[i]);
+        else
+            return usage(argv[0]);
+    }
+    if (marketDataFilenames.empty())
+    {
+        return usage(argv[0]);
+    }
+
+    setLoggingEnabled(log);
+
+    try
+    {
+        ParameterGrid grid;
+        for (const auto& specification : specifications)
+        {
+            grid.Add(specification);
+        }
+
+        boost::property_tree::ptree tree;
+        boost::property_tree::read_json(configFilename, tree);
+        ExchangeConfig config;
+        config.readFromPropertyTree(tree);
+
+        // Each file is read once and shared by all of its matches.
+        std::vector<std::vector<MarketEvent>> events;
+        for (const auto& filename : marketDataFilenames)
+        {
+            events.push_back(readMarketEvents(filename));
+        }
+        std::vector<Backtest> backtests;
+        for (const auto& fileEvents : events)
+        {
+            backtests.emplace_back(config, fileEvents, latency);
+        }
+
+        std::ofstream file;
+        if (outputFilename)
+        {
+            file.open(outputFilename);
+            if (!file)
+            {
+                std::cerr << "sweep: failed to open '" << outputFilename << "': " << std::strerror(errno) << '\n';
+                return EXIT_FAILURE;
+            }
+        }
+        std::ostream& output = outputFilename ? file : std::cout;
+        std::mutex outputMutex;
+
+        output << "file";
+        for (const auto& axis : grid.GetAxes())
+        {
+            output << ',' << axis.first;
+        }
+        output << ",profit,fees,max_drawdown,etf_position,future_position,max_etf_position,buy_volume,sell_volume"
+                  ",order_fills,hedge_fills,end_time,breached\n" << std::flush;
+
+        const auto start = std::chrono::steady_clock::now();
+        WorkStealingPool pool{threadCount};
+
+        // The file changes fastest so that the threads start on different files.
+        for (std::size_t combination = 0; combination < grid.GetSize(); ++combination)
+        {
+            for (std::size_t f = 0; f < backtests.size(); ++f)
+            {
+                pool.Submit([&, combination, f] {
+                    const StrategyParameters parameters = grid.GetParameters(combination);
+
+                    boost::asio::io_context context;
+                    AutoTrader autoTrader{context};
+                    autoTrader.SetParameters(parameters);
+                    const BacktestResult result = backtests[f].Run(autoTrader, context);
+
+                    std::lock_guard<std::mutex> lock(outputMutex);
+                    output << marketDataFilenames[f];
+                    for (const auto& axis : grid.GetAxes())
+                    {
+                        output << ',' << parameters.Get(axis.first, 0.0);
+                    }
+                    output << ',' << result.mProfitOrLoss << ',' << result.mTotalFees << ',' << result.mMaxDrawdown
+                           << ',' << result.mEtfPosition << ',' << result.mFuturePosition
+                           << ',' << result.mMaxEtfPosition << ',' << result.mBuyVolume << ',' << result.mSellVolume
+                           << ',' << result.mOrderFillCount << ',' << result.mHedgeFillCount
+                           << ',' << result.mEndTime << ',' << !result.mBreachMessage.empty() << std::endl;
+                });
+            }
+        }
+        pool.Wait();
+
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cerr << "played " << grid.GetSize() * backtests.size() << " matches in " << elapsed.count()
+                  << " seconds on " << pool.GetThreadCount() << " threads (" << pool.GetStealCount()
+                  << " stolen)\n";
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "sweep: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
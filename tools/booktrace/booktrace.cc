@@ -0,0 +1,207 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include <market_data/marketevents.h>
+#include <matching_engine/marketreplay.h>
+#include <matching_engine/orderbook.h>
+
+using namespace ReadyTraderGo;
+
+// Replays a market data file through the order books and writes a line for
+// every order book event and the top of the book after each market event.
+// booktrace.py writes the same trace using the Python order book, so that
+// the two can be compared (see crosscheck.py). The tick size only changes
+// how the C++ book lays out its levels, so the traces should match for any.
+class Tracer : public MarketReplay
+{
+public:
+    Tracer(double makerFee, double takerFee, unsigned long tickSize, bool quiet)
+        : MarketReplay(mFutureBook, mEtfBook),
+          mFutureBook(Instrument::FUTURE, makerFee, takerFee, tickSize),
+          mEtfBook(Instrument::ETF, makerFee, takerFee, tickSize),
+          mQuiet(quiet)
+    {
+    }
+
+    void Trace(const MarketEvent& event);
+
+    void OrderAmended(double now, Order& order, unsigned long volumeRemoved) override;
+    void OrderCancelled(double now, Order& order, unsigned long volumeRemoved) override;
+    void OrderFilled(double now, Order& order, unsigned long price, unsigned long volume, long fee) override;
+    void OrderPlaced(double now, Order& order) override;
+
+private:
+    void WriteBook(OrderBook& book);
+
+    // The base class only keeps references to the books.
+    OrderBook mFutureBook;
+    OrderBook mEtfBook;
+    bool mQuiet;
+    unsigned long mEventNumber = 0;
+};
+
+static void writeLevels(const char* name,
+                        const std::array<unsigned long, TOP_LEVEL_COUNT>& prices,
+                        const std::array<unsigned long, TOP_LEVEL_COUNT>& volumes)
+{
+    std::cout << ' ' << name;
+    for (std::size_t i = 0; i < TOP_LEVEL_COUNT && prices[i] != 0; ++i)
+    {
+        std::cout << ' ' << prices[i] << ':' << volumes[i];
+    }
+}
+
+void Tracer::Trace(const MarketEvent& event)
+{
+    ++mEventNumber;
+    WriteBook(Apply(event));
+}
+
+void Tracer::WriteBook(OrderBook& book)
+{
+    std::array<unsigned long, TOP_LEVEL_COUNT> askPrices;
+    std::array<unsigned long, TOP_LEVEL_COUNT> askVolumes;
+    std::array<unsigned long, TOP_LEVEL_COUNT> bidPrices;
+    std::array<unsigned long, TOP_LEVEL_COUNT> bidVolumes;
+
+    book.TopLevels(askPrices, askVolumes, bidPrices, bidVolumes);
+    if (!mQuiet)
+    {
+        std::cout << "book " << mEventNumber << ' ' << book.GetInstrument() << " last "
+                  << book.GetLastTradedPrice();
+        writeLevels("asks", askPrices, askVolumes);
+        writeLevels("bids", bidPrices, bidVolumes);
+        std::cout << '\n';
+    }
+
+    if (book.TradeTicks(askPrices, askVolumes, bidPrices, bidVolumes) && !mQuiet)
+    {
+        std::cout << "ticks " << mEventNumber << ' ' << book.GetInstrument();
+        writeLevels("asks", askPrices, askVolumes);
+        writeLevels("bids", bidPrices, bidVolumes);
+        std::cout << '\n';
+    }
+}
+
+void Tracer::OrderAmended(double now, Order& order, unsigned long volumeRemoved)
+{
+    if (!mQuiet)
+    {
+        std::cout << "amend " << order.mInstrument << ' ' << order.mClientOrderId << ' ' << volumeRemoved << ' '
+                  << order.mRemainingVolume << '\n';
+    }
+    MarketReplay::OrderAmended(now, order, volumeRemoved);
+}
+
+void Tracer::OrderCancelled(double now, Order& order, unsigned long volumeRemoved)
+{
+    if (!mQuiet)
+    {
+        std::cout << "cancel " << order.mInstrument << ' ' << order.mClientOrderId << ' ' << volumeRemoved << '\n';
+    }
+    MarketReplay::OrderCancelled(now, order, volumeRemoved);
+}
+
+void Tracer::OrderFilled(double now, Order& order, unsigned long price, unsigned long volume, long fee)
+{
+    if (!mQuiet)
+    {
+        std::cout << "fill " << order.mInstrument << ' ' << order.mClientOrderId << ' ' << price << ' ' << volume
+                  << ' ' << fee << ' ' << order.mRemainingVolume << ' ' << order.mTotalFees << '\n';
+    }
+    MarketReplay::OrderFilled(now, order, price, volume, fee);
+}
+
+void Tracer::OrderPlaced(double now, Order& order)
+{
+    if (!mQuiet)
+    {
+        std::cout << "place " << order.mInstrument << ' ' << order.mClientOrderId << ' ' << order.mRemainingVolume
+                  << '\n';
+    }
+    MarketReplay::OrderPlaced(now, order);
+}
+
+static int usage(const char* program)
+{
+    std::cerr << "usage: " << program << " [--quiet] [--maker-fee FEE] [--taker-fee FEE] [--tick-size CENTS]"
+                 " MARKET_DATA_FILE\n";
+    return 2;
+}
+
+int main(int argc, char* argv[])
+{
+    double makerFee = -0.0001;
+    double takerFee = 0.0002;
+    unsigned long tickSize = 1;
+    bool quiet = false;
+    const char* filename = nullptr;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--quiet") == 0)
+            quiet = true;
+        else if (std::strcmp(argv[i], "--maker-fee") == 0 && i + 1 < argc)
+            makerFee = std::strtod(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "--taker-fee") == 0 && i + 1 < argc)
+            takerFee = std::strtod(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "--tick-size") == 0 && i + 1 < argc)
+            tickSize = std::max(std::strtoul(argv[++i], nullptr, 10), 1ul);
+        else if (argv[i][0] != '-' && !filename)
+            filename = argv[i];
+        else
+            return usage(argv[0]);
+    }
+    if (!filename)
+    {
+        return usage(argv[0]);
+    }
+
+    try
+    {
+        const auto events = readMarketEvents(filename);
+        Tracer tracer{makerFee, takerFee, tickSize, quiet};
+
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& event : events)
+        {
+            tracer.Trace(event);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout.flush();
+        std::cerr << "applied " << events.size() << " market events in " << elapsed.count() << " seconds ("
+                  << static_cast<unsigned long>(events.size() / elapsed.count()) << " events per second)\n";
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "booktrace: " << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+# Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+#
+# This file is part of Ready Trader Go.
+#
+#     Ready Trader Go is free software: you can redistribute it and/or
+#     modify it under the terms of the GNU Affero General Public License
+#     as published by the Free Software Foundation, either version 3 of
+#     the License, or (at your option) any later version.
+#
+#     Ready Trader Go is distributed in the hope that it will be useful,
+#     but WITHOUT ANY WARRANTY; without even the implied warranty of
+#     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#     GNU Affero General Public License for more details.
+#
+#     You should have received a copy of the GNU Affero General Public
+#     License along with Ready Trader Go.  If not, see
+#     <https://www.gnu.org/licenses/>.
+"""Write the trace that booktrace writes, using the Python order book.
+
+Replays a market data file through ready_trader_go.order_book.OrderBook and
+writes a line for every order book event and the top of the book after each
+market event, in exactly the format of the C++ booktrace tool.
+"""
+import argparse
+import csv
+import os
+import sys
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), os.pardir, os.pardir))
+
+from ready_trader_go.order_book import IOrderListener, Order, OrderBook, TOP_LEVEL_COUNT  # noqa: E402
+from ready_trader_go.types import Instrument, Lifespan, Side  # noqa: E402
+
+INPUT_SCALING = 100
+INSTRUMENT_NAMES = {Instrument.FUTURE: "Future", Instrument.ETF: "ETF"}
+
+
+class Tracer(IOrderListener):
+    def __init__(self, maker_fee: float, taker_fee: float, out):
+        self.books = {i: OrderBook(i, maker_fee, taker_fee) for i in (Instrument.FUTURE, Instrument.ETF)}
+        self.orders = {i: dict() for i in (Instrument.FUTURE, Instrument.ETF)}
+        self.event_number = 0
+        self.out = out
+
+    def apply(self, row) -> None:
+        # time, instrument, operation, order_id, side, volume, price, lifespan
+        now = float(row[0])
+        instrument = Instrument(int(row[1]))
+        order_id = int(row[3])
+        volume = int(float(row[5])) if row[5] else 0
+        book = self.books[instrument]
+        orders = self.orders[instrument]
+
+        self.event_number += 1
+        if row[2] in ("Insert", "INSERT"):
+            order = Order(order_id, instrument, Lifespan[row[7]], Side[row[4]],
+                          int(float(row[6]) * INPUT_SCALING) if row[6] else 0, volume, self)
+            book.insert(now, order)
+        elif order_id in orders:
+            order = orders[order_id]
+            if row[2] in ("Cancel", "CANCEL"):
+                book.cancel(now, order)
+            elif volume < 0:
+                book.amend(now, order, order.volume + volume)
+
+        self.write_book(book)
+
+    def write_levels(self, name, prices, volumes) -> str:
+        return " " + name + "".join(" %d:%d" % (p, v) for p, v in zip(prices, volumes) if p)
+
+    def write_book(self, book: OrderBook) -> None:
+        ask_prices = [0] * TOP_LEVEL_COUNT
+        ask_volumes = [0] * TOP_LEVEL_COUNT
+        bid_prices = [0] * TOP_LEVEL_COUNT
+        bid_volumes = [0] * TOP_LEVEL_COUNT
+        name = INSTRUMENT_NAMES[book.instrument]
+
+        book.top_levels(ask_prices, ask_volumes, bid_prices, bid_volumes)
+        self.out.write("book %d %s last %d%s%s\n" % (self.event_number, name, book.last_traded_price() or 0,
+                                                     self.write_levels("asks", ask_prices, ask_volumes),
+                                                     self.write_levels("bids", bid_prices, bid_volumes)))
+
+        if book.trade_ticks(ask_prices, ask_volumes, bid_prices, bid_volumes):
+            self.out.write("ticks %d %s%s%s\n" % (self.event_number, name,
+                                                  self.write_levels("asks", ask_prices, ask_volumes),
+                                                  self.write_levels("bids", bid_prices, bid_volumes)))
+
+    def on_order_amended(self, now: float, order: Order, volume_removed: int) -> None:
+        self.out.write("amend %s %d %d %d\n" % (INSTRUMENT_NAMES[order.instrument], order.client_order_id,
+                                                volume_removed, order.remaining_volume))
+        if order.remaining_volume == 0:
+            self.orders[order.instrument].pop(order.client_order_id, None)
+
+    def on_order_cancelled(self, now: float, order: Order, volume_removed: int) -> None:
+        self.out.write("cancel %s %d %d\n" % (INSTRUMENT_NAMES[order.instrument], order.client_order_id,
+                                              volume_removed))
+        self.orders[order.instrument].pop(order.client_order_id, None)
+
+    def on_order_filled(self, now: float, order: Order, price: int, volume: int, fee: int) -> None:
+        self.out.write("fill %s %d %d %d %d %d %d\n" % (INSTRUMENT_NAMES[order.instrument], order.client_order_id,
+                                                        price, volume, fee, order.remaining_volume,
+                                                        order.total_fees))
+        if order.remaining_volume == 0:
+            self.orders[order.instrument].pop(order.client_order_id, None)
+
+    def on_order_placed(self, now: float, order: Order) -> None:
+        self.out.write("place %s %d %d\n" % (INSTRUMENT_NAMES[order.instrument], order.client_order_id,
+                                             order.remaining_volume))
+        self.orders[order.instrument][order.client_order_id] = order
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--maker-fee", type=float, default=-0.0001)
+    parser.add_argument("--taker-fee", type=float, default=0.0002)
+    parser.add_argument("filename")
+    args = parser.parse_args()
+
+    tracer = Tracer(args.maker_fee, args.taker_fee, sys.stdout)
+    start = time.monotonic()
+    with open(args.filename, newline="") as market_data:
+        reader = csv.reader(market_data)
+        next(reader)  # Skip header row
+        for row in reader:
+            if row:
+                tracer.apply(row)
+    elapsed = time.monotonic() - start
+
+    sys.stdout.flush()
+    print("applied %d market events in %g seconds (%d events per second)"
+          % (tracer.event_number, elapsed, tracer.event_number / elapsed), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,58 @@
+# Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+#
+# This file is part of Ready Trader Go.
+#
+#     Ready Trader Go is free software: you can redistribute it and/or
+#     modify it under the terms of the GNU Affero General Public License
+#     as published by the Free Software Foundation, either version 3 of
+#     the License, or (at your option) any later version.
+#
+#     Ready Trader Go is distributed in the hope that it will be useful,
+#     but WITHOUT ANY WARRANTY; without even the implied warranty of
+#     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#     GNU Affero General Public License for more details.
+#
+#     You should have received a copy of the GNU Affero General Public
+#     License along with Ready Trader Go.  If not, see
+#     <https://www.gnu.org/licenses/>.
+"""Check the C++ order book against the Python one on a market data file.
+
+Runs booktrace (C++) and booktrace.py (Python) on the same file and reports
+the first line at which their traces differ.
+"""
+import argparse
+import itertools
+import os
+import subprocess
+import sys
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--maker-fee", default="-0.0001")
+    parser.add_argument("--taker-fee", default="0.0002")
+    parser.add_argument("--tick-size", default="1", help="tick size in cents for the C++ order book")
+    parser.add_argument("booktrace", help="path to the booktrace executable")
+    parser.add_argument("filename", help="market data file")
+    args = parser.parse_args()
+
+    fees = ["--maker-fee", args.maker_fee, "--taker-fee", args.taker_fee]
+    script = os.path.join(os.path.dirname(os.path.abspath(__file__)), "booktrace.py")
+    native = subprocess.run([args.booktrace, "--tick-size", args.tick_size] + fees + [args.filename], check=True,
+                            stdout=subprocess.PIPE, universal_newlines=True)
+    python = subprocess.run([sys.executable, script] + fees + [args.filename], check=True, stdout=subprocess.PIPE,
+                            universal_newlines=True)
+
+    native_lines = native.stdout.splitlines()
+    python_lines = python.stdout.splitlines()
+    for number, (a, b) in enumerate(itertools.zip_longest(native_lines, python_lines), 1):
+        if a != b:
+            print("traces differ at line %d:\n  C++:    %s\n  Python: %s" % (number, a, b))
+            return 1
+
+    print("traces match: %d lines" % len(native_lines))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
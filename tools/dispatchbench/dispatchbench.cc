@@ -0,0 +1,227 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+
+#include <ready_trader_go/baseautotrader.h>
+#include <ready_trader_go/connectivitytypes.h>
+#include <ready_trader_go/protocol.h>
+#include <ready_trader_go/staticautotrader.h>
+
+using namespace ReadyTraderGo;
+
+// Measures the cost of getting an order book message from the subscription
+// to a strategy's handler through each of the auto-trader dispatch paths:
+// BaseAutoTrader's virtual view handler, its default decode into the array
+// handler, and StaticAutoTrader's compile-time dispatch. Every trader does
+// the same small piece of work per message so the results can be checked
+// against each other.
+
+constexpr std::size_t FRAME_COUNT = 1024;
+
+// A subscription that hands prepared messages straight to the auto-trader.
+class BenchSubscription : public ISubscription
+{
+public:
+    void AsyncReceive() override {}
+    std::size_t Poll() override { return 0; }
+
+    void Deliver(unsigned char const* data, std::size_t size, ReceiveTime receiveTime)
+    {
+        OnMessageReceipt(MessageType::ORDER_BOOK_UPDATE, data, size, receiveTime);
+    }
+};
+
+// The work done for each order book message: fold the best prices and the
+// instrument into a checksum.
+inline void updateChecksum(unsigned long& checksum, Instrument instrument, unsigned long ask, unsigned long bid)
+{
+    checksum = checksum * 31 + static_cast<unsigned long>(instrument) + ask + bid;
+}
+
+class ViewAutoTrader : public BaseAutoTrader
+{
+public:
+    using BaseAutoTrader::BaseAutoTrader;
+    unsigned long mChecksum = 0;
+
+protected:
+    void OrderBookMessageHandler(const OrderBookView& book, ReceiveTime) override
+    {
+        updateChecksum(mChecksum, book.GetInstrument(), book.GetAskPrice(0), book.GetBidPrice(0));
+    }
+};
+
+class ArrayAutoTrader : public BaseAutoTrader
+{
+public:
+    using BaseAutoTrader::BaseAutoTrader;
+    unsigned long mChecksum = 0;
+
+protected:
+    void OrderBookMessageHandler(Instrument instrument,
+                                 unsigned long,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>& askPrices,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>&,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>&) override
+    {
+        updateChecksum(mChecksum, instrument, askPrices[0], bidPrices[0]);
+    }
+};
+
+class CompileTimeAutoTrader : public StaticAutoTrader<CompileTimeAutoTrader>
+{
+public:
+    using StaticAutoTrader::StaticAutoTrader;
+    unsigned long mChecksum = 0;
+
+    void OnOrderBook(const OrderBookView& book, ReceiveTime)
+    {
+        updateChecksum(mChecksum, book.GetInstrument(), book.GetAskPrice(0), book.GetBidPrice(0));
+    }
+};
+
+static std::vector<unsigned char> makeFrames()
+{
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<unsigned long> ticks{9000, 11000};
+    OrderBookMessage message;
+    std::vector<unsigned char> frames(FRAME_COUNT * message.Size());
+
+    for (std::size_t i = 0; i != FRAME_COUNT; ++i)
+    {
+        message.mInstrument = (i & 1) ? Instrument::ETF : Instrument::FUTURE;
+        message.mSequenceNumber = i + 1;
+        const unsigned long bid = ticks(generator) * 100;
+        for (std::size_t level = 0; level != TOP_LEVEL_COUNT; ++level)
+        {
+            message.mAskPrices[level] = bid + (level + 1) * 100;
+            message.mBidPrices[level] = bid - level * 100;
+            message.mAskVolumes[level] = message.mBidVolumes[level] = (level + 1) * 10;
+        }
+        message.Serialise(frames.data() + i * message.Size());
+    }
+
+    return frames;
+}
+
+// Deliver count messages, cycling through the frames, and return the best
+// nanoseconds per message over the given number of repeats.
+template<typename T>
+static double run(const std::vector<unsigned char>& frames,
+                  unsigned long count,
+                  unsigned long repeats,
+                  unsigned long& checksum)
+{
+    const std::size_t size = OrderBookMessage().Size();
+    double best = std::numeric_limits<double>::max();
+
+    for (unsigned long r = 0; r != repeats; ++r)
+    {
+        boost::asio::io_context context;
+        T autoTrader{context};
+        auto subscription = std::make_shared<BenchSubscription>();
+        BenchSubscription* target = subscription.get();
+        autoTrader.SetInformationSubscription(std::move(subscription));
+
+        const ReceiveTime receiveTime = std::chrono::steady_clock::now();
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned long i = 0; i != count; ++i)
+        {
+            target->Deliver(frames.data() + (i % FRAME_COUNT) * size, size, receiveTime);
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+        best = std::min(best, elapsed.count() / static_cast<double>(count));
+        checksum = autoTrader.mChecksum;
+    }
+
+    return best;
+}
+
+static int usage(const char* program)
+{
+    std::cerr << "usage: " << program << " [options]\n"
+                 "\n"
+                 "  --count N     order book messages per run (default 10000000)\n"
+                 "  --repeat N    runs of each dispatch path, the best is reported (default 5)\n";
+    return 2;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned long count = 10000000;
+    unsigned long repeats = 5;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--count") == 0 && hasValue)
+            count = std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--repeat") == 0 && hasValue)
+            repeats = std::strtoul(argv[++i], nullptr, 10);
+        else
+            return usage(argv[0]);
+    }
+    if (count == 0 || repeats == 0)
+    {
+        return usage(argv[0]);
+    }
+
+    try
+    {
+        const auto frames = makeFrames();
+        unsigned long viewChecksum = 0;
+        unsigned long arrayChecksum = 0;
+        unsigned long staticChecksum = 0;
+
+        const double view = run<ViewAutoTrader>(frames, count, repeats, viewChecksum);
+        const double array = run<ArrayAutoTrader>(frames, count, repeats, arrayChecksum);
+        const double compileTime = run<CompileTimeAutoTrader>(frames, count, repeats, staticChecksum);
+
+        std::cout << "virtual view handler:   " << view << " ns/message\n"
+                  << "virtual array handler:  " << array << " ns/message\n"
+                  << "static handler:         " << compileTime << " ns/message\n";
+
+        if (viewChecksum != arrayChecksum || viewChecksum != staticChecksum)
+        {
+            std::cerr << "dispatchbench: handlers disagree\n";
+            return EXIT_FAILURE;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "dispatchbench: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
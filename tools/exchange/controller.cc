@@ -0,0 +1,165 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cmath>
+
+#include <boost/asio/post.hpp>
+
+#include <ready_trader_go/logging.h>
+
+#include "controller.h"
+
+RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_CTRL, "CONTROLLER")
+
+namespace ReadyTraderGo {
+
+Controller::Controller(boost::asio::io_context& context,
+                       const ExchangeConfig& config,
+                       ExecutionServer& executionServer,
+                       InformationPublisher& informationPublisher,
+                       MarketEventsReader& marketEventsReader,
+                       CompetitorManager& competitorManager)
+    : mContext(context),
+      mExecutionServer(executionServer),
+      mInformationPublisher(informationPublisher),
+      mMarketEventsReader(marketEventsReader),
+      mCompetitorManager(competitorManager),
+      mMarketEventInterval(config.mMarketEventInterval),
+      mMarketOpenDelay(config.mMarketOpenDelay),
+      mSpeed(config.mSpeed),
+      mTickInterval(config.mTickInterval),
+      mMarketTimer(context),
+      mTickTimer(context)
+{
+    mMarketEventsReader.Completed = [this] { mIsDone = true; };
+}
+
+double Controller::AdvanceTime()
+{
+    if (!mIsStarted)
+    {
+        return 0.0;
+    }
+
+    const double now = GetElapsedTime();
+    mMarketEventsReader.ProcessMarketEvents(now);
+    return now;
+}
+
+double Controller::GetElapsedTime() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - mStartTime).count() * mSpeed;
+}
+
+std::chrono::steady_clock::time_point Controller::GetDueTime(double marketTime) const
+{
+    return mStartTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(marketTime / mSpeed));
+}
+
+void Controller::Start()
+{
+    RLOG(LG_CTRL, LogLevel::LL_INFO) << "starting the match";
+    mExecutionServer.Start();
+    mMarketEventsReader.Start();
+
+    // Give the auto-traders time to start up and connect
+    mMarketTimer.expires_after(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(mMarketOpenDelay)));
+    mMarketTimer.async_wait([this](const boost::system::error_code& error) {
+        if (!error)
+        {
+            MarketOpen();
+        }
+    });
+}
+
+void Controller::MarketOpen()
+{
+    RLOG(LG_CTRL, LogLevel::LL_INFO) << "market open";
+    mStartTime = std::chrono::steady_clock::now();
+    mIsStarted = true;
+    mCompetitorManager.SetMarketOpen();
+
+    MarketTimerHandler({});
+    TickTimerHandler({});
+}
+
+void Controller::MarketTimerHandler(const boost::system::error_code& error)
+{
+    if (error || mIsShutdown)
+    {
+        return;
+    }
+
+    mMarketEventsReader.ProcessMarketEvents(GetElapsedTime());
+
+    mMarketEventTime += mMarketEventInterval;
+    mMarketTimer.expires_at(GetDueTime(mMarketEventTime));
+    mMarketTimer.async_wait([this](const boost::system::error_code& e) { MarketTimerHandler(e); });
+}
+
+void Controller::TickTimerHandler(const boost::system::error_code& error)
+{
+    if (error || mIsShutdown)
+    {
+        return;
+    }
+
+    const double now = GetElapsedTime();
+
+    // There may have been a delay, so work out which tick this really is.
+    const double skippedTicks = std::max(0.0, std::floor((now - mTickTime) / mTickInterval));
+    mTickTime += mTickInterval * skippedTicks;
+    mTickNumber += static_cast<unsigned long>(skippedTicks);
+
+    if (mIsDone)
+    {
+        Shutdown(now, "match complete");
+        return;
+    }
+
+    mInformationPublisher.TimerTicked(now, mTickNumber);
+    mCompetitorManager.TimerTicked(now);
+
+    if (mCompetitorManager.GetActiveCompetitorCount() == 0)
+    {
+        Shutdown(now, "no remaining competitors");
+        return;
+    }
+
+    mTickTime += mTickInterval;
+    ++mTickNumber;
+    mTickTimer.expires_at(GetDueTime(mTickTime));
+    mTickTimer.async_wait([this](const boost::system::error_code& e) { TickTimerHandler(e); });
+}
+
+void Controller::Shutdown(double now, const std::string& reason)
+{
+    RLOG(LG_CTRL, LogLevel::LL_INFO) << "shutting down the match: time=" << now << " reason='" << reason << '\'';
+    mIsShutdown = true;
+    mMarketTimer.cancel();
+    mTickTimer.cancel();
+    mExecutionServer.Close();
+    mCompetitorManager.DisconnectAll(now);
+
+    // Let the connections finish closing before stopping.
+    boost::asio::post(mContext, [this] { mContext.stop(); });
+}
+
+}
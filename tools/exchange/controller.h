@@ -0,0 +1,88 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_TOOLS_EXCHANGE_CONTROLLER_H
+#define CPPREADY_TRADER_GO_TOOLS_EXCHANGE_CONTROLLER_H
+
+#include <chrono>
+#include <string>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <exchange/competitor.h>
+#include <exchange/exchangeconfig.h>
+
+#include "exchangetypes.h"
+#include "execution.h"
+#include "information.h"
+#include "marketevents.h"
+
+namespace ReadyTraderGo {
+
+// Runs the match: opens the market after the configured delay, feeds in
+// market events and drives the information publisher's ticks until the
+// market data is exhausted or every competitor has gone.
+class Controller : public IController
+{
+public:
+    Controller(boost::asio::io_context& context,
+               const ExchangeConfig& config,
+               ExecutionServer& executionServer,
+               InformationPublisher& informationPublisher,
+               MarketEventsReader& marketEventsReader,
+               CompetitorManager& competitorManager);
+
+    double AdvanceTime() override;
+
+    void Start();
+
+private:
+    double GetElapsedTime() const;
+    std::chrono::steady_clock::time_point GetDueTime(double marketTime) const;
+
+    void MarketOpen();
+    void MarketTimerHandler(const boost::system::error_code& error);
+    void Shutdown(double now, const std::string& reason);
+    void TickTimerHandler(const boost::system::error_code& error);
+
+    boost::asio::io_context& mContext;
+    ExecutionServer& mExecutionServer;
+    InformationPublisher& mInformationPublisher;
+    MarketEventsReader& mMarketEventsReader;
+    CompetitorManager& mCompetitorManager;
+
+    double mMarketEventInterval;
+    double mMarketOpenDelay;
+    double mSpeed;
+    double mTickInterval;
+
+    boost::asio::steady_timer mMarketTimer;
+    boost::asio::steady_timer mTickTimer;
+    std::chrono::steady_clock::time_point mStartTime;
+    bool mIsStarted = false;
+    bool mIsDone = false;
+    bool mIsShutdown = false;
+    double mMarketEventTime = 0.0;
+    double mTickTime = 0.0;
+    unsigned long mTickNumber = 1;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_TOOLS_EXCHANGE_CONTROLLER_H
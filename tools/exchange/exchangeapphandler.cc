@@ -0,0 +1,62 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <exchange/exchangeconfig.h>
+#include <ready_trader_go/connectivity.h>
+#include <ready_trader_go/publisher.h>
+
+#include "exchangeapphandler.h"
+
+namespace ReadyTraderGo {
+
+void ExchangeAppHandler::ConfigLoadedHandler(const boost::property_tree::ptree& tree)
+{
+    ExchangeConfig config;
+    config.readFromPropertyTree(tree);
+
+    mEtfBook = std::make_unique<OrderBook>(Instrument::ETF, config.mMakerFee, config.mTakerFee);
+    mFutureBook = std::make_unique<OrderBook>(Instrument::FUTURE, config.mMakerFee, config.mTakerFee);
+    mCompetitorManager = std::make_unique<CompetitorManager>(config, *mEtfBook, *mFutureBook);
+    mMarketEventsReader = std::make_unique<MarketEventsReader>(config.mMarketDataFile, *mFutureBook, *mEtfBook);
+    mInformationPublisher = std::make_unique<InformationPublisher>(
+        mContext, std::make_unique<Publisher>(config.mInfoType, config.mInfoName), *mFutureBook, *mEtfBook);
+
+    ConnectionOptions execOptions;
+    execOptions.mReceiveBufferSize = config.mExecReceiveBufferSize;
+    execOptions.mSendBufferSize = config.mExecSendBufferSize;
+    mExecutionServer = std::make_unique<ExecutionServer>(mContext,
+                                                         config.mExecHost,
+                                                         config.mExecPort,
+                                                         execOptions,
+                                                         *mCompetitorManager,
+                                                         config.mMessageFrequencyInterval,
+                                                         config.mMessageFrequencyLimit);
+    mController = std::make_unique<Controller>(mContext,
+                                               config,
+                                               *mExecutionServer,
+                                               *mInformationPublisher,
+                                               *mMarketEventsReader,
+                                               *mCompetitorManager);
+    mExecutionServer->SetController(mController.get());
+}
+
+void ExchangeAppHandler::ReadyToRunHandler()
+{
+    mController->Start();
+}
+
+}
@@ -0,0 +1,66 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_TOOLS_EXCHANGE_EXCHANGEAPPHANDLER_H
+#define CPPREADY_TRADER_GO_TOOLS_EXCHANGE_EXCHANGEAPPHANDLER_H
+
+#include <memory>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <exchange/competitor.h>
+#include <matching_engine/orderbook.h>
+#include <ready_trader_go/application.h>
+
+#include "controller.h"
+#include "execution.h"
+#include "information.h"
+#include "marketevents.h"
+
+namespace ReadyTraderGo {
+
+// Builds the exchange from its configuration and starts the match.
+class ExchangeAppHandler
+{
+public:
+    explicit ExchangeAppHandler(Application& application)
+        : mApplication(application), mContext(mApplication.GetContext())
+    {
+        mApplication.ConfigLoaded = [this](auto& tree) { ConfigLoadedHandler(tree); };
+        mApplication.ReadyToRun = [this] { ReadyToRunHandler(); };
+    }
+
+private:
+    void ConfigLoadedHandler(const boost::property_tree::ptree& tree);
+    void ReadyToRunHandler();
+
+    Application& mApplication;
+    boost::asio::io_context& mContext;
+
+    std::unique_ptr<OrderBook> mEtfBook;
+    std::unique_ptr<OrderBook> mFutureBook;
+    std::unique_ptr<CompetitorManager> mCompetitorManager;
+    std::unique_ptr<MarketEventsReader> mMarketEventsReader;
+    std::unique_ptr<InformationPublisher> mInformationPublisher;
+    std::unique_ptr<ExecutionServer> mExecutionServer;
+    std::unique_ptr<Controller> mController;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_TOOLS_EXCHANGE_EXCHANGEAPPHANDLER_H
@@ -0,0 +1,281 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <utility>
+
+#include <boost/asio/ip/address.hpp>
+#include <boost/asio/post.hpp>
+
+#include <ready_trader_go/error.h>
+#include <ready_trader_go/logging.h>
+#include <ready_trader_go/protocol.h>
+
+#include "execution.h"
+
+RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_EXEC, "EXECUTION")
+
+namespace ReadyTraderGo {
+
+ExecutionConnection::ExecutionConnection(boost::asio::io_context& context,
+                                         std::unique_ptr<IConnection>&& connection,
+                                         CompetitorManager& competitorManager,
+                                         FrequencyLimiter frequencyLimiter,
+                                         IController& controller)
+    : mContext(context),
+      mConnection(std::move(connection)),
+      mCompetitorManager(competitorManager),
+      mFrequencyLimiter(std::move(frequencyLimiter)),
+      mController(controller)
+{
+    mConnection->Disconnected = [this] { ConnectionLost(); };
+    mConnection->MessageReceived = [this](IConnection*,
+                                          unsigned char t,
+                                          unsigned char const* d,
+                                          std::size_t s,
+                                          ReceiveTime) { MessageHandler(t, d, s); };
+}
+
+void ExecutionConnection::Start()
+{
+    mCompetitorManager.CompetitorConnected();
+    mConnection->AsyncRead();
+}
+
+void ExecutionConnection::Close()
+{
+    if (mIsClosing)
+    {
+        return;
+    }
+
+    // As with the Python exchange, the rest of the clean up happens as if
+    // the other end had disconnected, just not from inside the caller.
+    mIsClosing = true;
+    mConnection->Close();
+    boost::asio::post(mContext, [this] { ConnectionLost(); });
+}
+
+void ExecutionConnection::ConnectionLost()
+{
+    if (mIsLost)
+    {
+        return;
+    }
+
+    mIsLost = true;
+    if (!mIsClosing)
+    {
+        RLOG(LG_EXEC, LogLevel::LL_WARNING) << '\'' << mConnection->GetName() << "' lost connection to auto-trader";
+        mIsClosing = true;
+        mConnection->Close();
+    }
+
+    if (mCompetitor)
+    {
+        mCompetitor->ConnectionLost(mController.AdvanceTime());
+    }
+    mCompetitorManager.CompetitorDisconnected();
+}
+
+void ExecutionConnection::LoginHandler(const std::string& name, const std::string& secret)
+{
+    mCompetitor = mCompetitorManager.LoginCompetitor(name, secret, this);
+    if (!mCompetitor)
+    {
+        RLOG(LG_EXEC, LogLevel::LL_INFO) << '\'' << mConnection->GetName() << "' login failed: name='" << name << '\'';
+        Close();
+        return;
+    }
+
+    mConnection->SetName(name);
+    RLOG(LG_EXEC, LogLevel::LL_INFO) << '\'' << name << "' is ready!";
+}
+
+void ExecutionConnection::MessageHandler(unsigned char messageType, unsigned char const* data, std::size_t size)
+{
+    const double now = mController.AdvanceTime();
+
+    // Replies to a message go out in a single write.
+    SendBatch batch{*mConnection};
+
+    if (mFrequencyLimiter.CheckEvent(now))
+    {
+        RLOG(LG_EXEC, LogLevel::LL_INFO) << '\'' << mConnection->GetName()
+                                         << "' message frequency limit breached: now=" << now
+                                         << " value=" << mFrequencyLimiter.GetValue()
+                                         << " limit=" << mFrequencyLimiter.GetLimit();
+        if (mCompetitor)
+        {
+            mCompetitor->HardBreach(now, 0, "message frequency limit breached");
+        }
+        else
+        {
+            Close();
+        }
+        return;
+    }
+
+    if (!mCompetitor)
+    {
+        if (messageType == MessageType::LOGIN && size == LoginMessage().Size())
+        {
+            auto login = makeMessage<LoginMessage>(data, size);
+            LoginHandler(login.mName.ToString(), login.mSecret.ToString());
+        }
+        else
+        {
+            RLOG(LG_EXEC, LogLevel::LL_INFO) << '\'' << mConnection->GetName()
+                                             << "' first message received was not a login";
+            Close();
+        }
+        return;
+    }
+
+    if (!mCompetitor->MessageHandler(now, messageType, data, size))
+    {
+        if (messageType == MessageType::LOGIN)
+        {
+            RLOG(LG_EXEC, LogLevel::LL_INFO) << '\'' << mConnection->GetName()
+                                             << "' received second login message: time=" << now;
+        }
+        else
+        {
+            RLOG(LG_EXEC, LogLevel::LL_INFO) << '\'' << mConnection->GetName()
+                                             << "' received invalid message: time=" << now << " length=" << size
+                                             << " type=" << static_cast<int>(messageType);
+        }
+        Close();
+    }
+}
+
+void ExecutionConnection::SendError(unsigned long clientOrderId, const std::string& message)
+{
+    mConnection->SendMessage(MessageType::ERROR_MESSAGE, ErrorMessage{clientOrderId, message});
+}
+
+void ExecutionConnection::SendHedgeFilled(unsigned long clientOrderId, unsigned long averagePrice, unsigned long volume)
+{
+    mConnection->SendMessage(MessageType::HEDGE_FILLED, HedgeFilledMessage{clientOrderId, averagePrice, volume});
+}
+
+void ExecutionConnection::SendOrderFilled(unsigned long clientOrderId, unsigned long price, unsigned long volume)
+{
+    mConnection->SendMessage(MessageType::ORDER_FILLED, OrderFilledMessage{clientOrderId, price, volume});
+}
+
+void ExecutionConnection::SendOrderStatus(unsigned long clientOrderId,
+                                          unsigned long fillVolume,
+                                          unsigned long remainingVolume,
+                                          long fees)
+{
+    mConnection->SendMessage(MessageType::ORDER_STATUS,
+                             OrderStatusMessage{clientOrderId, fillVolume, remainingVolume, fees});
+}
+
+ExecutionServer::ExecutionServer(boost::asio::io_context& context,
+                                 const std::string& host,
+                                 unsigned short port,
+                                 const ConnectionOptions& options,
+                                 CompetitorManager& competitorManager,
+                                 double frequencyLimitInterval,
+                                 unsigned long frequencyLimit)
+    : mContext(context),
+      mAcceptor(context),
+      mOptions(options),
+      mCompetitorManager(competitorManager),
+      mFrequencyLimitInterval(frequencyLimitInterval),
+      mFrequencyLimit(frequencyLimit)
+{
+    boost::system::error_code error;
+    mEndpoint = tcp::endpoint(boost::asio::ip::make_address(host, error), port);
+    if (error)
+    {
+        throw ReadyTraderGoError("invalid execution host '" + host + "': " + error.message());
+    }
+}
+
+void ExecutionServer::Start()
+{
+    RLOG(LG_EXEC, LogLevel::LL_INFO) << "starting execution server: host=" << mEndpoint.address()
+                                     << " port=" << mEndpoint.port();
+
+    boost::system::error_code error;
+    mAcceptor.open(mEndpoint.protocol(), error);
+    if (!error)
+    {
+        mAcceptor.set_option(tcp::acceptor::reuse_address(true), error);
+    }
+    if (!error)
+    {
+        mAcceptor.bind(mEndpoint, error);
+    }
+    if (!error)
+    {
+        mAcceptor.listen(tcp::acceptor::max_listen_connections, error);
+    }
+    if (error)
+    {
+        RLOG(LG_EXEC, LogLevel::LL_ERROR) << "failed to start execution server: " << error.message();
+        throw ReadyTraderGoError("failed to start execution server: " + error.message());
+    }
+
+    AsyncAccept();
+}
+
+void ExecutionServer::Close()
+{
+    boost::system::error_code error;
+    mAcceptor.close(error);
+}
+
+void ExecutionServer::AsyncAccept()
+{
+    mAcceptor.async_accept([this](const boost::system::error_code& error, tcp::socket socket) {
+        AcceptHandler(error, std::move(socket));
+    });
+}
+
+void ExecutionServer::AcceptHandler(const boost::system::error_code& error, tcp::socket socket)
+{
+    if (error)
+    {
+        if (error != boost::asio::error::operation_aborted)
+        {
+            RLOG(LG_EXEC, LogLevel::LL_ERROR) << "accept failed: " << error.message();
+        }
+        return;
+    }
+
+    boost::system::error_code ignored;
+    RLOG(LG_EXEC, LogLevel::LL_INFO) << "accepted connection from " << socket.remote_endpoint(ignored);
+    socket.non_blocking(true, ignored);
+    socket.set_option(tcp::no_delay(true), ignored);
+
+    auto connection = std::make_unique<Connection>(mContext, std::move(socket), mOptions);
+    connection->SetName("Exec" + std::to_string(mConnections.size()));
+    mConnections.push_back(std::make_unique<ExecutionConnection>(mContext,
+                                                                 std::move(connection),
+                                                                 mCompetitorManager,
+                                                                 FrequencyLimiter(mFrequencyLimitInterval,
+                                                                                  mFrequencyLimit),
+                                                                 *mController));
+    mConnections.back()->Start();
+
+    AsyncAccept();
+}
+
+}
@@ -0,0 +1,116 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_TOOLS_EXCHANGE_EXECUTION_H
+#define CPPREADY_TRADER_GO_TOOLS_EXCHANGE_EXECUTION_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <exchange/competitor.h>
+#include <exchange/frequencylimiter.h>
+#include <ready_trader_go/connectivity.h>
+
+#include "exchangetypes.h"
+
+namespace ReadyTraderGo {
+
+// The exchange's end of an auto-trader's execution connection. The first
+// message must be a login, after which requests are passed to the logged in
+// competitor. Every message counts towards the message frequency limit.
+class ExecutionConnection : public ICompetitorConnection
+{
+public:
+    ExecutionConnection(boost::asio::io_context& context,
+                        std::unique_ptr<IConnection>&& connection,
+                        CompetitorManager& competitorManager,
+                        FrequencyLimiter frequencyLimiter,
+                        IController& controller);
+
+    void Start();
+
+    // ICompetitorConnection
+    void Close() override;
+    void SendError(unsigned long clientOrderId, const std::string& message) override;
+    void SendHedgeFilled(unsigned long clientOrderId, unsigned long averagePrice, unsigned long volume) override;
+    void SendOrderFilled(unsigned long clientOrderId, unsigned long price, unsigned long volume) override;
+    void SendOrderStatus(unsigned long clientOrderId,
+                         unsigned long fillVolume,
+                         unsigned long remainingVolume,
+                         long fees) override;
+
+private:
+    void ConnectionLost();
+    void LoginHandler(const std::string& name, const std::string& secret);
+    void MessageHandler(unsigned char messageType, unsigned char const* data, std::size_t size);
+
+    boost::asio::io_context& mContext;
+    std::unique_ptr<IConnection> mConnection;
+    CompetitorManager& mCompetitorManager;
+    FrequencyLimiter mFrequencyLimiter;
+    IController& mController;
+    Competitor* mCompetitor = nullptr;
+    bool mIsClosing = false;
+    bool mIsLost = false;
+};
+
+// Accepts execution connections from auto-traders.
+class ExecutionServer
+{
+public:
+    ExecutionServer(boost::asio::io_context& context,
+                    const std::string& host,
+                    unsigned short port,
+                    const ConnectionOptions& options,
+                    CompetitorManager& competitorManager,
+                    double frequencyLimitInterval,
+                    unsigned long frequencyLimit);
+
+    void SetController(IController* controller) { mController = controller; }
+
+    void Start();
+
+    // Stop accepting connections without affecting existing ones.
+    void Close();
+
+private:
+    void AsyncAccept();
+    void AcceptHandler(const boost::system::error_code& error, tcp::socket socket);
+
+    boost::asio::io_context& mContext;
+    tcp::acceptor mAcceptor;
+    tcp::endpoint mEndpoint;
+    ConnectionOptions mOptions;
+    CompetitorManager& mCompetitorManager;
+    double mFrequencyLimitInterval;
+    unsigned long mFrequencyLimit;
+    IController* mController = nullptr;
+
+    // Connections are kept until the server is destroyed as asynchronous
+    // operations may still refer to them after they are closed.
+    std::vector<std::unique_ptr<ExecutionConnection>> mConnections;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_TOOLS_EXCHANGE_EXECUTION_H
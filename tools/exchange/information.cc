@@ -0,0 +1,77 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <utility>
+
+#include <boost/asio/post.hpp>
+
+#include <ready_trader_go/protocol.h>
+
+#include "information.h"
+
+namespace ReadyTraderGo {
+
+InformationPublisher::InformationPublisher(boost::asio::io_context& context,
+                                           std::unique_ptr<Publisher>&& publisher,
+                                           OrderBook& futureBook,
+                                           OrderBook& etfBook)
+    : mContext(context), mPublisher(std::move(publisher)), mOrderBooks{&futureBook, &etfBook}
+{
+    for (OrderBook* book : mOrderBooks)
+    {
+        book->TradeOccurred = [this](OrderBook& b) { TradeOccurred(b); };
+    }
+}
+
+void InformationPublisher::TimerTicked(double now, unsigned long tickNumber)
+{
+    OrderBookMessage message;
+    message.mSequenceNumber = tickNumber;
+    for (OrderBook* book : mOrderBooks)
+    {
+        message.mInstrument = book->GetInstrument();
+        book->TopLevels(message.mAskPrices, message.mAskVolumes, message.mBidPrices, message.mBidVolumes);
+        mPublisher->Publish(MessageType::ORDER_BOOK_UPDATE, message);
+    }
+}
+
+void InformationPublisher::TradeOccurred(OrderBook& book)
+{
+    // Every trade from the current event goes into one trade ticks message.
+    const auto instrument = static_cast<std::size_t>(book.GetInstrument());
+    if (!mIsTradeTicksPosted[instrument])
+    {
+        mIsTradeTicksPosted[instrument] = true;
+        boost::asio::post(mContext, [this, &book] { SendTradeTicks(book); });
+    }
+}
+
+void InformationPublisher::SendTradeTicks(OrderBook& book)
+{
+    const auto instrument = static_cast<std::size_t>(book.GetInstrument());
+    mIsTradeTicksPosted[instrument] = false;
+
+    TradeTicksMessage message;
+    if (book.TradeTicks(message.mAskPrices, message.mAskVolumes, message.mBidPrices, message.mBidVolumes))
+    {
+        message.mInstrument = book.GetInstrument();
+        message.mSequenceNumber = ++mTradeTicksSequenceNumbers[instrument];
+        mPublisher->Publish(MessageType::TRADE_TICKS, message);
+    }
+}
+
+}
@@ -0,0 +1,56 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_TOOLS_EXCHANGE_INFORMATION_H
+#define CPPREADY_TRADER_GO_TOOLS_EXCHANGE_INFORMATION_H
+
+#include <array>
+#include <memory>
+
+#include <boost/asio/io_context.hpp>
+
+#include <matching_engine/orderbook.h>
+#include <ready_trader_go/publisher.h>
+
+namespace ReadyTraderGo {
+
+// Publishes order book updates on every tick and trade ticks soon after
+// trades, numbered the same way as by the Python exchange.
+class InformationPublisher
+{
+public:
+    InformationPublisher(boost::asio::io_context& context,
+                         std::unique_ptr<Publisher>&& publisher,
+                         OrderBook& futureBook,
+                         OrderBook& etfBook);
+
+    void TimerTicked(double now, unsigned long tickNumber);
+
+private:
+    void SendTradeTicks(OrderBook& book);
+    void TradeOccurred(OrderBook& book);
+
+    boost::asio::io_context& mContext;
+    std::unique_ptr<Publisher> mPublisher;
+    std::array<OrderBook*, 2> mOrderBooks;
+    std::array<bool, 2> mIsTradeTicksPosted = {};
+    std::array<unsigned long, 2> mTradeTicksSequenceNumbers = {1, 1};
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_TOOLS_EXCHANGE_INFORMATION_H
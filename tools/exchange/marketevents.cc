@@ -0,0 +1,64 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <utility>
+
+#include <ready_trader_go/error.h>
+#include <ready_trader_go/logging.h>
+
+#include "marketevents.h"
+
+RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_ME, "MARKET_EVENTS")
+
+namespace ReadyTraderGo {
+
+MarketEventsReader::MarketEventsReader(std::string filename, OrderBook& futureBook, OrderBook& etfBook)
+    : mFilename(std::move(filename)), mReplay(futureBook, etfBook)
+{
+}
+
+void MarketEventsReader::Start()
+{
+    try
+    {
+        mEvents = readMarketEvents(mFilename);
+    }
+    catch (const ReadyTraderGoError& e)
+    {
+        RLOG(LG_ME, LogLevel::LL_ERROR) << e.what();
+        throw;
+    }
+
+    RLOG(LG_ME, LogLevel::LL_INFO) << "read " << mEvents.size() << " market events from '" << mFilename << '\'';
+}
+
+void MarketEventsReader::ProcessMarketEvents(double elapsedTime)
+{
+    while (mNextEvent < mEvents.size() && mEvents[mNextEvent].mTime < elapsedTime)
+    {
+        mReplay.Apply(mEvents[mNextEvent++]);
+    }
+
+    if (mNextEvent == mEvents.size() && !mIsComplete)
+    {
+        mIsComplete = true;
+        RLOG(LG_ME, LogLevel::LL_INFO) << "processed all " << mEvents.size() << " market events";
+        OnCompleted();
+    }
+}
+
+}
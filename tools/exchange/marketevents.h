@@ -0,0 +1,69 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_TOOLS_EXCHANGE_MARKETEVENTS_H
+#define CPPREADY_TRADER_GO_TOOLS_EXCHANGE_MARKETEVENTS_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <market_data/marketevents.h>
+#include <matching_engine/marketreplay.h>
+#include <matching_engine/orderbook.h>
+#include <ready_trader_go/types.h>
+
+namespace ReadyTraderGo {
+
+// Replays the market data file (the same CSV format as read by the Python
+// exchange) into the order books.
+class MarketEventsReader
+{
+public:
+    MarketEventsReader(std::string filename, OrderBook& futureBook, OrderBook& etfBook);
+
+    // Read the whole of the market data file.
+    void Start();
+
+    // Apply all the events that are due before the given time.
+    void ProcessMarketEvents(double elapsedTime);
+
+    // Called once every market event has been applied.
+    std::function<void()> Completed;
+
+private:
+    void OnCompleted();
+
+    std::string mFilename;
+    MarketReplay mReplay;
+    std::vector<MarketEvent> mEvents;
+    std::size_t mNextEvent = 0;
+    bool mIsComplete = false;
+};
+
+inline void MarketEventsReader::OnCompleted()
+{
+    if (Completed)
+    {
+        Completed();
+    }
+}
+
+}
+
+#endif //CPPREADY_TRADER_GO_TOOLS_EXCHANGE_MARKETEVENTS_H
@@ -0,0 +1,223 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+
+#include <ready_trader_go/error.h>
+#include <ready_trader_go/logging.h>
+
+using namespace ReadyTraderGo;
+
+// Renders a binary log (written by an application whose configuration has
+// "Logging": {"Format": "binary"}) as the text log would have been written.
+
+namespace {
+
+struct Site
+{
+    std::string mChannel;
+    std::string mFile;
+    unsigned int mLine;
+};
+
+class LogDecoder
+{
+public:
+    LogDecoder(std::istream& stream, LogLevel level) : mStream(stream), mLevel(level) {}
+
+    // Write every record at or above the level to the given stream.
+    void Decode(std::ostream& output);
+
+private:
+    template<typename T>
+    T Read()
+    {
+        T value;
+        ReadBytes(reinterpret_cast<char*>(&value), sizeof(value));
+        return value;
+    }
+
+    void ReadBytes(char* data, std::size_t size);
+    void ReadMagic();
+    void ReadRecord(std::ostream& output);
+    void ReadSite();
+
+    std::istream& mStream;
+    LogLevel mLevel;
+    std::unordered_map<std::uint64_t, Site> mSites;
+};
+
+void LogDecoder::Decode(std::ostream& output)
+{
+    ReadMagic();
+
+    for (int tag = mStream.get(); tag != std::char_traits<char>::eof(); tag = mStream.get())
+    {
+        if (tag == static_cast<unsigned char>(BINARY_LOG_MAGIC[0]))
+        {
+            // Another run appended to the log, so its sites are new.
+            mStream.unget();
+            ReadMagic();
+            mSites.clear();
+        }
+        else if (tag == static_cast<unsigned char>(BinaryLogEntry::SITE))
+        {
+            ReadSite();
+        }
+        else if (tag == static_cast<unsigned char>(BinaryLogEntry::RECORD))
+        {
+            ReadRecord(output);
+        }
+        else
+        {
+            throw ReadyTraderGoError("unexpected entry at offset " + std::to_string(mStream.tellg() - 1l));
+        }
+    }
+}
+
+void LogDecoder::ReadBytes(char* data, std::size_t size)
+{
+    if (!mStream.read(data, static_cast<std::streamsize>(size)))
+    {
+        throw ReadyTraderGoError("log ends with a truncated entry");
+    }
+}
+
+void LogDecoder::ReadMagic()
+{
+    char magic[sizeof(BINARY_LOG_MAGIC)];
+    if (!mStream.read(magic, sizeof(magic)) || std::memcmp(magic, BINARY_LOG_MAGIC, sizeof(magic)) != 0)
+    {
+        throw ReadyTraderGoError("not a binary log");
+    }
+}
+
+void LogDecoder::ReadRecord(std::ostream& output)
+{
+    LogRecordHeader header{};
+    unsigned char data[LOG_RECORD_DATA_SIZE];
+
+    header.mTime = Read<std::int64_t>();
+    auto siteId = Read<std::uint64_t>();
+    header.mLevel = Read<LogLevel>();
+    header.mFlags = Read<std::uint8_t>();
+    header.mSize = Read<std::uint16_t>();
+    if (header.mSize > LOG_RECORD_DATA_SIZE)
+    {
+        throw ReadyTraderGoError("record of " + std::to_string(header.mSize) + " bytes is too big");
+    }
+    ReadBytes(reinterpret_cast<char*>(data), header.mSize);
+
+    auto site = mSites.find(siteId);
+    if (site == mSites.end())
+    {
+        throw ReadyTraderGoError("record from an unknown site");
+    }
+
+    if (header.mLevel >= mLevel)
+    {
+        formatLogRecord(output, header, site->second.mChannel.c_str(), data);
+    }
+}
+
+void LogDecoder::ReadSite()
+{
+    Site site;
+    auto siteId = Read<std::uint64_t>();
+    site.mLine = Read<std::uint32_t>();
+    site.mChannel.resize(Read<unsigned char>());
+    ReadBytes(site.mChannel.data(), site.mChannel.size());
+    site.mFile.resize(Read<std::uint16_t>());
+    ReadBytes(site.mFile.data(), site.mFile.size());
+    mSites[siteId] = std::move(site);
+}
+
+bool parseLogLevel(const char* name, LogLevel& level)
+{
+    for (std::size_t i = 0; i < std::size(LOG_LEVEL_NAMES); ++i)
+    {
+        if (std::strcmp(name, LOG_LEVEL_NAMES[i]) == 0)
+        {
+            level = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+static int usage(const char* program)
+{
+    std::cerr << "usage: " << program << " [--level LEVEL] BINARY_LOG_FILE\n"
+                 "\n"
+                 "  --level LEVEL       only show records at or above LEVEL (DEBUG, INFO, WARNING, ERROR or FATAL)\n";
+    return 2;
+}
+
+int main(int argc, char* argv[])
+{
+    LogLevel level = LogLevel::LL_DEBUG;
+    const char* filename = nullptr;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+        {
+            if (!parseLogLevel(argv[++i], level))
+                return usage(argv[0]);
+        }
+        else if (argv[i][0] != '-' && !filename)
+            filename = argv[i];
+        else
+            return usage(argv[0]);
+    }
+    if (!filename)
+    {
+        return usage(argv[0]);
+    }
+
+    std::ifstream stream{filename, std::ios_base::binary};
+    if (!stream)
+    {
+        std::cerr << "failed to open '" << filename << "': " << std::strerror(errno) << '\n';
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        LogDecoder decoder{stream, level};
+        decoder.Decode(std::cout);
+    }
+    catch (const std::exception& e)
+    {
+        std::cout.flush();
+        std::cerr << filename << ": " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
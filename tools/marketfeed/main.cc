@@ -0,0 +1,121 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include <ready_trader_go/connectivity.h>
+
+#include "marketfeed.h"
+
+using namespace ReadyTraderGo;
+
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void signalHandler(int)
+{
+    stopRequested = 1;
+}
+
+static int usage(const char* program)
+{
+    std::cerr << "usage: " << program << " [options] MARKET_DATA_FILE\n"
+                 "\n"
+                 "  --type TYPE             information channel type, mmap or shm (default mmap)\n"
+                 "  --name NAME             information channel file or block name (default info.dat)\n"
+                 "  --start-delay SECONDS   wait before publishing so subscribers can open the channel\n"
+                 "                          (default 0)\n"
+                 "  --speed N               market seconds per second, 0 for as fast as possible (default 1)\n"
+                 "  --tick-interval SECONDS market seconds between order book updates, 0 to send one\n"
+                 "                          after every market event (default 0.25)\n"
+                 "  --frame-rate N          publish at most N frames per second, 0 for no limit (default 0)\n"
+                 "  --burst N               write frames in bursts of N, pacing between bursts (default 1)\n"
+                 "  --overrun               write bursts of two and a half times the ring size to overrun\n"
+                 "                          slow readers\n"
+                 "  --loops N               replay the file N times, 0 for until interrupted (default 1)\n"
+                 "  --maker-fee FEE         (default -0.0001)\n"
+                 "  --taker-fee FEE         (default 0.0002)\n";
+    return 2;
+}
+
+int main(int argc, char* argv[])
+{
+    MarketFeedOptions options;
+    const char* filename = nullptr;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--type") == 0 && hasValue)
+            options.mType = argv[++i];
+        else if (std::strcmp(argv[i], "--name") == 0 && hasValue)
+            options.mName = argv[++i];
+        else if (std::strcmp(argv[i], "--start-delay") == 0 && hasValue)
+            options.mStartDelay = std::strtod(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "--speed") == 0 && hasValue)
+            options.mSpeed = std::strtod(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "--tick-interval") == 0 && hasValue)
+            options.mTickInterval = std::strtod(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "--frame-rate") == 0 && hasValue)
+            options.mFrameRate = std::strtod(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "--burst") == 0 && hasValue)
+            options.mBurstSize = std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--overrun") == 0)
+            // Not a whole number of laps, otherwise every burst would end with
+            // the same empty frame and a lapped reader parked on it would
+            // never see anything again.
+            options.mBurstSize = 5 * SUBSCRIPTION_TRANSPORT_FRAME_COUNT / 2;
+        else if (std::strcmp(argv[i], "--loops") == 0 && hasValue)
+            options.mLoopCount = std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--maker-fee") == 0 && hasValue)
+            options.mMakerFee = std::strtod(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "--taker-fee") == 0 && hasValue)
+            options.mTakerFee = std::strtod(argv[++i], nullptr);
+        else if (argv[i][0] != '-' && !filename)
+            filename = argv[i];
+        else
+            return usage(argv[0]);
+    }
+    if (!filename || (options.mType != "mmap" && options.mType != "shm"))
+    {
+        return usage(argv[0]);
+    }
+
+    std::signal(SIGINT, signalHandler);
+    std::signal(SIGTERM, signalHandler);
+
+    try
+    {
+        const auto events = readMarketEvents(filename);
+        MarketFeed feed{options, events};
+
+        feed.Run(stopRequested);
+        std::cerr << "published " << feed.GetFrameCount() << " frames ("
+                  << feed.GetFrameCount() / SUBSCRIPTION_TRANSPORT_FRAME_COUNT << " laps of the ring)\n";
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "marketfeed: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,155 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <iostream>
+#include <thread>
+
+#include <matching_engine/marketreplay.h>
+#include <ready_trader_go/protocol.h>
+
+#include "marketfeed.h"
+
+namespace ReadyTraderGo {
+
+// Sleeping is only accurate to tens of microseconds, so the last part of
+// any wait is spent spinning (yielding, so as not to starve subscribers
+// sharing the CPU).
+constexpr std::chrono::microseconds SPIN_THRESHOLD{100};
+
+MarketFeed::MarketFeed(const MarketFeedOptions& options, const std::vector<MarketEvent>& events)
+    : mOptions(options), mEvents(events), mPublisher(options.mType, options.mName)
+{
+    if (mOptions.mBurstSize == 0)
+    {
+        mOptions.mBurstSize = 1;
+    }
+}
+
+void MarketFeed::Run(const volatile std::sig_atomic_t& stop)
+{
+    std::this_thread::sleep_for(std::chrono::duration<double>(mOptions.mStartDelay));
+
+    mStartTime = Clock::now();
+    for (unsigned long loop = 1; !stop && (mOptions.mLoopCount == 0 || loop <= mOptions.mLoopCount); ++loop)
+    {
+        const unsigned long frameCount = mFrameCount;
+        mLoopStartTime = Clock::now();
+        Play(stop);
+        const std::chrono::duration<double> elapsed = Clock::now() - mLoopStartTime;
+        std::cerr << "loop " << loop << ": published " << (mFrameCount - frameCount) << " frames in "
+                  << elapsed.count() << " seconds (" << static_cast<unsigned long>((mFrameCount - frameCount)
+                                                                                   / elapsed.count())
+                  << " frames per second)\n";
+    }
+}
+
+void MarketFeed::Play(const volatile std::sig_atomic_t& stop)
+{
+    OrderBook futureBook{Instrument::FUTURE, mOptions.mMakerFee, mOptions.mTakerFee};
+    OrderBook etfBook{Instrument::ETF, mOptions.mMakerFee, mOptions.mTakerFee};
+    MarketReplay replay{futureBook, etfBook};
+
+    const double tickInterval = mOptions.mTickInterval;
+    double nextTick = tickInterval;
+
+    for (auto event = mEvents.begin(); event != mEvents.end() && !stop; ++event)
+    {
+        while (tickInterval > 0.0 && nextTick <= event->mTime)
+        {
+            WaitForMarketTime(nextTick);
+            PublishOrderBook(futureBook);
+            PublishOrderBook(etfBook);
+            nextTick += tickInterval;
+        }
+
+        WaitForMarketTime(event->mTime);
+        OrderBook& book = replay.Apply(*event);
+        if (tickInterval <= 0.0)
+        {
+            PublishOrderBook(book);
+        }
+        PublishTradeTicks(book);
+    }
+
+    if (!stop)
+    {
+        PublishOrderBook(futureBook);
+        PublishOrderBook(etfBook);
+    }
+}
+
+void MarketFeed::Publish(unsigned char messageType, const ISerialisable& message)
+{
+    // Pacing is applied at the start of each burst, keeping to a schedule
+    // so that time lost to one burst is made up by the next.
+    if (mOptions.mFrameRate > 0.0 && mFrameCount % mOptions.mBurstSize == 0)
+    {
+        WaitUntil(mStartTime + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(mFrameCount / mOptions.mFrameRate)));
+    }
+
+    mPublisher.Publish(messageType, message);
+    ++mFrameCount;
+}
+
+void MarketFeed::PublishOrderBook(OrderBook& book)
+{
+    const auto instrument = static_cast<std::size_t>(book.GetInstrument());
+
+    OrderBookMessage message;
+    message.mInstrument = book.GetInstrument();
+    message.mSequenceNumber = ++mOrderBookSequenceNumbers[instrument];
+    book.TopLevels(message.mAskPrices, message.mAskVolumes, message.mBidPrices, message.mBidVolumes);
+    Publish(MessageType::ORDER_BOOK_UPDATE, message);
+}
+
+void MarketFeed::PublishTradeTicks(OrderBook& book)
+{
+    const auto instrument = static_cast<std::size_t>(book.GetInstrument());
+
+    TradeTicksMessage message;
+    if (book.TradeTicks(message.mAskPrices, message.mAskVolumes, message.mBidPrices, message.mBidVolumes))
+    {
+        message.mInstrument = book.GetInstrument();
+        message.mSequenceNumber = ++mTradeTicksSequenceNumbers[instrument];
+        Publish(MessageType::TRADE_TICKS, message);
+    }
+}
+
+void MarketFeed::WaitForMarketTime(double marketTime)
+{
+    if (mOptions.mSpeed > 0.0 && mFrameCount % mOptions.mBurstSize == 0)
+    {
+        WaitUntil(mLoopStartTime + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(marketTime / mOptions.mSpeed)));
+    }
+}
+
+void MarketFeed::WaitUntil(Clock::time_point time)
+{
+    Clock::time_point now = Clock::now();
+    if (time - now > SPIN_THRESHOLD)
+    {
+        std::this_thread::sleep_until(time - SPIN_THRESHOLD);
+    }
+    while (Clock::now() < time)
+    {
+        std::this_thread::yield();
+    }
+}
+
+}
@@ -0,0 +1,99 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_TOOLS_MARKETFEED_MARKETFEED_H
+#define CPPREADY_TRADER_GO_TOOLS_MARKETFEED_MARKETFEED_H
+
+#include <array>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <market_data/marketevents.h>
+#include <matching_engine/orderbook.h>
+#include <ready_trader_go/connectivitytypes.h>
+#include <ready_trader_go/publisher.h>
+
+namespace ReadyTraderGo {
+
+struct MarketFeedOptions
+{
+    std::string mType = "mmap";
+    std::string mName = "info.dat";
+    double mMakerFee = -0.0001;
+    double mTakerFee = 0.0002;
+
+    // Seconds to wait after creating the information channel before
+    // publishing, to give subscribers time to open it.
+    double mStartDelay = 0.0;
+    // Market seconds per real second, or zero for no pacing.
+    double mSpeed = 1.0;
+    // Market seconds between order book updates, or zero to send an update
+    // after every market event.
+    double mTickInterval = 0.25;
+    // The most frames to publish per second, or zero for no limit.
+    double mFrameRate = 0.0;
+    // Frames are written back-to-back in bursts of this many, with pacing
+    // only applied between bursts.
+    std::size_t mBurstSize = 1;
+    // Times to replay the market data, or zero to replay it until stopped.
+    unsigned long mLoopCount = 1;
+};
+
+// Replays market events into a pair of order books and publishes their
+// order book updates and trade ticks to an information channel, the same
+// way the exchange does but at whatever rate is asked for.
+//
+// Bursts longer than the ring (SUBSCRIPTION_TRANSPORT_FRAME_COUNT frames)
+// lap it before a subscriber has a chance to run, deliberately overrunning
+// any subscriber that is not already waiting on the next frame.
+class MarketFeed
+{
+public:
+    MarketFeed(const MarketFeedOptions& options, const std::vector<MarketEvent>& events);
+
+    // Publish the market events until done or until stop becomes non-zero.
+    void Run(const volatile std::sig_atomic_t& stop);
+
+    unsigned long GetFrameCount() const { return mFrameCount; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void Play(const volatile std::sig_atomic_t& stop);
+    void Publish(unsigned char messageType, const ISerialisable& message);
+    void PublishOrderBook(OrderBook& book);
+    void PublishTradeTicks(OrderBook& book);
+    void WaitForMarketTime(double marketTime);
+    void WaitUntil(Clock::time_point time);
+
+    MarketFeedOptions mOptions;
+    const std::vector<MarketEvent>& mEvents;
+    Publisher mPublisher;
+
+    Clock::time_point mStartTime;
+    Clock::time_point mLoopStartTime;
+    unsigned long mFrameCount = 0;
+    std::array<unsigned long, 2> mOrderBookSequenceNumbers = {};
+    std::array<unsigned long, 2> mTradeTicksSequenceNumbers = {};
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_TOOLS_MARKETFEED_MARKETFEED_H
@@ -0,0 +1,168 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <market_data/marketdatafile.h>
+#include <market_data/marketevents.h>
+
+using namespace ReadyTraderGo;
+
+// Convert a CSV market data file to a binary market data file and optionally
+// check that the binary file reads back exactly as the CSV one does.
+
+static bool sameEvent(const MarketEvent& a, const MarketEvent& b)
+{
+    return a.mTime == b.mTime && a.mInstrument == b.mInstrument && a.mOperation == b.mOperation
+           && a.mOrderId == b.mOrderId && a.mSide == b.mSide && a.mVolume == b.mVolume && a.mPrice == b.mPrice
+           && a.mLifespan == b.mLifespan;
+}
+
+static unsigned long verify(const std::vector<MarketEvent>& expected, const std::string& filename)
+{
+    unsigned long failures = 0;
+    auto fail = [&failures](const std::string& what) {
+        if (++failures <= 10)
+            std::cerr << "mismatch: " << what << '\n';
+    };
+
+    const MarketDataFile file{filename};
+    if (file.GetEventCount() != expected.size())
+    {
+        fail("event count " + std::to_string(file.GetEventCount()) + " != " + std::to_string(expected.size()));
+        return failures;
+    }
+    for (std::size_t i = 0; i != expected.size(); ++i)
+    {
+        if (!sameEvent(file.GetEvent(i), expected[i]))
+            fail("event " + std::to_string(i));
+    }
+
+    // The time index must agree with a plain binary search, at every event
+    // time, between event times and on and around index boundaries.
+    std::vector<double> probes{-1.0, 0.0};
+    for (const auto& event : expected)
+    {
+        probes.push_back(event.mTime);
+        probes.push_back(event.mTime + 1e-6);
+    }
+    const double end = expected.empty() ? 0.0 : expected.back().mTime;
+    for (double t = 0.0; t <= end + 2 * file.GetIndexInterval(); t += file.GetIndexInterval())
+    {
+        probes.push_back(t);
+        probes.push_back(t - 1e-9);
+    }
+    for (double t : probes)
+    {
+        const auto it = std::lower_bound(expected.begin(), expected.end(), t,
+                                         [](const MarketEvent& e, double time) { return e.mTime < time; });
+        const std::size_t position = file.FindTime(t);
+        if (position != static_cast<std::size_t>(it - expected.begin()))
+            fail("FindTime(" + std::to_string(t) + ") returned " + std::to_string(position));
+    }
+
+    if (failures == 0)
+    {
+        const auto events = readMarketEvents(filename);
+        if (!std::equal(events.begin(), events.end(), expected.begin(), expected.end(), sameEvent))
+            fail("readMarketEvents");
+    }
+
+    return failures;
+}
+
+static int usage(const char* program)
+{
+    std::cerr << "usage: " << program << " [--index-interval SECONDS] [--verify] CSV_FILE BINARY_FILE\n";
+    return 2;
+}
+
+int main(int argc, char* argv[])
+{
+    double indexInterval = 1.0;
+    bool verifyOutput = false;
+    std::vector<const char*> filenames;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--verify") == 0)
+            verifyOutput = true;
+        else if (std::strcmp(argv[i], "--index-interval") == 0 && i + 1 < argc)
+            indexInterval = std::strtod(argv[++i], nullptr);
+        else if (argv[i][0] != '-' && filenames.size() < 2)
+            filenames.push_back(argv[i]);
+        else
+            return usage(argv[0]);
+    }
+    if (filenames.size() != 2)
+    {
+        return usage(argv[0]);
+    }
+
+    try
+    {
+        using seconds = std::chrono::duration<double>;
+
+        auto start = std::chrono::steady_clock::now();
+        const auto events = readMarketEvents(filenames[0]);
+        const seconds parseTime = std::chrono::steady_clock::now() - start;
+
+        MarketDataFile::Write(filenames[1], events, indexInterval);
+
+        // Time opening the binary file and touching every column.
+        start = std::chrono::steady_clock::now();
+        const MarketDataFile file{filenames[1]};
+        unsigned long checksum = 0;
+        for (std::size_t i = 0; i != file.GetEventCount(); ++i)
+        {
+            checksum += static_cast<unsigned long>(file.GetTimes()[i]) + static_cast<int>(file.GetInstruments()[i])
+                        + static_cast<int>(file.GetOperations()[i]) + file.GetOrderIds()[i]
+                        + static_cast<int>(file.GetSides()[i]) + file.GetVolumes()[i] + file.GetPrices()[i]
+                        + static_cast<int>(file.GetLifespans()[i]);
+        }
+        const seconds loadTime = std::chrono::steady_clock::now() - start;
+
+        std::cerr << "converted " << events.size() << " market events: parsing the CSV file took "
+                  << parseTime.count() * 1e3 << " ms, loading the binary file took " << loadTime.count() * 1e3
+                  << " ms (checksum " << checksum << ")\n";
+
+        if (verifyOutput)
+        {
+            const unsigned long failures = verify(events, filenames[1]);
+            if (failures != 0)
+            {
+                std::cerr << "verification failed with " << failures << " mismatches\n";
+                return 1;
+            }
+            std::cerr << "verified " << events.size() << " market events\n";
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "mdconvert: " << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,347 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <boost/endian/conversion.hpp>
+
+#include <ready_trader_go/protocol.h>
+#include <ready_trader_go/toplevels.h>
+
+using namespace ReadyTraderGo;
+
+// Compares the Serialise and Deserialise generated from the message schemas
+// with hand-written equivalents (the code protocol.cc used to hold, with
+// memcpy in place of its unaligned pointer casts, which compiles to the same
+// loads and stores on x86). Each pair must produce the same bytes and the
+// same messages, and the timings are reported per message. The top levels
+// byte swap kernels are also compared with each other.
+
+constexpr std::size_t MESSAGE_COUNT = 1024;
+
+static std::uint32_t load(unsigned char const* data)
+{
+    std::uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return boost::endian::big_to_native(value);
+}
+
+static void store(unsigned char* buf, std::uint32_t value)
+{
+    value = boost::endian::native_to_big(value);
+    std::memcpy(buf, &value, sizeof(value));
+}
+
+static void handDeserialise(InsertMessage& m, unsigned char const* data)
+{
+    m.mClientOrderId = load(data);
+    data += MessageFieldSize::LONG;
+    m.mSide = Side(*data);
+    data += MessageFieldSize::BYTE;
+    m.mPrice = load(data);
+    data += MessageFieldSize::LONG;
+    m.mVolume = load(data);
+    data += MessageFieldSize::LONG;
+    m.mLifespan = Lifespan(*data);
+}
+
+static void handSerialise(const InsertMessage& m, unsigned char* buf)
+{
+    store(buf, m.mClientOrderId);
+    buf += MessageFieldSize::LONG;
+    *buf = static_cast<unsigned char>(m.mSide);
+    buf += MessageFieldSize::BYTE;
+    store(buf, m.mPrice);
+    buf += MessageFieldSize::LONG;
+    store(buf, m.mVolume);
+    buf += MessageFieldSize::LONG;
+    *buf = static_cast<unsigned char>(m.mLifespan);
+}
+
+static void handDeserialise(OrderStatusMessage& m, unsigned char const* data)
+{
+    m.mClientOrderId = load(data);
+    data += MessageFieldSize::LONG;
+    m.mFillVolume = load(data);
+    data += MessageFieldSize::LONG;
+    m.mRemainingVolume = load(data);
+    data += MessageFieldSize::LONG;
+    m.mFees = static_cast<std::int32_t>(load(data));
+}
+
+static void handSerialise(const OrderStatusMessage& m, unsigned char* buf)
+{
+    store(buf, m.mClientOrderId);
+    buf += MessageFieldSize::LONG;
+    store(buf, m.mFillVolume);
+    buf += MessageFieldSize::LONG;
+    store(buf, m.mRemainingVolume);
+    buf += MessageFieldSize::LONG;
+    store(buf, static_cast<std::uint32_t>(m.mFees));
+}
+
+static void handDeserialise(OrderBookMessage& m, unsigned char const* data)
+{
+    m.mInstrument = Instrument(*data);
+    data += MessageFieldSize::BYTE;
+    m.mSequenceNumber = load(data);
+    data += MessageFieldSize::LONG;
+    for (auto* levels : {&m.mAskPrices, &m.mAskVolumes, &m.mBidPrices, &m.mBidVolumes})
+    {
+        for (auto& value : *levels)
+        {
+            value = load(data);
+            data += MessageFieldSize::LONG;
+        }
+    }
+}
+
+static void handSerialise(const OrderBookMessage& m, unsigned char* buf)
+{
+    *buf = static_cast<unsigned char>(m.mInstrument);
+    buf += MessageFieldSize::BYTE;
+    store(buf, m.mSequenceNumber);
+    buf += MessageFieldSize::LONG;
+    for (auto* levels : {&m.mAskPrices, &m.mAskVolumes, &m.mBidPrices, &m.mBidVolumes})
+    {
+        for (auto value : *levels)
+        {
+            store(buf, value);
+            buf += MessageFieldSize::LONG;
+        }
+    }
+}
+
+static bool equal(const InsertMessage& a, const InsertMessage& b)
+{
+    return a.mClientOrderId == b.mClientOrderId && a.mSide == b.mSide && a.mPrice == b.mPrice
+           && a.mVolume == b.mVolume && a.mLifespan == b.mLifespan;
+}
+
+static bool equal(const OrderStatusMessage& a, const OrderStatusMessage& b)
+{
+    return a.mClientOrderId == b.mClientOrderId && a.mFillVolume == b.mFillVolume
+           && a.mRemainingVolume == b.mRemainingVolume && a.mFees == b.mFees;
+}
+
+static bool equal(const OrderBookMessage& a, const OrderBookMessage& b)
+{
+    return a.mInstrument == b.mInstrument && a.mSequenceNumber == b.mSequenceNumber
+           && a.mAskPrices == b.mAskPrices && a.mAskVolumes == b.mAskVolumes
+           && a.mBidPrices == b.mBidPrices && a.mBidVolumes == b.mBidVolumes;
+}
+
+static void randomise(InsertMessage& m, std::mt19937& generator)
+{
+    m = InsertMessage{generator(), Side(generator() & 1), generator() % 1000000, generator() % 1000,
+                      Lifespan(generator() & 1)};
+}
+
+static void randomise(OrderStatusMessage& m, std::mt19937& generator)
+{
+    m = OrderStatusMessage{generator(), generator() % 1000, generator() % 1000,
+                           static_cast<signed long>(generator() % 2000) - 1000};
+}
+
+static void randomise(OrderBookMessage& m, std::mt19937& generator)
+{
+    m.mInstrument = Instrument(generator() & 1);
+    m.mSequenceNumber = generator();
+    for (auto* levels : {&m.mAskPrices, &m.mAskVolumes, &m.mBidPrices, &m.mBidVolumes})
+    {
+        for (auto& value : *levels)
+        {
+            value = generator();
+        }
+    }
+}
+
+template<typename F>
+static double bestNanoseconds(unsigned long count, unsigned long repeats, F&& f)
+{
+    double best = std::numeric_limits<double>::max();
+    for (unsigned long r = 0; r != repeats; ++r)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned long i = 0; i != count; ++i)
+        {
+            f(i % MESSAGE_COUNT);
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count() / static_cast<double>(count));
+    }
+    return best;
+}
+
+// Check and time one message type. The buffers are laid out one byte apart
+// from a multiple of the message size so that most fields are unaligned.
+template<typename T>
+static bool bench(const char* name, unsigned long count, unsigned long repeats)
+{
+    std::mt19937 generator{42};
+    std::vector<T> messages(MESSAGE_COUNT);
+    std::vector<T> decoded(MESSAGE_COUNT);
+    const std::size_t stride = T::Schema::SIZE + 1;
+    std::vector<unsigned char> hand(MESSAGE_COUNT * stride);
+    std::vector<unsigned char> generated(MESSAGE_COUNT * stride);
+
+    for (std::size_t i = 0; i != MESSAGE_COUNT; ++i)
+    {
+        randomise(messages[i], generator);
+        handSerialise(messages[i], hand.data() + i * stride);
+        messages[i].Serialise(generated.data() + i * stride);
+        decoded[i].Deserialise(hand.data() + i * stride, T::Schema::SIZE);
+        if (std::memcmp(hand.data() + i * stride, generated.data() + i * stride, T::Schema::SIZE) != 0
+            || !equal(messages[i], decoded[i]))
+        {
+            std::cerr << "protocolbench: " << name << " generated code differs from hand-written code\n";
+            return false;
+        }
+    }
+
+    // Call through the concrete type so both versions can be inlined.
+    const double handEncode = bestNanoseconds(count, repeats, [&](std::size_t i) {
+        handSerialise(messages[i], hand.data() + i * stride);
+    });
+    const double generatedEncode = bestNanoseconds(count, repeats, [&](std::size_t i) {
+        T::Schema::Write(messages[i], generated.data() + i * stride);
+    });
+    const double handDecode = bestNanoseconds(count, repeats, [&](std::size_t i) {
+        handDeserialise(decoded[i], hand.data() + i * stride);
+    });
+    const double generatedDecode = bestNanoseconds(count, repeats, [&](std::size_t i) {
+        T::Schema::Read(decoded[i], generated.data() + i * stride);
+    });
+
+    std::cout << name << ": encode hand-written=" << handEncode << "ns generated=" << generatedEncode
+              << "ns, decode hand-written=" << handDecode << "ns generated=" << generatedDecode << "ns\n";
+    return true;
+}
+
+// Check each top levels byte swap kernel the processor supports against the
+// scalar one and time decode and encode of whole level blocks with each.
+static bool benchKernels(unsigned long count, unsigned long repeats)
+{
+    std::mt19937 generator{42};
+    const std::size_t stride = TOP_LEVELS_SIZE + 1;
+    std::vector<unsigned char> wire(MESSAGE_COUNT * stride);
+    std::generate(wire.begin(), wire.end(), [&generator] { return static_cast<unsigned char>(generator()); });
+
+    std::vector<TopLevels> expected(MESSAGE_COUNT);
+    std::vector<TopLevels> decoded(MESSAGE_COUNT);
+    std::vector<unsigned char> encoded(wire.size());
+    const ByteSwapKernel original = getByteSwapKernel();
+
+    setByteSwapKernel(ByteSwapKernel::SCALAR);
+    for (std::size_t i = 0; i != MESSAGE_COUNT; ++i)
+    {
+        decodeTopLevels(wire.data() + i * stride, expected[i]);
+    }
+
+    bool ok = true;
+    for (auto kernel : {ByteSwapKernel::SCALAR, ByteSwapKernel::SSSE3, ByteSwapKernel::AVX2})
+    {
+        if (!setByteSwapKernel(kernel))
+        {
+            std::cout << "top levels " << toString(kernel) << ": not supported\n";
+            continue;
+        }
+
+        for (std::size_t i = 0; i != MESSAGE_COUNT; ++i)
+        {
+            decodeTopLevels(wire.data() + i * stride, decoded[i]);
+            encodeTopLevels(decoded[i], encoded.data() + i * stride);
+            OrderBookMessage wide;
+            decodeTopLevels(wire.data() + i * stride, wide.mAskPrices, wide.mAskVolumes, wide.mBidPrices,
+                            wide.mBidVolumes);
+            unsigned char narrowed[TOP_LEVELS_SIZE];
+            encodeTopLevels(wide.mAskPrices, wide.mAskVolumes, wide.mBidPrices, wide.mBidVolumes, narrowed);
+            const bool wideMatches = std::equal(wide.mAskPrices.begin(), wide.mAskPrices.end(),
+                                                expected[i].mAskPrices.begin())
+                                     && std::equal(wide.mBidVolumes.begin(), wide.mBidVolumes.end(),
+                                                   expected[i].mBidVolumes.begin())
+                                     && std::memcmp(narrowed, wire.data() + i * stride, TOP_LEVELS_SIZE) == 0;
+            if (std::memcmp(&decoded[i], &expected[i], sizeof(TopLevels)) != 0
+                || std::memcmp(encoded.data() + i * stride, wire.data() + i * stride, TOP_LEVELS_SIZE) != 0
+                || !wideMatches)
+            {
+                std::cerr << "protocolbench: " << toString(kernel) << " kernel differs from the scalar kernel\n";
+                ok = false;
+                break;
+            }
+        }
+
+        const double decode = bestNanoseconds(count, repeats, [&](std::size_t i) {
+            decodeTopLevels(wire.data() + i * stride, decoded[i]);
+        });
+        const double encode = bestNanoseconds(count, repeats, [&](std::size_t i) {
+            encodeTopLevels(decoded[i], encoded.data() + i * stride);
+        });
+        std::cout << "top levels " << toString(kernel) << ": decode=" << decode << "ns encode=" << encode << "ns\n";
+    }
+
+    setByteSwapKernel(original);
+    return ok;
+}
+
+static int usage(const char* program)
+{
+    std::cerr << "usage: " << program << " [options]\n"
+                 "\n"
+                 "  --count N     messages encoded and decoded per run (default 10000000)\n"
+                 "  --repeat N    runs of each, the best is reported (default 5)\n";
+    return 2;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned long count = 10000000;
+    unsigned long repeats = 5;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--count") == 0 && hasValue)
+            count = std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--repeat") == 0 && hasValue)
+            repeats = std::strtoul(argv[++i], nullptr, 10);
+        else
+            return usage(argv[0]);
+    }
+    if (count == 0 || repeats == 0)
+    {
+        return usage(argv[0]);
+    }
+
+    std::cout << "byte swap kernel: " << toString(getByteSwapKernel()) << '\n';
+    const bool ok = benchKernels(count, repeats)
+                    && bench<InsertMessage>("insert", count, repeats)
+                    && bench<OrderStatusMessage>("order status", count, repeats)
+                    && bench<OrderBookMessage>("order book", count, repeats);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
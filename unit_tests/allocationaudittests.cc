@@ -0,0 +1,248 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <array>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <backtest/backtest.h>
+#include <exchange/exchangeconfig.h>
+#include <market_data/marketevents.h>
+#include <ready_trader_go/baseautotrader.h>
+#include <ready_trader_go/logging.h>
+#include <ready_trader_go/types.h>
+
+using namespace ReadyTraderGo;
+
+namespace {
+
+constexpr double MARKET_DURATION = 10.0;
+constexpr double MARKET_EVENT_STEP = 0.05;
+constexpr double WARM_UP_TIME = 1.0;
+
+constexpr unsigned long LOT_SIZE = 5;
+constexpr unsigned long TICK_SIZE_IN_CENTS = 100;
+constexpr unsigned long MIN_BID_NEAREST_TICK =
+    (MINIMUM_BID + TICK_SIZE_IN_CENTS) / TICK_SIZE_IN_CENTS * TICK_SIZE_IN_CENTS;
+constexpr unsigned long MAX_ASK_NEAREST_TICK = MAXIMUM_ASK / TICK_SIZE_IN_CENTS * TICK_SIZE_IN_CENTS;
+
+ExchangeConfig makeExchangeConfig()
+{
+    ExchangeConfig config;
+    config.mMarketEventInterval = 0.05;
+    config.mMarketOpenDelay = 1.0;
+    config.mSpeed = 1.0;
+    config.mTickInterval = 0.25;
+    config.mMakerFee = -0.0001;
+    config.mTakerFee = 0.0002;
+    config.mEtfClamp = 0.002;
+    config.mTickSize = 1.0;
+    config.mActiveOrderCountLimit = 10;
+    config.mActiveVolumeLimit = 200;
+    config.mMessageFrequencyInterval = 1.0;
+    config.mMessageFrequencyLimit = 50;
+    config.mPositionLimit = 100;
+    return config;
+}
+
+// Both instruments get a resting bid and ask either side of a price that
+// walks between $99 and $102; every third step the bid is amended down
+// and every fifth step a fill-and-kill order crosses the spread. What is
+// left of each pair is cancelled two steps later.
+std::vector<MarketEvent> makeMarketEvents()
+{
+    std::vector<MarketEvent> events;
+    std::array<std::array<unsigned long, 4>, 2> restingIds{};
+    unsigned long nextOrderId = 1;
+    int step = 0;
+    for (double time = 0.0; time < MARKET_DURATION; time += MARKET_EVENT_STEP, ++step)
+    {
+        const unsigned long mid = 10000 + 100 * (step / 10 % 4);
+        for (Instrument instrument : {Instrument::FUTURE, Instrument::ETF})
+        {
+            // The oldest pair is at the front: cancel it and move the other up.
+            auto& ids = restingIds[static_cast<int>(instrument)];
+            if (ids[0] != 0)
+            {
+                events.push_back({time, instrument, MarketEventOperation::CANCEL, ids[0], Side::BUY, 0, 0,
+                                  Lifespan::FILL_AND_KILL});
+                events.push_back({time, instrument, MarketEventOperation::CANCEL, ids[1], Side::SELL, 0, 0,
+                                  Lifespan::FILL_AND_KILL});
+            }
+
+            const unsigned long bidId = nextOrderId++;
+            const unsigned long askId = nextOrderId++;
+            ids = {ids[2], ids[3], bidId, askId};
+            events.push_back({time, instrument, MarketEventOperation::INSERT, bidId, Side::BUY, 20, mid - 100,
+                              Lifespan::GOOD_FOR_DAY});
+            events.push_back({time, instrument, MarketEventOperation::INSERT, askId, Side::SELL, 20, mid + 100,
+                              Lifespan::GOOD_FOR_DAY});
+            if (step % 3 == 0)
+            {
+                events.push_back({time, instrument, MarketEventOperation::AMEND, bidId, Side::BUY, -5, 0,
+                                  Lifespan::FILL_AND_KILL});
+            }
+            if (step % 5 == 0)
+            {
+                const Side side = step % 10 == 0 ? Side::BUY : Side::SELL;
+                events.push_back({time, instrument, MarketEventOperation::INSERT, nextOrderId++, side, 30,
+                                  side == Side::BUY ? mid + 200 : mid - 200, Lifespan::FILL_AND_KILL});
+            }
+        }
+    }
+    return events;
+}
+
+// Joins the best bid and ask on the ETF, replacing its quotes on every
+// order book update, and hedges every fill in the future. Like a real
+// auto-trader on the fast path, it keeps its state in plain members.
+class QuotingAutoTrader : public BaseAutoTrader
+{
+public:
+    using BaseAutoTrader::BaseAutoTrader;
+
+    void OrderBookMessageHandler(Instrument instrument,
+                                 unsigned long sequenceNumber,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>& askPrices,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes) override
+    {
+        if (instrument != Instrument::ETF || askPrices[0] == 0 || bidPrices[0] == 0)
+        {
+            return;
+        }
+
+        auto batch = MakeSendBatch();
+        if (mBidId != 0)
+        {
+            TryCancelOrder(mBidId);
+        }
+        if (mAskId != 0)
+        {
+            TryCancelOrder(mAskId);
+        }
+        mBidId = InsertOrder(Side::BUY, bidPrices[0], LOT_SIZE, Lifespan::GOOD_FOR_DAY);
+        mAskId = InsertOrder(Side::SELL, askPrices[0], LOT_SIZE, Lifespan::GOOD_FOR_DAY);
+    }
+
+    void OrderFilledMessageHandler(unsigned long clientOrderId, unsigned long price, unsigned long volume) override
+    {
+        if (clientOrderId == mBidId)
+        {
+            HedgeOrder(Side::SELL, MIN_BID_NEAREST_TICK, volume);
+        }
+        else if (clientOrderId == mAskId)
+        {
+            HedgeOrder(Side::BUY, MAX_ASK_NEAREST_TICK, volume);
+        }
+    }
+
+    void OrderStatusMessageHandler(unsigned long clientOrderId,
+                                   unsigned long fillVolume,
+                                   unsigned long remainingVolume,
+                                   signed long fees) override
+    {
+        if (remainingVolume == 0)
+        {
+            if (clientOrderId == mBidId)
+            {
+                mBidId = 0;
+            }
+            else if (clientOrderId == mAskId)
+            {
+                mAskId = 0;
+            }
+        }
+    }
+
+private:
+    unsigned long mBidId = 0;
+    unsigned long mAskId = 0;
+};
+
+// As above, but keeps a history of the books it has seen in a growing vector.
+class HistoryAutoTrader : public QuotingAutoTrader
+{
+public:
+    using QuotingAutoTrader::QuotingAutoTrader;
+
+    void OrderBookMessageHandler(Instrument instrument,
+                                 unsigned long sequenceNumber,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>& askPrices,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes) override
+    {
+        mAskHistory.push_back(askPrices);
+        QuotingAutoTrader::OrderBookMessageHandler(instrument, sequenceNumber, askPrices, askVolumes, bidPrices,
+                                                   bidVolumes);
+    }
+
+private:
+    std::vector<std::array<unsigned long, TOP_LEVEL_COUNT>> mAskHistory;
+};
+
+struct AuditedBacktest
+{
+    AuditedBacktest() : mConfig(makeExchangeConfig()), mEvents(makeMarketEvents()), mBacktest(mConfig, mEvents)
+    {
+        setLoggingEnabled(false);
+        mBacktest.AuditAllocations(WARM_UP_TIME);
+    }
+
+    ~AuditedBacktest()
+    {
+        setLoggingEnabled(true);
+    }
+
+    ExchangeConfig mConfig;
+    std::vector<MarketEvent> mEvents;
+    Backtest mBacktest;
+    boost::asio::io_context mContext;
+};
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(AllocationAuditTests, AuditedBacktest)
+
+BOOST_AUTO_TEST_CASE(QuotingAutoTraderDoesNotAllocate)
+{
+    QuotingAutoTrader autoTrader{mContext};
+    const BacktestResult result = mBacktest.Run(autoTrader, mContext);
+
+    BOOST_REQUIRE(result.mBreachMessage.empty());
+    BOOST_REQUIRE_GT(result.mMessagesSent, 0u);
+    BOOST_REQUIRE_GT(result.mOrderFillCount, 0u);
+    BOOST_REQUIRE_GT(result.mHedgeFillCount, 0u);
+    BOOST_CHECK_EQUAL(result.mAuditedAllocations, 0u);
+    BOOST_CHECK_EQUAL(result.mAuditedBytes, 0u);
+}
+
+// Makes sure the audit is armed at all, so the check above can fail.
+BOOST_AUTO_TEST_CASE(AllocatingAutoTraderIsCounted)
+{
+    HistoryAutoTrader autoTrader{mContext};
+    const BacktestResult result = mBacktest.Run(autoTrader, mContext);
+
+    BOOST_CHECK_GT(result.mAuditedAllocations, 0u);
+    BOOST_CHECK_GT(result.mAuditedBytes, 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
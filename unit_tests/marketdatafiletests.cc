@@ -0,0 +1,167 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <market_data/marketdatafile.h>
+#include <market_data/marketevents.h>
+
+using namespace ReadyTraderGo;
+
+namespace {
+
+// A CSV market data file with every operation, side and lifespan, both
+// instruments, two events at the same time, an event exactly on an index
+// boundary and a gap spanning a whole index interval.
+const char* const MARKET_DATA_CSV =
+    "Time,Instrument,Operation,OrderId,Side,Volume,Price,Lifespan\n"
+    "0.000000,0,Insert,1,B,25,96.00,G\n"
+    "0.100000,1,Insert,2,A,7,104.50,F\n"
+    "0.500000,0,Amend,1,,-5,,\n"
+    "0.500000,1,Insert,3,B,12,101.00,G\n"
+    "1.700000,0,Cancel,1,,,,\n"
+    "2.250000,1,Insert,4294967296,A,1,99.50,G\n";
+
+const std::vector<MarketEvent> EXPECTED_EVENTS = {
+    {0.0, Instrument::FUTURE, MarketEventOperation::INSERT, 1, Side::BUY, 25, 9600, Lifespan::GOOD_FOR_DAY},
+    {0.1, Instrument::ETF, MarketEventOperation::INSERT, 2, Side::SELL, 7, 10450, Lifespan::FILL_AND_KILL},
+    {0.5, Instrument::FUTURE, MarketEventOperation::AMEND, 1, Side::BUY, -5, 0, Lifespan::FILL_AND_KILL},
+    {0.5, Instrument::ETF, MarketEventOperation::INSERT, 3, Side::BUY, 12, 10100, Lifespan::GOOD_FOR_DAY},
+    {1.7, Instrument::FUTURE, MarketEventOperation::CANCEL, 1, Side::BUY, 0, 0, Lifespan::FILL_AND_KILL},
+    {2.25, Instrument::ETF, MarketEventOperation::INSERT, 4294967296, Side::SELL, 1, 9950, Lifespan::GOOD_FOR_DAY},
+};
+
+constexpr double INDEX_INTERVAL = 0.5;
+
+// Writes the CSV file and converts it, removing both files afterwards.
+struct ConvertedFile
+{
+    ConvertedFile()
+        : mCsvFilename((std::filesystem::temp_directory_path() / "rtg_unit_tests_market_data.csv").string()),
+          mBinaryFilename((std::filesystem::temp_directory_path() / "rtg_unit_tests_market_data.bin").string())
+    {
+        std::ofstream{mCsvFilename} << MARKET_DATA_CSV;
+        MarketDataFile::Write(mBinaryFilename, readMarketEvents(mCsvFilename), INDEX_INTERVAL);
+    }
+
+    ~ConvertedFile()
+    {
+        std::filesystem::remove(mCsvFilename);
+        std::filesystem::remove(mBinaryFilename);
+    }
+
+    std::string mCsvFilename;
+    std::string mBinaryFilename;
+};
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(MarketDataFileTests, ConvertedFile)
+
+BOOST_AUTO_TEST_CASE(ConvertedColumnsMatchCsv)
+{
+    BOOST_REQUIRE(MarketDataFile::IsMarketDataFile(mBinaryFilename));
+    BOOST_CHECK(!MarketDataFile::IsMarketDataFile(mCsvFilename));
+
+    const MarketDataFile file{mBinaryFilename};
+    BOOST_CHECK_EQUAL(file.GetIndexInterval(), INDEX_INTERVAL);
+    BOOST_REQUIRE_EQUAL(file.GetEventCount(), EXPECTED_EVENTS.size());
+
+    for (std::size_t i = 0; i != EXPECTED_EVENTS.size(); ++i)
+    {
+        BOOST_TEST_CONTEXT("event " << i)
+        {
+            const MarketEvent& expected = EXPECTED_EVENTS[i];
+            BOOST_CHECK_EQUAL(file.GetTimes()[i], expected.mTime);
+            BOOST_CHECK(file.GetInstruments()[i] == expected.mInstrument);
+            BOOST_CHECK(file.GetOperations()[i] == expected.mOperation);
+            BOOST_CHECK_EQUAL(file.GetOrderIds()[i], expected.mOrderId);
+            BOOST_CHECK(file.GetSides()[i] == expected.mSide);
+            BOOST_CHECK_EQUAL(file.GetVolumes()[i], expected.mVolume);
+            BOOST_CHECK_EQUAL(file.GetPrices()[i], expected.mPrice);
+            BOOST_CHECK(file.GetLifespans()[i] == expected.mLifespan);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ReadsBackAsCsv)
+{
+    const auto fromCsv = readMarketEvents(mCsvFilename);
+    const auto fromBinary = readMarketEvents(mBinaryFilename);
+    BOOST_REQUIRE_EQUAL(fromCsv.size(), fromBinary.size());
+
+    for (std::size_t i = 0; i != fromCsv.size(); ++i)
+    {
+        BOOST_TEST_CONTEXT("event " << i)
+        {
+            BOOST_CHECK_EQUAL(fromBinary[i].mTime, fromCsv[i].mTime);
+            BOOST_CHECK(fromBinary[i].mInstrument == fromCsv[i].mInstrument);
+            BOOST_CHECK(fromBinary[i].mOperation == fromCsv[i].mOperation);
+            BOOST_CHECK_EQUAL(fromBinary[i].mOrderId, fromCsv[i].mOrderId);
+            BOOST_CHECK(fromBinary[i].mSide == fromCsv[i].mSide);
+            BOOST_CHECK_EQUAL(fromBinary[i].mVolume, fromCsv[i].mVolume);
+            BOOST_CHECK_EQUAL(fromBinary[i].mPrice, fromCsv[i].mPrice);
+            BOOST_CHECK(fromBinary[i].mLifespan == fromCsv[i].mLifespan);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(FindTimeMatchesBinarySearch)
+{
+    const MarketDataFile file{mBinaryFilename};
+
+    BOOST_CHECK_EQUAL(file.FindTime(-1.0), 0u);
+    BOOST_CHECK_EQUAL(file.FindTime(0.0), 0u);
+    BOOST_CHECK_EQUAL(file.FindTime(0.5), 2u);
+    BOOST_CHECK_EQUAL(file.FindTime(1.0), 4u);
+    BOOST_CHECK_EQUAL(file.FindTime(2.25), 5u);
+    BOOST_CHECK_EQUAL(file.FindTime(2.5), 6u);
+    BOOST_CHECK_EQUAL(file.FindTime(100.0), 6u);
+
+    // Every event time, just after each one, and on and just before every
+    // index boundary, including those past the last event.
+    std::vector<double> probes;
+    for (const auto& event : EXPECTED_EVENTS)
+    {
+        probes.push_back(event.mTime);
+        probes.push_back(event.mTime + 1e-6);
+    }
+    for (double t = 0.0; t <= EXPECTED_EVENTS.back().mTime + 2 * INDEX_INTERVAL; t += INDEX_INTERVAL)
+    {
+        probes.push_back(t);
+        probes.push_back(t - 1e-9);
+    }
+
+    for (double t : probes)
+    {
+        const auto it = std::lower_bound(EXPECTED_EVENTS.begin(), EXPECTED_EVENTS.end(), t,
+                                         [](const MarketEvent& e, double time) { return e.mTime < time; });
+        BOOST_TEST_CONTEXT("time " << t)
+        {
+            BOOST_CHECK_EQUAL(file.FindTime(t), static_cast<std::size_t>(it - EXPECTED_EVENTS.begin()));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()